@@ -33,7 +33,16 @@ START_NAMESPACE_DGL
    Be careful when using a PNG without alpha channel, for those the format is 'GL_BGR'
    instead of the default 'GL_BGRA'.
 
+   Images can also be loaded from compressed PNG data with loadFromPNG(),
+   which keeps binaries small; see the utils/res2c.py script to embed PNG files.
+   Those are decoded the first time they are needed, or earlier in the background if preload() is called.
+   The decoded pixels are shared between all images using the same PNG data.
+   A second PNG at twice the size can be given for windows that use auto-scaling on HiDPI screens,
+   it is decoded and uploaded only if the image is actually drawn at that scale.
+
    Images are drawn on screen via 2D textures.
+   Those come from a process-wide pool, images with the same data, size and format
+   drawn in the same OpenGL context share a single texture.
  */
 class Image
 {
@@ -77,6 +86,29 @@ public:
     */
     void loadFromMemory(const char* const rawData, const Size<uint>& size, const GLenum format = GL_BGRA, const GLenum type = GL_UNSIGNED_BYTE) noexcept;
 
+   /**
+      Load compressed image data from memory, as the contents of a PNG file.
+      Only the size is read here, the image is decoded when first drawn or when its raw data is requested.
+      @note @a pngData must remain valid for the lifetime of this Image.
+    */
+    void loadFromPNG(const char* const pngData, const uint dataSize) noexcept;
+
+   /**
+      Load compressed image data from memory, with a 2x version for HiDPI screens.
+      The 2x image must be exactly twice as wide and high as the normal one, otherwise it is ignored.
+      @see Window::setAutoScaling()
+      @note @a pngData and @a pngData2x must remain valid for the lifetime of this Image.
+    */
+    void loadFromPNG(const char* const pngData, const uint dataSize,
+                     const char* const pngData2x, const uint dataSize2x) noexcept;
+
+   /**
+      Start decoding compressed image data on a background thread,
+      so it is ready by the time the image is first drawn.
+      Does nothing for raw image data, or if already decoded.
+    */
+    void preload() const noexcept;
+
    /**
       Check if this image is valid.
     */
@@ -99,6 +131,8 @@ public:
 
    /**
       Get the raw image data.
+      For compressed images this decodes the data if not done yet,
+      waiting for the background thread if it is working on it.
     */
     const char* getRawData() const noexcept;
 
@@ -132,12 +166,27 @@ public:
     bool operator!=(const Image& image) const noexcept;
 
 private:
+    struct CompressedData;
+    struct Texture;
+
     const char* fRawData;
+    CompressedData* fCompressedData;
+    CompressedData* fCompressedData2x;
     Size<uint> fSize;
     GLenum fFormat;
     GLenum fType;
-    GLuint fTextureId;
+    Texture* fTexture;
     bool fIsReady;
+
+    void releaseCompressedData() noexcept;
+
+    // delete textures released while their context was not current, called by windows with their context current
+    static void deleteReleasedTextures() noexcept;
+
+    // scale factor of the window being drawn, used to pick the 2x image data
+    static void setDrawScaleFactor(double scaleFactor) noexcept;
+
+    friend class Window;
 };
 
 // -----------------------------------------------------------------------
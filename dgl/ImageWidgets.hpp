@@ -151,7 +151,8 @@ private:
     uint fImgLayerHeight;
     uint fImgLayerCount;
     bool fIsReady;
-    GLuint fTextureId;
+    Image* fLayerImages;
+    uint fLayerImageCount;
 
     float _logscale(float value) const;
     float _invlogscale(float value) const;
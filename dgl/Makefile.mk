@@ -103,9 +103,15 @@ ifeq ($(LINUX),true)
 ifneq ($(shell pkg-config --exists gl && echo true),true)
 $(error OpenGL missing, cannot continue)
 endif
+ifeq ($(HEADLESS),true)
+ifneq ($(shell pkg-config --exists egl && echo true),true)
+$(error EGL missing, cannot continue)
+endif
+else
 ifneq ($(shell pkg-config --exists x11 && echo true),true)
 $(error X11 missing, cannot continue)
 endif
+endif
 ifeq ($(FONS_USE_FREETYPE),true)
 ifneq ($(shell pkg-config --exists freetype2 && echo true),true)
 $(error freetype2 missing, cannot continue)
@@ -117,8 +123,14 @@ endif
 # Set libs stuff
 
 ifeq ($(LINUX),true)
+ifeq ($(HEADLESS),true)
+# Render offscreen through EGL, no display server needed
+DGL_FLAGS = $(shell pkg-config --cflags gl egl) -DDGL_HEADLESS
+DGL_LIBS  = $(shell pkg-config --libs gl egl) -lpthread
+else
 DGL_FLAGS = $(shell pkg-config --cflags gl x11)
-DGL_LIBS  = $(shell pkg-config --libs gl x11)
+DGL_LIBS  = $(shell pkg-config --libs gl x11) -lpthread
+endif
 ifeq ($(FONS_USE_FREETYPE),true)
 DGL_FLAGS += $(shell pkg-config --cflags freetype2)
 DGL_LIBS  += $(shell pkg-config --libs freetype2)
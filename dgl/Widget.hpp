@@ -130,16 +130,24 @@ public:
 
    /**
       Mouse motion event.
-      @a pos The widget-relative coordinates of the pointer.
+      Pointer motion that queued up since the last event is merged, only the latest position is sent.
+      Widgets that need every position (e.g. for drawing) can read the merged ones from @a history.
+      @a pos         The widget-relative coordinates of the pointer.
+      @a history     The widget-relative coordinates of the merged motion events, oldest first, or null.
+      @a historySize The number of coordinates in @a history.
       @see onMotion
     */
     struct MotionEvent : BaseEvent {
         Point<int> pos;
+        const Point<int>* history;
+        uint historySize;
 
         /** Constuctor */
         MotionEvent() noexcept
             : BaseEvent(),
-              pos(0, 0) {}
+              pos(0, 0),
+              history(nullptr),
+              historySize(0) {}
     };
 
    /**
@@ -359,12 +367,16 @@ protected:
 
    /**
       A function called when a mouse button is pressed or released.
+      Pointer events are sent to the widgets under the pointer or under its previous position,
+      to the widget that took the last button press until all buttons are released,
+      and to widgets without a size or using the full viewport.
       @return True to stop event propagation, false otherwise.
     */
     virtual bool onMouse(const MouseEvent&);
 
    /**
       A function called when the pointer moves.
+      @see onMouse for which widgets receive pointer events.
       @return True to stop event propagation, false otherwise.
     */
     virtual bool onMotion(const MotionEvent&);
@@ -403,6 +415,7 @@ private:
     friend class Window;
     friend class StandaloneWindow;
     friend class DISTRHO_NAMESPACE::UI;
+    friend struct WidgetHitTestGrid;
 
     DISTRHO_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Widget)
 };
@@ -105,6 +105,34 @@ public:
     void setSize(uint width, uint height);
     void setSize(Size<uint> size);
 
+    /**
+       Get the scale factor of the screen the window was created on, 1.0 for 96 DPI.
+       Read from Xft.dpi on Linux and the system DPI on Windows, always 1.0 on macOS.
+       The DPF_SCALE_FACTOR environment variable overrides it.
+     */
+    double getScaleFactor() const noexcept;
+
+    /**
+       Scale all drawing and events by getScaleFactor().
+       Widget positions, sizes and events, cursor positions and the size passed to onReshape()
+       are then in logical units, while the window size stays in device pixels.
+       NanoVG text and paths are rendered at full resolution and images use their 2x version if they have one.
+       Disabled by default.
+     */
+    void setAutoScaling(bool autoScaling);
+    bool isAutoScaling() const noexcept;
+
+    /**
+       Render the window contents and read them back as RGBA pixels, top row first.
+       @a pixels must have room for @a width * @a height * 4 bytes, usually getWidth() and getHeight().
+       Pending size changes are applied first; if the window size then differs from @a width and @a height
+       nothing is written and false is returned, so the caller can size its buffer again and retry.
+       Meant for headless builds (DGL_HEADLESS), where windows render into an offscreen EGL surface
+       and need neither a display server nor a GPU, but works with regular windows too.
+       Returns false if the window could not be rendered.
+     */
+    bool captureFrame(uchar* pixels, uint width, uint height);
+
     const char *getTitle() const noexcept;
     void setTitle(const char *title);
 
@@ -197,6 +225,7 @@ public:
   
     virtual void _addWidget(Widget *const widget);
     virtual void _removeWidget(Widget *const widget);
+    void _widgetBoundsChanged();
     void _idle();
 
     bool handlePluginKeyboard(const bool press, const uint key);
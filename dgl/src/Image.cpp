@@ -15,64 +15,541 @@
  */
 
 #include "../Image.hpp"
+#include "../../distrho/extra/Thread.hpp"
+
+#include "nanovg/stb_image.h"
+
+#if defined(DGL_HEADLESS)
+# include <EGL/egl.h>
+#elif defined(DISTRHO_OS_WINDOWS)
+# include <windows.h>
+#elif defined(DISTRHO_OS_MAC)
+# include <OpenGL/OpenGL.h>
+#else
+# include <GL/glx.h>
+#endif
+
+#include <vector>
 
 START_NAMESPACE_DGL
 
+// -----------------------------------------------------------------------
+// Compressed image data, decoded on demand and shared by all images using the same PNG data
+
+struct Image::CompressedData {
+    class Cache;
+
+    const char* const pngData;
+    const uint dataSize;
+    const GLenum format;
+    int refCount; // protected by the cache lock
+
+    CompressedData(const char* const d, const uint s, const GLenum f) noexcept
+        : pngData(d),
+          dataSize(s),
+          format(f),
+          refCount(1),
+          fDecodeLock(),
+          fRawData(nullptr),
+          fFailed(false) {}
+
+    ~CompressedData()
+    {
+        if (fRawData != nullptr)
+        {
+            stbi_image_free(fRawData);
+            fRawData = nullptr;
+        }
+    }
+
+    /*
+     * Decode the image if not done yet, can be called from any thread.
+     * Returns null if the data is not a valid PNG.
+     */
+    const char* decode() noexcept
+    {
+        const MutexLocker ml(fDecodeLock);
+
+        if (fRawData == nullptr && ! fFailed)
+        {
+            int width, height, channels;
+            fRawData = stbi_load_from_memory((const stbi_uc*)pngData, static_cast<int>(dataSize),
+                                             &width, &height, &channels, format == GL_RGBA ? 4 : 3);
+            fFailed = (fRawData == nullptr);
+        }
+
+        return (const char*)fRawData;
+    }
+
+    static CompressedData* acquire(const char* const pngData, const uint dataSize, const GLenum format);
+    void retain() noexcept;
+    void release() noexcept;
+    void preload() noexcept;
+
+private:
+    Mutex fDecodeLock;
+    stbi_uc* fRawData;
+    bool fFailed;
+
+    DISTRHO_DECLARE_NON_COPY_STRUCT(CompressedData)
+};
+
+// -----------------------------------------------------------------------
+// List of compressed images in use, and the thread decoding them in the background
+
+class Image::CompressedData::Cache : public Thread
+{
+public:
+    static Cache& getInstance()
+    {
+        static Cache cache;
+        return cache;
+    }
+
+    CompressedData* acquire(const char* const pngData, const uint dataSize, const GLenum format)
+    {
+        const MutexLocker ml(fCacheLock);
+
+        for (std::vector<CompressedData*>::iterator it = fEntries.begin(), end = fEntries.end(); it != end; ++it)
+        {
+            CompressedData* const data(*it);
+
+            if (data->pngData == pngData && data->dataSize == dataSize)
+            {
+                ++data->refCount;
+                return data;
+            }
+        }
+
+        CompressedData* const data = new CompressedData(pngData, dataSize, format);
+        fEntries.push_back(data);
+        return data;
+    }
+
+    void retain(CompressedData* const data) noexcept
+    {
+        const MutexLocker ml(fCacheLock);
+
+        ++data->refCount;
+    }
+
+    void release(CompressedData* const data) noexcept
+    {
+        const MutexLocker ml(fCacheLock);
+
+        DISTRHO_SAFE_ASSERT_RETURN(data->refCount > 0,);
+
+        if (--data->refCount != 0)
+            return;
+
+        for (std::vector<CompressedData*>::iterator it = fEntries.begin(), end = fEntries.end(); it != end; ++it)
+        {
+            if (*it == data)
+            {
+                fEntries.erase(it);
+                break;
+            }
+        }
+
+        delete data;
+    }
+
+    void queue(CompressedData* const data)
+    {
+        const MutexLocker ml(fCacheLock);
+
+        // keep the data alive until decoded
+        ++data->refCount;
+        fQueue.push_back(data);
+
+        if (! isThreadRunning())
+            startThread();
+
+        fQueueSignal.signal();
+    }
+
+protected:
+    void run() override
+    {
+        for (; ! shouldThreadExit();)
+        {
+            CompressedData* data = nullptr;
+
+            {
+                const MutexLocker ml(fCacheLock);
+
+                if (! fQueue.empty())
+                {
+                    data = fQueue.front();
+                    fQueue.erase(fQueue.begin());
+                }
+            }
+
+            if (data == nullptr)
+            {
+                fQueueSignal.wait();
+                continue;
+            }
+
+            data->decode();
+            release(data);
+        }
+    }
+
+private:
+    Mutex fCacheLock;
+    Signal fQueueSignal;
+    std::vector<CompressedData*> fEntries;
+    std::vector<CompressedData*> fQueue;
+
+    Cache()
+        : Thread("DGL image decoder"),
+          fCacheLock(),
+          fQueueSignal(),
+          fEntries(),
+          fQueue() {}
+
+    ~Cache() override
+    {
+        signalThreadShouldExit();
+        fQueueSignal.signal();
+        stopThread(-1);
+
+        for (std::vector<CompressedData*>::iterator it = fQueue.begin(), end = fQueue.end(); it != end; ++it)
+            release(*it);
+
+        fQueue.clear();
+    }
+
+    DISTRHO_DECLARE_NON_COPY_CLASS(Cache)
+};
+
+Image::CompressedData* Image::CompressedData::acquire(const char* const pngData, const uint dataSize, const GLenum format)
+{
+    return Cache::getInstance().acquire(pngData, dataSize, format);
+}
+
+void Image::CompressedData::retain() noexcept
+{
+    Cache::getInstance().retain(this);
+}
+
+void Image::CompressedData::release() noexcept
+{
+    Cache::getInstance().release(this);
+}
+
+void Image::CompressedData::preload() noexcept
+{
+    Cache::getInstance().queue(this);
+}
+
+// -----------------------------------------------------------------------
+// OpenGL texture, shared by all images with the same data drawn in the same context
+
+static void* getCurrentGLContext() noexcept
+{
+#if defined(DGL_HEADLESS)
+    return eglGetCurrentContext();
+#elif defined(DISTRHO_OS_WINDOWS)
+    return wglGetCurrentContext();
+#elif defined(DISTRHO_OS_MAC)
+    return CGLGetCurrentContext();
+#else
+    return glXGetCurrentContext();
+#endif
+}
+
+struct Image::Texture {
+    class Pool;
+
+    void* const context;
+    const char* const rawData;
+    const Size<uint> size;
+    const GLenum format;
+    const GLenum type;
+    GLuint id;
+    int refCount; // protected by the pool lock
+    bool stale;   // protected by the pool lock, the data was loaded again since the upload
+
+    Texture(void* const c, const char* const d, const Size<uint>& s, const GLenum f, const GLenum t) noexcept
+        : context(c),
+          rawData(d),
+          size(s),
+          format(f),
+          type(t),
+          id(0),
+          refCount(1),
+          stale(false) {}
+
+    void upload() noexcept
+    {
+        glGenTextures(1, &id);
+        glBindTexture(GL_TEXTURE_2D, id);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+
+        static const float trans[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, trans);
+
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
+                     static_cast<GLsizei>(size.getWidth()), static_cast<GLsizei>(size.getHeight()), 0,
+                     format, type, rawData);
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    /*
+     * Get the texture for some image data in the current context, uploading it if needed.
+     */
+    static Texture* acquire(const char* const rawData, const Size<uint>& size, const GLenum format, const GLenum type);
+
+    /*
+     * Release a texture and set it to null, does nothing if already null.
+     */
+    static void release(Texture*& texture) noexcept;
+
+    /*
+     * Stop sharing the textures uploaded from some image data, as its pixels may have changed.
+     */
+    static void invalidate(const char* rawData) noexcept;
+
+    DISTRHO_DECLARE_NON_COPY_STRUCT(Texture)
+};
+
+class Image::Texture::Pool
+{
+public:
+    static Pool& getInstance()
+    {
+        static Pool pool;
+        return pool;
+    }
+
+    Texture* acquire(const char* const rawData, const Size<uint>& size, const GLenum format, const GLenum type)
+    {
+        void* const context = getCurrentGLContext();
+
+        const MutexLocker ml(fLock);
+
+        for (std::vector<Texture*>::iterator it = fTextures.begin(), end = fTextures.end(); it != end; ++it)
+        {
+            Texture* const texture(*it);
+
+            if (texture->context == context && texture->rawData == rawData && texture->size == size
+                && texture->format == format && texture->type == type && ! texture->stale)
+            {
+                ++texture->refCount;
+                return texture;
+            }
+        }
+
+        Texture* const texture = new Texture(context, rawData, size, format, type);
+        fTextures.push_back(texture);
+        texture->upload();
+        return texture;
+    }
+
+    void release(Texture* const texture) noexcept
+    {
+        const MutexLocker ml(fLock);
+
+        DISTRHO_SAFE_ASSERT_RETURN(texture->refCount > 0,);
+
+        if (--texture->refCount != 0)
+            return;
+
+        for (std::vector<Texture*>::iterator it = fTextures.begin(), end = fTextures.end(); it != end; ++it)
+        {
+            if (*it == texture)
+            {
+                fTextures.erase(it);
+                break;
+            }
+        }
+
+#ifndef DISTRHO_OS_MAC // FIXME
+        // texture names are per context, deleting from another one would hit an unrelated texture.
+        // if not current the delete waits until the owning window draws or closes
+        if (texture->context != getCurrentGLContext())
+        {
+            try {
+                fReleased.push_back(texture);
+                fReleasedCount = static_cast<int>(fReleased.size());
+                return;
+            } DISTRHO_SAFE_EXCEPTION("Image::Texture::Pool::release");
+        }
+        else
+        {
+            glDeleteTextures(1, &texture->id);
+        }
+#endif
+
+        delete texture;
+    }
+
+    void invalidate(const char* const rawData) noexcept
+    {
+        const MutexLocker ml(fLock);
+
+        for (std::vector<Texture*>::iterator it = fTextures.begin(), end = fTextures.end(); it != end; ++it)
+        {
+            if ((*it)->rawData == rawData)
+                (*it)->stale = true;
+        }
+    }
+
+    void deleteReleased() noexcept
+    {
+        // unlocked check, released textures are picked up on a later call if missed here
+        if (fReleasedCount == 0)
+            return;
+
+        void* const context = getCurrentGLContext();
+
+        const MutexLocker ml(fLock);
+
+        for (std::vector<Texture*>::iterator it = fReleased.begin(); it != fReleased.end();)
+        {
+            Texture* const texture(*it);
+
+            if (texture->context != context)
+            {
+                ++it;
+                continue;
+            }
+
+            glDeleteTextures(1, &texture->id);
+            delete texture;
+            it = fReleased.erase(it);
+        }
+
+        fReleasedCount = static_cast<int>(fReleased.size());
+    }
+
+private:
+    Mutex fLock;
+    std::vector<Texture*> fTextures;
+    std::vector<Texture*> fReleased;
+    volatile int fReleasedCount;
+
+    Pool()
+        : fLock(),
+          fTextures(),
+          fReleased(),
+          fReleasedCount(0) {}
+
+    DISTRHO_DECLARE_NON_COPY_CLASS(Pool)
+};
+
+Image::Texture* Image::Texture::acquire(const char* const rawData, const Size<uint>& size, const GLenum format, const GLenum type)
+{
+    return Pool::getInstance().acquire(rawData, size, format, type);
+}
+
+void Image::Texture::release(Texture*& texture) noexcept
+{
+    if (texture == nullptr)
+        return;
+
+    Pool::getInstance().release(texture);
+    texture = nullptr;
+}
+
+void Image::Texture::invalidate(const char* const rawData) noexcept
+{
+    if (rawData == nullptr)
+        return;
+
+    Pool::getInstance().invalidate(rawData);
+}
+
+void Image::deleteReleasedTextures() noexcept
+{
+    Texture::Pool::getInstance().deleteReleased();
+}
+
+// -----------------------------------------------------------------------
+
+// grayscale images are expanded, keeping alpha if present
+static GLenum getFormatForChannels(const int channels) noexcept
+{
+    return (channels == 2 || channels == 4) ? GL_RGBA : GL_RGB;
+}
+
+// Window pixels per widget unit of the window being drawn, above 1.0 when drawing to an auto-scaling window.
+// set by the window before drawing, per thread as each window draws from its own
+static DISTRHO_THREAD_LOCAL double sDrawScaleFactor = 1.0;
+
+void Image::setDrawScaleFactor(const double scaleFactor) noexcept
+{
+    sDrawScaleFactor = scaleFactor;
+}
+
 // -----------------------------------------------------------------------
 
 Image::Image()
     : fRawData(nullptr),
+      fCompressedData(nullptr),
+      fCompressedData2x(nullptr),
       fSize(0, 0),
       fFormat(0),
       fType(0),
-      fTextureId(0),
-      fIsReady(false)
-{
-    glGenTextures(1, &fTextureId);
-}
+      fTexture(nullptr),
+      fIsReady(false) {}
 
 Image::Image(const char* const rawData, const uint width, const uint height, const GLenum format, const GLenum type)
     : fRawData(rawData),
+      fCompressedData(nullptr),
+      fCompressedData2x(nullptr),
       fSize(width, height),
       fFormat(format),
       fType(type),
-      fTextureId(0),
+      fTexture(nullptr),
       fIsReady(false)
 {
-    glGenTextures(1, &fTextureId);
+    Texture::invalidate(rawData);
 }
 
 Image::Image(const char* const rawData, const Size<uint>& size, const GLenum format, const GLenum type)
     : fRawData(rawData),
+      fCompressedData(nullptr),
+      fCompressedData2x(nullptr),
       fSize(size),
       fFormat(format),
       fType(type),
-      fTextureId(0),
+      fTexture(nullptr),
       fIsReady(false)
 {
-    glGenTextures(1, &fTextureId);
+    Texture::invalidate(rawData);
 }
 
 Image::Image(const Image& image)
     : fRawData(image.fRawData),
+      fCompressedData(image.fCompressedData),
+      fCompressedData2x(image.fCompressedData2x),
       fSize(image.fSize),
       fFormat(image.fFormat),
       fType(image.fType),
-      fTextureId(0),
+      fTexture(nullptr),
       fIsReady(false)
 {
-    glGenTextures(1, &fTextureId);
+    if (fCompressedData != nullptr)
+        fCompressedData->retain();
+    if (fCompressedData2x != nullptr)
+        fCompressedData2x->retain();
 }
 
 Image::~Image()
 {
-    if (fTextureId != 0)
-    {
-#ifndef DISTRHO_OS_MAC // FIXME
-        glDeleteTextures(1, &fTextureId);
-#endif
-        fTextureId = 0;
-    }
+    Texture::release(fTexture);
+
+    releaseCompressedData();
 }
 
 void Image::loadFromMemory(const char* const rawData, const uint width, const uint height, const GLenum format, const GLenum type) noexcept
@@ -82,6 +559,13 @@ void Image::loadFromMemory(const char* const rawData, const uint width, const ui
 
 void Image::loadFromMemory(const char* const rawData, const Size<uint>& size, const GLenum format, const GLenum type) noexcept
 {
+    // the pixels may have changed even if the pointer did not, never reuse what was uploaded from it before.
+    // images copied from this one share the new upload
+    Texture::release(fTexture);
+    Texture::invalidate(rawData);
+
+    releaseCompressedData();
+
     fRawData = rawData;
     fSize    = size;
     fFormat  = format;
@@ -89,9 +573,65 @@ void Image::loadFromMemory(const char* const rawData, const Size<uint>& size, co
     fIsReady = false;
 }
 
+void Image::loadFromPNG(const char* const pngData, const uint dataSize) noexcept
+{
+    DISTRHO_SAFE_ASSERT_RETURN(pngData != nullptr && dataSize > 0,);
+
+    // only reads the header
+    int width, height, channels;
+    DISTRHO_SAFE_ASSERT_RETURN(stbi_info_from_memory((const stbi_uc*)pngData, static_cast<int>(dataSize),
+                                                     &width, &height, &channels) != 0,);
+
+    const GLenum format = getFormatForChannels(channels);
+
+    CompressedData* compressedData;
+
+    try {
+        compressedData = CompressedData::acquire(pngData, dataSize, format);
+    } DISTRHO_SAFE_EXCEPTION_RETURN("Image::loadFromPNG",);
+
+    Texture::release(fTexture);
+    releaseCompressedData();
+
+    fRawData        = nullptr;
+    fCompressedData = compressedData;
+    fSize           = Size<uint>(static_cast<uint>(width), static_cast<uint>(height));
+    fFormat         = format;
+    fType           = GL_UNSIGNED_BYTE;
+    fIsReady        = false;
+}
+
+void Image::loadFromPNG(const char* const pngData, const uint dataSize,
+                        const char* const pngData2x, const uint dataSize2x) noexcept
+{
+    loadFromPNG(pngData, dataSize);
+    DISTRHO_SAFE_ASSERT_RETURN(fCompressedData != nullptr,);
+    DISTRHO_SAFE_ASSERT_RETURN(pngData2x != nullptr && dataSize2x > 0,);
+
+    int width, height, channels;
+    DISTRHO_SAFE_ASSERT_RETURN(stbi_info_from_memory((const stbi_uc*)pngData2x, static_cast<int>(dataSize2x),
+                                                     &width, &height, &channels) != 0,);
+    DISTRHO_SAFE_ASSERT_RETURN(static_cast<uint>(width) == fSize.getWidth() * 2 &&
+                               static_cast<uint>(height) == fSize.getHeight() * 2,);
+
+    try {
+        fCompressedData2x = CompressedData::acquire(pngData2x, dataSize2x, getFormatForChannels(channels));
+    } DISTRHO_SAFE_EXCEPTION("Image::loadFromPNG");
+}
+
+void Image::preload() const noexcept
+{
+    if (fCompressedData == nullptr)
+        return;
+
+    try {
+        fCompressedData->preload();
+    } DISTRHO_SAFE_EXCEPTION("Image::preload");
+}
+
 bool Image::isValid() const noexcept
 {
-    return (fRawData != nullptr && fSize.getWidth() > 0 && fSize.getHeight() > 0);
+    return ((fRawData != nullptr || fCompressedData != nullptr) && fSize.getWidth() > 0 && fSize.getHeight() > 0);
 }
 
 uint Image::getWidth() const noexcept
@@ -111,6 +651,9 @@ const Size<uint>& Image::getSize() const noexcept
 
 const char* Image::getRawData() const noexcept
 {
+    if (fCompressedData != nullptr)
+        return fCompressedData->decode();
+
     return fRawData;
 }
 
@@ -136,31 +679,46 @@ void Image::drawAt(const int x, const int y)
 
 void Image::drawAt(const Point<int>& pos)
 {
-    if (fTextureId == 0 || ! isValid())
+    if (! isValid())
         return;
 
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, fTextureId);
+    // use the 2x version when drawing to an auto-scaling window on a HiDPI screen
+    CompressedData* const compressedData2x = (fCompressedData2x != nullptr && sDrawScaleFactor > 1.5)
+                                           ? fCompressedData2x
+                                           : nullptr;
 
-    if (! fIsReady)
+    if (! fIsReady || (fTexture->size != fSize) != (compressedData2x != nullptr))
     {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        Size<uint> size(fSize);
+        GLenum format = fFormat;
 
-        static const float trans[] = { 0.0f, 0.0f, 0.0f, 0.0f };
-        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, trans);
+        if (compressedData2x != nullptr)
+        {
+            size   = Size<uint>(fSize.getWidth() * 2, fSize.getHeight() * 2);
+            format = compressedData2x->format;
+        }
 
-        glPixelStorei(GL_PACK_ALIGNMENT, 1);
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
-                     static_cast<GLsizei>(fSize.getWidth()), static_cast<GLsizei>(fSize.getHeight()), 0,
-                     fFormat, fType, fRawData);
+        // decode compressed data if needed, images that fail to decode are not drawn
+        const char* const rawData = compressedData2x != nullptr ? compressedData2x->decode() : getRawData();
+
+        if (rawData == nullptr)
+            return;
+
+        Texture* texture;
+
+        try {
+            texture = Texture::acquire(rawData, size, format, fType);
+        } DISTRHO_SAFE_EXCEPTION_RETURN("Image::drawAt",);
 
+        // the previous texture, when switching between the normal and 2x data
+        Texture::release(fTexture);
+        fTexture = texture;
         fIsReady = true;
     }
 
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, fTexture->id);
+
     Rectangle<int>(pos, static_cast<int>(fSize.getWidth()), static_cast<int>(fSize.getHeight())).draw();
 
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -169,8 +727,33 @@ void Image::drawAt(const Point<int>& pos)
 
 // -----------------------------------------------------------------------
 
+void Image::releaseCompressedData() noexcept
+{
+    if (fCompressedData != nullptr)
+    {
+        fCompressedData->release();
+        fCompressedData = nullptr;
+    }
+
+    if (fCompressedData2x != nullptr)
+    {
+        fCompressedData2x->release();
+        fCompressedData2x = nullptr;
+    }
+}
+
 Image& Image::operator=(const Image& image) noexcept
 {
+    if (image.fCompressedData != nullptr)
+        image.fCompressedData->retain();
+    if (image.fCompressedData2x != nullptr)
+        image.fCompressedData2x->retain();
+
+    Texture::release(fTexture);
+    releaseCompressedData();
+
+    fCompressedData   = image.fCompressedData;
+    fCompressedData2x = image.fCompressedData2x;
     fRawData = image.fRawData;
     fSize    = image.fSize;
     fFormat  = image.fFormat;
@@ -181,7 +764,7 @@ Image& Image::operator=(const Image& image) noexcept
 
 bool Image::operator==(const Image& image) const noexcept
 {
-    return (fRawData == image.fRawData && fSize == image.fSize);
+    return (fRawData == image.fRawData && fCompressedData == image.fCompressedData && fSize == image.fSize);
 }
 
 bool Image::operator!=(const Image& image) const noexcept
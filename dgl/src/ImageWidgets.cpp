@@ -212,9 +212,9 @@ ImageKnob::ImageKnob(Window& parent, const Image& image, Orientation orientation
       fImgLayerHeight(fImgLayerWidth),
       fImgLayerCount(fIsImgVertical ? image.getHeight()/fImgLayerHeight : image.getWidth()/fImgLayerWidth),
       fIsReady(false),
-      fTextureId(0)
+      fLayerImages(nullptr),
+      fLayerImageCount(0)
 {
-    glGenTextures(1, &fTextureId);
     setSize(fImgLayerWidth, fImgLayerHeight);
 }
 
@@ -240,9 +240,9 @@ ImageKnob::ImageKnob(Widget* widget, const Image& image, Orientation orientation
       fImgLayerHeight(fImgLayerWidth),
       fImgLayerCount(fIsImgVertical ? image.getHeight()/fImgLayerHeight : image.getWidth()/fImgLayerWidth),
       fIsReady(false),
-      fTextureId(0)
+      fLayerImages(nullptr),
+      fLayerImageCount(0)
 {
-    glGenTextures(1, &fTextureId);
     setSize(fImgLayerWidth, fImgLayerHeight);
 }
 
@@ -268,9 +268,9 @@ ImageKnob::ImageKnob(const ImageKnob& imageKnob)
       fImgLayerHeight(imageKnob.fImgLayerHeight),
       fImgLayerCount(imageKnob.fImgLayerCount),
       fIsReady(false),
-      fTextureId(0)
+      fLayerImages(nullptr),
+      fLayerImageCount(0)
 {
-    glGenTextures(1, &fTextureId);
     setSize(fImgLayerWidth, fImgLayerHeight);
 }
 
@@ -297,13 +297,6 @@ ImageKnob& ImageKnob::operator=(const ImageKnob& imageKnob)
     fImgLayerCount  = imageKnob.fImgLayerCount;
     fIsReady  = false;
 
-    if (fTextureId != 0)
-    {
-        glDeleteTextures(1, &fTextureId);
-        fTextureId = 0;
-    }
-
-    glGenTextures(1, &fTextureId);
     setSize(fImgLayerWidth, fImgLayerHeight);
 
     return *this;
@@ -311,10 +304,10 @@ ImageKnob& ImageKnob::operator=(const ImageKnob& imageKnob)
 
 ImageKnob::~ImageKnob()
 {
-    if (fTextureId != 0)
+    if (fLayerImages != nullptr)
     {
-        glDeleteTextures(1, &fTextureId);
-        fTextureId = 0;
+        delete[] fLayerImages;
+        fLayerImages = nullptr;
     }
 }
 
@@ -379,9 +372,6 @@ void ImageKnob::setValue(float value, bool sendCallback) noexcept
     if (d_isZero(fStep))
         fValueTmp = value;
 
-    if (fRotationAngle == 0)
-        fIsReady = false;
-
     repaint();
 
     if (sendCallback && fCallback != nullptr)
@@ -430,6 +420,8 @@ void ImageKnob::setImageLayerCount(uint count) noexcept
     else
         fImgLayerWidth = fImage.getWidth()/count;
 
+    fIsReady = false;
+
     setSize(fImgLayerWidth, fImgLayerHeight);
 }
 
@@ -437,67 +429,61 @@ void ImageKnob::onDisplay()
 {
     const float normValue = ((fUsingLog ? _invlogscale(fValue) : fValue) - fMinimum) / (fMaximum - fMinimum);
 
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, fTextureId);
-
     if (! fIsReady)
     {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        const char* const rawData = fImage.getRawData();
+        DISTRHO_SAFE_ASSERT_RETURN(rawData != nullptr,);
+        DISTRHO_SAFE_ASSERT_RETURN(fImgLayerCount > 0,);
 
-        static const float trans[] = { 0.0f, 0.0f, 0.0f, 0.0f };
-        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, trans);
+        // one image per layer, each keeps its texture once drawn so value changes only select another one
+        const uint layerImageCount = fRotationAngle != 0 ? 1 : fImgLayerCount;
 
-        glPixelStorei(GL_PACK_ALIGNMENT, 1);
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        const uint& v1(fIsImgVertical ? fImgLayerWidth : fImgLayerHeight);
+        const uint& v2(fIsImgVertical ? fImgLayerHeight : fImgLayerWidth);
 
-        uint imageDataOffset = 0;
+        const uint layerDataSize = v1 * v2 * ((fImage.getFormat() == GL_BGRA || fImage.getFormat() == GL_RGBA) ? 4 : 3);
 
-        if (fRotationAngle == 0)
+        if (fLayerImages != nullptr)
         {
-            DISTRHO_SAFE_ASSERT_RETURN(fImgLayerCount > 0,);
-            DISTRHO_SAFE_ASSERT_RETURN(normValue >= 0.0f,);
+            delete[] fLayerImages;
+            fLayerImages = nullptr;
+        }
 
-            const uint& v1(fIsImgVertical ? fImgLayerWidth : fImgLayerHeight);
-            const uint& v2(fIsImgVertical ? fImgLayerHeight : fImgLayerWidth);
+        try {
+            fLayerImages = new Image[layerImageCount];
+        } DISTRHO_SAFE_EXCEPTION_RETURN("ImageKnob::onDisplay",);
 
-            const uint layerDataSize   = v1 * v2 * ((fImage.getFormat() == GL_BGRA || fImage.getFormat() == GL_RGBA) ? 4 : 3);
-            /*      */ imageDataOffset = layerDataSize * uint(normValue * float(fImgLayerCount-1));
-        }
+        fLayerImageCount = layerImageCount;
 
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
-                     static_cast<GLsizei>(getWidth()), static_cast<GLsizei>(getHeight()), 0,
-                     fImage.getFormat(), fImage.getType(), fImage.getRawData() + imageDataOffset);
+        for (uint i=0; i < layerImageCount; ++i)
+            fLayerImages[i].loadFromMemory(rawData + layerDataSize * i, getSize(), fImage.getFormat(), fImage.getType());
 
         fIsReady = true;
     }
 
-    const int w = static_cast<int>(getWidth());
-    const int h = static_cast<int>(getHeight());
-
     if (fRotationAngle != 0)
     {
         glPushMatrix();
 
-        const int w2 = w/2;
-        const int h2 = h/2;
+        const int w2 = static_cast<int>(getWidth())/2;
+        const int h2 = static_cast<int>(getHeight())/2;
 
         glTranslatef(static_cast<float>(w2), static_cast<float>(h2), 0.0f);
         glRotatef(normValue*static_cast<float>(fRotationAngle), 0.0f, 0.0f, 1.0f);
 
-        Rectangle<int>(-w2, -h2, w, h).draw();
+        fLayerImages[0].drawAt(-w2, -h2);
 
         glPopMatrix();
     }
     else
     {
-        Rectangle<int>(0, 0, w, h).draw();
-    }
+        DISTRHO_SAFE_ASSERT_RETURN(normValue >= 0.0f,);
+
+        const uint layer = uint(normValue * float(fLayerImageCount-1));
+        DISTRHO_SAFE_ASSERT_RETURN(layer < fLayerImageCount,);
 
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glDisable(GL_TEXTURE_2D);
+        fLayerImages[layer].draw();
+    }
 }
 
 bool ImageKnob::onMouse(const MouseEvent& ev)
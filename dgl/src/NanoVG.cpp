@@ -19,6 +19,7 @@
 
 #ifndef DGL_NO_SHARED_RESOURCES
 # include "Resources.hpp"
+# include "nanovg/stb_image.h"
 #endif
 
 // -----------------------------------------------------------------------
@@ -259,6 +260,12 @@ NanoVG::~NanoVG()
 
 // -----------------------------------------------------------------------
 
+// Window pixels per widget unit, NanoVG renders paths and text at that resolution
+static double getWidgetScaleFactor(const Window& window) noexcept
+{
+    return window.isAutoScaling() ? window.getScaleFactor() : 1.0;
+}
+
 void NanoVG::beginFrame(const uint width, const uint height, const float scaleFactor)
 {
     if (fContext == nullptr) return;
@@ -280,7 +287,12 @@ void NanoVG::beginFrame(Widget* const widget)
         return;
 
     Window& window(widget->getParentWindow());
-    nvgBeginFrame(fContext, static_cast<int>(window.getWidth()), static_cast<int>(window.getHeight()), 1.0f);
+    const double scaleFactor = getWidgetScaleFactor(window);
+
+    nvgBeginFrame(fContext,
+                  static_cast<int>(window.getWidth() / scaleFactor + 0.5),
+                  static_cast<int>(window.getHeight() / scaleFactor + 0.5),
+                  static_cast<float>(scaleFactor));
 }
 
 void NanoVG::cancelFrame()
@@ -934,7 +946,15 @@ void NanoVG::loadSharedResources()
 
     using namespace dpf_resources;
 
-    createFontFromMemory(NANOVG_DEJAVU_SANS_TTF, (const uchar*)dejavusans_ttf, dejavusans_ttf_size, 0);
+    // the font is embedded zlib-compressed, nanovg takes ownership of the inflated copy
+    int fontSize = 0;
+    char* const fontData = stbi_zlib_decode_malloc_guesssize_headerflag(dejavusans_ttf,
+                                                                        static_cast<int>(dejavusans_ttf_compressed_size),
+                                                                        static_cast<int>(dejavusans_ttf_size),
+                                                                        &fontSize, 1);
+    DISTRHO_SAFE_ASSERT_RETURN(fontData != nullptr,);
+
+    createFontFromMemory(NANOVG_DEJAVU_SANS_TTF, (const uchar*)fontData, static_cast<uint>(fontSize), true);
 }
 #endif
 
@@ -987,7 +1007,7 @@ NanoWidget::~NanoWidget()
 
 void NanoWidget::onDisplay()
 {
-    NanoVG::beginFrame(getWidth(), getHeight());
+    NanoVG::beginFrame(getWidth(), getHeight(), static_cast<float>(getWidgetScaleFactor(getParentWindow())));
     onNanoDisplay();
 
     for (std::vector<NanoWidget*>::iterator it = nData->subWidgets.begin(); it != nData->subWidgets.end(); ++it)
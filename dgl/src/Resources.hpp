@@ -7,6 +7,7 @@ namespace dpf_resources
 {
     extern const char* dejavusans_ttf;
     const unsigned int dejavusans_ttf_size = 741536;
+    const unsigned int dejavusans_ttf_compressed_size = 372872;
 };
 
 #endif
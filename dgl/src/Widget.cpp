@@ -56,6 +56,7 @@ void Widget::setVisible(bool yesNo)
         return;
 
     pData->visible = yesNo;
+    pData->parent._widgetBoundsChanged();
 
     if (yesNo)
     {
@@ -106,6 +107,7 @@ void Widget::setWidth(uint width) noexcept
     pData->size.setWidth(width);
     onResize(ev);
 
+    pData->parent._widgetBoundsChanged();
     pData->parent.repaint();
 }
 
@@ -121,6 +123,7 @@ void Widget::setHeight(uint height) noexcept
     pData->size.setHeight(height);
     onResize(ev);
 
+    pData->parent._widgetBoundsChanged();
     pData->parent.repaint();
 }
 
@@ -141,6 +144,7 @@ void Widget::setSize(const Size<uint>& size) noexcept
     pData->size = size;
     onResize(ev);
 
+    pData->parent._widgetBoundsChanged();
     pData->parent.repaint();
 }
 
@@ -165,6 +169,7 @@ void Widget::setAbsoluteX(int x) noexcept
         return;
 
     pData->absolutePos.setX(x);
+    pData->parent._widgetBoundsChanged();
     pData->parent.repaint();
 }
 
@@ -174,6 +179,7 @@ void Widget::setAbsoluteY(int y) noexcept
         return;
 
     pData->absolutePos.setY(y);
+    pData->parent._widgetBoundsChanged();
     pData->parent.repaint();
 }
 
@@ -196,6 +202,7 @@ void Widget::setAbsolutePos(const Point<int>& pos) noexcept
 
     onPositionChanged(ev);
 
+    pData->parent._widgetBoundsChanged();
     pData->parent.repaint();
 }
 
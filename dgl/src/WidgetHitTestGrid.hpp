@@ -0,0 +1,159 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef DGL_WIDGET_HIT_TEST_GRID_HPP_INCLUDED
+#define DGL_WIDGET_HIT_TEST_GRID_HPP_INCLUDED
+
+#include "WidgetPrivateData.hpp"
+
+#include <algorithm>
+#include <list>
+
+START_NAMESPACE_DGL
+
+// -----------------------------------------------------------------------
+// Uniform grid over absolute widget bounds, used to find the widgets under the pointer.
+// Widgets without a size or using the full viewport do their own hit-testing, and are always visited.
+
+struct WidgetHitTestGrid {
+    static const uint kCellSize = 32;
+
+    WidgetHitTestGrid() noexcept
+        : fCells(),
+          fGlobalWidgets(),
+          fColumns(0),
+          fRows(0),
+          fDirty(true) {}
+
+    void invalidate() noexcept
+    {
+        fDirty = true;
+    }
+
+    bool isDirty() const noexcept
+    {
+        return fDirty;
+    }
+
+    void rebuild(const std::list<Widget*>& widgets, const uint width, const uint height)
+    {
+        fColumns = (width  + kCellSize - 1) / kCellSize;
+        fRows    = (height + kCellSize - 1) / kCellSize;
+
+        fCells.resize(fColumns * fRows);
+
+        for (std::vector<std::vector<Widget*> >::iterator it = fCells.begin(); it != fCells.end(); ++it)
+            it->clear();
+
+        fGlobalWidgets.clear();
+
+        uint order = 0;
+
+        for (std::list<Widget*>::const_iterator it = widgets.begin(); it != widgets.end(); ++it)
+        {
+            Widget* const widget(*it);
+            Widget::PrivateData* const wData(widget->pData);
+
+            wData->dispatchOrder = order++;
+
+            if (! wData->visible)
+                continue;
+
+            if (wData->needsFullViewport || wData->size.isInvalid())
+            {
+                fGlobalWidgets.push_back(widget);
+                continue;
+            }
+
+            const int x1 = wData->absolutePos.getX();
+            const int y1 = wData->absolutePos.getY();
+            const int x2 = x1 + static_cast<int>(wData->size.getWidth())  - 1;
+            const int y2 = y1 + static_cast<int>(wData->size.getHeight()) - 1;
+
+            if (x2 < 0 || y2 < 0 || fColumns == 0 || fRows == 0)
+                continue;
+
+            const uint column1 = static_cast<uint>(std::max(x1, 0)) / kCellSize;
+            const uint row1    = static_cast<uint>(std::max(y1, 0)) / kCellSize;
+            const uint column2 = std::min(static_cast<uint>(x2) / kCellSize, fColumns - 1);
+            const uint row2    = std::min(static_cast<uint>(y2) / kCellSize, fRows - 1);
+
+            for (uint row = row1; row <= row2; ++row)
+            {
+                for (uint column = column1; column <= column2; ++column)
+                    fCells[row * fColumns + column].push_back(widget);
+            }
+        }
+
+        fDirty = false;
+    }
+
+    /*
+     * Get the cell index for a window position, or -1 if outside the grid.
+     */
+    int getCellIndex(const int x, const int y) const noexcept
+    {
+        if (x < 0 || y < 0)
+            return -1;
+
+        const uint column = static_cast<uint>(x) / kCellSize;
+        const uint row    = static_cast<uint>(y) / kCellSize;
+
+        if (column >= fColumns || row >= fRows)
+            return -1;
+
+        return static_cast<int>(row * fColumns + column);
+    }
+
+    /*
+     * Append the widgets registered in a cell, or the global ones when 'cellIndex' is -1.
+     */
+    void appendCellWidgets(const int cellIndex, std::vector<Widget*>& candidates) const
+    {
+        const std::vector<Widget*>& cellWidgets(cellIndex >= 0 ? fCells[static_cast<uint>(cellIndex)]
+                                                               : fGlobalWidgets);
+
+        candidates.insert(candidates.end(), cellWidgets.begin(), cellWidgets.end());
+    }
+
+    /*
+     * Sort candidates in reverse creation order, matching the order of regular event dispatch.
+     */
+    static void sortCandidates(std::vector<Widget*>& candidates)
+    {
+        std::sort(candidates.begin(), candidates.end(), compareReverseOrder);
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    }
+
+private:
+    std::vector<std::vector<Widget*> > fCells;
+    std::vector<Widget*> fGlobalWidgets;
+    uint fColumns, fRows;
+    bool fDirty;
+
+    static bool compareReverseOrder(const Widget* const a, const Widget* const b) noexcept
+    {
+        return a->pData->dispatchOrder > b->pData->dispatchOrder;
+    }
+
+    DISTRHO_DECLARE_NON_COPY_STRUCT(WidgetHitTestGrid)
+};
+
+// -----------------------------------------------------------------------
+
+END_NAMESPACE_DGL
+
+#endif // DGL_WIDGET_HIT_TEST_GRID_HPP_INCLUDED
@@ -35,6 +35,7 @@ struct Widget::PrivateData {
 
     uint id;
     uint focusedWidgetId; //fork
+    uint dispatchOrder;
 
     bool needsFullViewport;
     bool needsScaling;
@@ -49,6 +50,7 @@ struct Widget::PrivateData {
           subWidgets(),
           id(0),
           focusedWidgetId(kNoWidgetFocusedId), //fork
+          dispatchOrder(0),
           needsFullViewport(false),
           needsScaling(false),
           skipDisplay(false),
@@ -66,7 +68,8 @@ struct Widget::PrivateData {
         subWidgets.clear();
     }
 
-    void display(const uint width, const uint height)
+    // width and height are in widget units, scaleFactor converts them to window pixels
+    void display(const uint width, const uint height, const double scaleFactor)
     {
         if (skipDisplay || ! visible)
             return;
@@ -79,29 +82,31 @@ struct Widget::PrivateData {
         if (needsFullViewport || (absolutePos.isZero() && size == Size<uint>(width, height)))
         {
             // full viewport size
-            glViewport(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+            glViewport(0, 0,
+                       toPixels(width, scaleFactor),
+                       toPixels(height, scaleFactor));
         }
         else if (needsScaling)
         {
             // limit viewport to widget bounds
-            glViewport(absolutePos.getX(),
-                       static_cast<int>(height - self->getHeight()) - absolutePos.getY(),
-                       static_cast<GLsizei>(self->getWidth()),
-                       static_cast<GLsizei>(self->getHeight()));
+            glViewport(toPixels(absolutePos.getX(), scaleFactor),
+                       toPixels(static_cast<int>(height - self->getHeight()) - absolutePos.getY(), scaleFactor),
+                       toPixels(self->getWidth(), scaleFactor),
+                       toPixels(self->getHeight(), scaleFactor));
         }
         else
         {
             // only set viewport pos
-            glViewport(absolutePos.getX(),
-                       /*static_cast<int>(height - self->getHeight())*/ - absolutePos.getY(),
-                       static_cast<GLsizei>(width),
-                       static_cast<GLsizei>(height));
+            glViewport(toPixels(absolutePos.getX(), scaleFactor),
+                       /*static_cast<int>(height - self->getHeight())*/ - toPixels(absolutePos.getY(), scaleFactor),
+                       toPixels(width, scaleFactor),
+                       toPixels(height, scaleFactor));
 
             // then cut the outer bounds
-            glScissor(absolutePos.getX(),
-                      static_cast<int>(height - self->getHeight()) - absolutePos.getY(),
-                      static_cast<GLsizei>(self->getWidth()),
-                      static_cast<GLsizei>(self->getHeight()));
+            glScissor(toPixels(absolutePos.getX(), scaleFactor),
+                      toPixels(static_cast<int>(height - self->getHeight()) - absolutePos.getY(), scaleFactor),
+                      toPixels(self->getWidth(), scaleFactor),
+                      toPixels(self->getHeight(), scaleFactor));
 
             glEnable(GL_SCISSOR_TEST);
             needsDisableScissor = true;
@@ -116,20 +121,25 @@ struct Widget::PrivateData {
             needsDisableScissor = false;
         }
 
-        displaySubWidgets(width, height);
+        displaySubWidgets(width, height, scaleFactor);
     }
 
-    void displaySubWidgets(const uint width, const uint height)
+    void displaySubWidgets(const uint width, const uint height, const double scaleFactor)
     {
         for (std::vector<Widget*>::iterator it = subWidgets.begin(); it != subWidgets.end(); ++it)
         {
             Widget* const widget(*it);
             DISTRHO_SAFE_ASSERT_CONTINUE(widget->pData != this);
 
-            widget->pData->display(width, height);
+            widget->pData->display(width, height, scaleFactor);
         }
     }
 
+    static GLint toPixels(const double value, const double scaleFactor) noexcept
+    {
+        return static_cast<GLint>(std::floor(value * scaleFactor + 0.5));
+    }
+
     DISTRHO_DECLARE_NON_COPY_STRUCT(PrivateData)
 };
 
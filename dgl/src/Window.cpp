@@ -30,7 +30,11 @@
 #pragma GCC diagnostic ignored "-Wimplicit-fallthrough"
 #endif
 
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+extern "C" {
+#include "pugl/pugl_headless.c"
+}
+#elif defined(DISTRHO_OS_WINDOWS)
 #include "pugl/pugl_win.cpp"
 #elif defined(DISTRHO_OS_MAC)
 #include "pugl/pugl_osx.m"
@@ -50,6 +54,8 @@ extern "C" {
 
 #include "ApplicationPrivateData.hpp"
 #include "WidgetPrivateData.hpp"
+#include "../Image.hpp"
+#include "WidgetHitTestGrid.hpp"
 #include "../StandaloneWindow.hpp"
 #include "../../distrho/extra/String.hpp"
 
@@ -88,8 +94,18 @@ struct Window::PrivateData
 		  fHeight(1),
 		  fTitle(nullptr),
 		  fWidgets(),
+		  fHitTestGrid(),
+		  fDispatchWidgets(),
+		  fLastPointerWidgets(),
+		  fMouseGrabWidget(nullptr),
+		  fPressedButtons(0),
+		  fScaleFactor(1.0),
+		  fAutoScaling(false),
+		  fNeedsReshape(false),
 		  fModal(),
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+		  headlessCursorPos(0, 0)
+#elif defined(DISTRHO_OS_WINDOWS)
 		  hwnd(0)
 #elif defined(DISTRHO_OS_MAC)
 		  fNeedsIdle(true),
@@ -118,8 +134,18 @@ struct Window::PrivateData
 		  fHeight(1),
 		  fTitle(nullptr),
 		  fWidgets(),
+		  fHitTestGrid(),
+		  fDispatchWidgets(),
+		  fLastPointerWidgets(),
+		  fMouseGrabWidget(nullptr),
+		  fPressedButtons(0),
+		  fScaleFactor(1.0),
+		  fAutoScaling(false),
+		  fNeedsReshape(false),
 		  fModal(parent.pData),
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+		  headlessCursorPos(0, 0)
+#elif defined(DISTRHO_OS_WINDOWS)
 		  hwnd(0)
 #elif defined(DISTRHO_OS_MAC)
 		  fNeedsIdle(false),
@@ -136,7 +162,9 @@ struct Window::PrivateData
 		init();
 
 		const PuglInternals *const parentImpl(parent.pData->fView->impl);
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+		// nothing to stack
+#elif defined(DISTRHO_OS_WINDOWS)
 		// TODO
 #elif defined(DISTRHO_OS_MAC)
 		[parentImpl->window orderWindow:NSWindowBelow
@@ -162,12 +190,22 @@ struct Window::PrivateData
 		  fHeight(1),
 		  fTitle(nullptr),
 		  fWidgets(),
+		  fHitTestGrid(),
+		  fDispatchWidgets(),
+		  fLastPointerWidgets(),
+		  fMouseGrabWidget(nullptr),
+		  fPressedButtons(0),
+		  fScaleFactor(1.0),
+		  fAutoScaling(false),
+		  fNeedsReshape(false),
 		  fModal(),
 		  fCursorIsClipped(false),
 		  fIsFullscreen(false),
 		  fPreFullscreenSize(Size<uint>(0,0)),
 		  fIsContextMenu(false),
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+		  headlessCursorPos(0, 0)
+#elif defined(DISTRHO_OS_WINDOWS)
 		  hwnd(0)
 #elif defined(DISTRHO_OS_MAC)
 		  fNeedsIdle(parentId == 0),
@@ -223,7 +261,9 @@ struct Window::PrivateData
 		puglCreateWindow(fView, nullptr);
 
 		PuglInternals *impl = fView->impl;
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+		DISTRHO_SAFE_ASSERT(impl->ctx != EGL_NO_CONTEXT);
+#elif defined(DISTRHO_OS_WINDOWS)
 		hwnd = impl->hwnd;
 		DISTRHO_SAFE_ASSERT(hwnd != 0);
 #elif defined(DISTRHO_OS_MAC)
@@ -267,6 +307,7 @@ struct Window::PrivateData
 		XMapWindow(xDisplay, xClipCursorWindow);
 		//-------------
 #endif
+		fScaleFactor = detectScaleFactor();
 		fMustSaveSize = false;
 
 		puglEnterContext(fView);
@@ -288,6 +329,8 @@ struct Window::PrivateData
 		}
 
 		fWidgets.clear();
+		fLastPointerWidgets.clear();
+		fMouseGrabWidget = nullptr;
 
 		if (fUsingEmbed)
 		{
@@ -303,6 +346,11 @@ struct Window::PrivateData
 
 		if (fView != nullptr)
 		{
+			// textures of this context released from elsewhere can only be deleted now
+			puglEnterContext(fView);
+			Image::deleteReleasedTextures();
+			puglLeaveContext(fView, false);
+
 			puglDestroy(fView);
 			fView = nullptr;
 		}
@@ -313,7 +361,9 @@ struct Window::PrivateData
 			fTitle = nullptr;
 		}
 
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+		headlessCursorPos = Point<int>(0, 0);
+#elif defined(DISTRHO_OS_WINDOWS)
 		hwnd = 0;
 #elif defined(DISTRHO_OS_MAC)
 		mView = nullptr;
@@ -414,7 +464,9 @@ struct Window::PrivateData
 
 			// the mouse position probably changed since the modal appeared,
 			// so send a mouse motion event to the modal's parent window
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+			fModal.parent->onPuglMotion(fModal.parent->headlessCursorPos.getX(), fModal.parent->headlessCursorPos.getY());
+#elif defined(DISTRHO_OS_WINDOWS)
 			// TODO
 #elif defined(DISTRHO_OS_MAC)
 			// TODO
@@ -433,7 +485,9 @@ struct Window::PrivateData
 	void focus()
 	{
 		DBG("Window focus\n");
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+		// no window to focus
+#elif defined(DISTRHO_OS_WINDOWS)
 		SetForegroundWindow(hwnd);
 		SetActiveWindow(hwnd);
 		SetFocus(hwnd);
@@ -473,7 +527,12 @@ struct Window::PrivateData
 		if (yesNo && fFirstInit)
 			setSize(fWidth, fHeight, true);
 
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+		if (yesNo)
+			puglShowWindow(fView);
+		else
+			puglHideWindow(fView);
+#elif defined(DISTRHO_OS_WINDOWS)
 		if (yesNo)
 			ShowWindow(hwnd, fFirstInit ? SW_SHOWNORMAL : SW_RESTORE);
 		else
@@ -565,10 +624,13 @@ struct Window::PrivateData
 
 		fWidth = width;
 		fHeight = height;
+		fHitTestGrid.invalidate();
 
 		DBGp("Window setSize called %s, size %i %i, resizable %s\n", forced ? "(forced)" : "(not forced)", width, height, fResizable ? "true" : "false");
 
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+		puglHeadlessResize(fView, static_cast<int>(width), static_cast<int>(height));
+#elif defined(DISTRHO_OS_WINDOWS)
 		const int winFlags = WS_POPUPWINDOW | WS_CAPTION | (fResizable ? WS_SIZEBOX : 0x0);
 		RECT wr = {0, 0, static_cast<long>(width), static_cast<long>(height)};
 		AdjustWindowRectEx(&wr, fUsingEmbed ? WS_CHILD : winFlags, FALSE, WS_EX_TOPMOST);
@@ -643,7 +705,9 @@ struct Window::PrivateData
 
 		fTitle = strdup(title);
 
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+		// no title to show
+#elif defined(DISTRHO_OS_WINDOWS)
 		SetWindowTextA(hwnd, title);
 #elif defined(DISTRHO_OS_MAC)
 		if (mWindow != nullptr)
@@ -664,7 +728,9 @@ struct Window::PrivateData
 	{
 		DISTRHO_SAFE_ASSERT_RETURN(winId != 0, );
 
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+		// no window to stack
+#elif defined(DISTRHO_OS_WINDOWS)
 		// TODO
 #elif defined(DISTRHO_OS_MAC)
 		NSWindow *const window = [NSApp windowWithWindowNumber:winId];
@@ -680,14 +746,179 @@ struct Window::PrivateData
 
 	// -------------------------------------------------------------------
 
+	double detectScaleFactor() const
+	{
+		if (const char *const envScale = std::getenv("DPF_SCALE_FACTOR"))
+		{
+			const double scaleFactor = d_str2double(envScale);
+
+			if (scaleFactor > 0.0)
+				return scaleFactor;
+		}
+
+#if defined(DGL_HEADLESS)
+		// only the environment variable, there is no screen
+#elif defined(DISTRHO_OS_WINDOWS)
+		if (HDC hdc = GetDC(hwnd))
+		{
+			const int dpi = GetDeviceCaps(hdc, LOGPIXELSX);
+			ReleaseDC(hwnd, hdc);
+
+			if (dpi > 0)
+				return dpi / 96.0;
+		}
+#elif defined(DISTRHO_OS_MAC)
+		// TODO: use the backing scale factor, Cocoa already converts everything to points
+#else
+		if (const char *const resources = XResourceManagerString(xDisplay))
+		{
+			if (const char *const dpiStr = std::strstr(resources, "Xft.dpi:"))
+			{
+				const double dpi = d_str2double(dpiStr + 8);
+
+				if (dpi > 0.0)
+					return dpi / 96.0;
+			}
+		}
+#endif
+
+		return 1.0;
+	}
+
+	// Scale from widget units to window pixels, 1.0 unless auto-scaling
+	double getWidgetScaleFactor() const noexcept
+	{
+		return fAutoScaling ? fScaleFactor : 1.0;
+	}
+
+	uint getWidgetWidth() const noexcept
+	{
+		return static_cast<uint>(fWidth / getWidgetScaleFactor() + 0.5);
+	}
+
+	uint getWidgetHeight() const noexcept
+	{
+		return static_cast<uint>(fHeight / getWidgetScaleFactor() + 0.5);
+	}
+
+	int toWidgetUnits(const double value) const noexcept
+	{
+		return static_cast<int>(std::floor(value / getWidgetScaleFactor()));
+	}
+
+	int toWindowPixels(const int value) const noexcept
+	{
+		return static_cast<int>(std::floor(value * getWidgetScaleFactor() + 0.5));
+	}
+
+	void setAutoScaling(const bool autoScaling)
+	{
+		if (fAutoScaling == autoScaling)
+			return;
+
+		fAutoScaling = autoScaling;
+		fHitTestGrid.invalidate();
+
+		FOR_EACH_WIDGET(it)
+		{
+			Widget *const widget(*it);
+
+			if (widget->pData->needsFullViewport)
+				widget->setSize(getWidgetWidth(), getWidgetHeight());
+		}
+
+		// the projection can only be changed while the GL context is active
+		fNeedsReshape = true;
+		puglPostRedisplay(fView);
+	}
+
+	// -------------------------------------------------------------------
+
 	void addWidget(Widget *const widget)
 	{
 		fWidgets.push_back(widget);
+		fHitTestGrid.invalidate();
 	}
 
 	void removeWidget(Widget *const widget)
 	{
 		fWidgets.remove(widget);
+		fHitTestGrid.invalidate();
+
+		fLastPointerWidgets.erase(std::remove(fLastPointerWidgets.begin(), fLastPointerWidgets.end(), widget),
+								  fLastPointerWidgets.end());
+
+		if (fMouseGrabWidget == widget)
+			fMouseGrabWidget = nullptr;
+	}
+
+	// Collect the widgets that can handle a pointer event at x, y, in dispatch order.
+	// These are the widgets under the pointer and under its previous position (so they see it leave),
+	// the widget that took the last mouse press and the widgets that do their own hit-testing.
+	void collectPointerWidgets(const int x, const int y)
+	{
+		if (fHitTestGrid.isDirty())
+			fHitTestGrid.rebuild(fWidgets, getWidgetWidth(), getWidgetHeight());
+
+		fDispatchWidgets.clear();
+		fDispatchWidgets.insert(fDispatchWidgets.end(), fLastPointerWidgets.begin(), fLastPointerWidgets.end());
+		fHitTestGrid.appendCellWidgets(-1, fDispatchWidgets);
+
+		fLastPointerWidgets.clear();
+
+		const int cellIndex = fHitTestGrid.getCellIndex(x, y);
+
+		if (cellIndex >= 0)
+			fHitTestGrid.appendCellWidgets(cellIndex, fLastPointerWidgets);
+
+		fDispatchWidgets.insert(fDispatchWidgets.end(), fLastPointerWidgets.begin(), fLastPointerWidgets.end());
+
+		if (fMouseGrabWidget != nullptr)
+			fDispatchWidgets.push_back(fMouseGrabWidget);
+
+		WidgetHitTestGrid::sortCandidates(fDispatchWidgets);
+	}
+
+	bool captureFrame(uchar *const pixels, const uint width, const uint height)
+	{
+		DISTRHO_SAFE_ASSERT_RETURN(pixels != nullptr, false);
+		DISTRHO_SAFE_ASSERT_RETURN(fView != nullptr, false);
+
+		// apply pending size changes, this may also draw a frame
+		puglProcessEvents(fView);
+
+		// the window was resized since the caller sized its buffer
+		if (fWidth != width || fHeight != height)
+			return false;
+
+		const GLsizei glWidth = static_cast<GLsizei>(fWidth);
+		const GLsizei glHeight = static_cast<GLsizei>(fHeight);
+		const std::size_t rowSize = static_cast<std::size_t>(glWidth) * 4;
+
+		puglEnterContext(fView);
+		onPuglDisplay();
+		glFinish();
+
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, glWidth, glHeight, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		const bool ok = glGetError() == GL_NO_ERROR;
+
+		puglLeaveContext(fView, false);
+
+		// OpenGL rows start at the bottom
+		std::vector<uchar> row(rowSize);
+
+		for (GLsizei y = 0, half = glHeight / 2; y < half; ++y)
+		{
+			uchar *const top = pixels + static_cast<std::size_t>(y) * rowSize;
+			uchar *const bottom = pixels + static_cast<std::size_t>(glHeight - 1 - y) * rowSize;
+
+			std::memcpy(&row.front(), top, rowSize);
+			std::memcpy(top, bottom, rowSize);
+			std::memcpy(bottom, &row.front(), rowSize);
+		}
+
+		return ok;
 	}
 
 	void idle()
@@ -726,12 +957,26 @@ struct Window::PrivateData
 
 	void onPuglDisplay()
 	{
+		Image::deleteReleasedTextures();
+
+		if (fNeedsReshape)
+		{
+			fNeedsReshape = false;
+			fSelf->onReshape(getWidgetWidth(), getWidgetHeight());
+		}
+
+		const uint width = getWidgetWidth();
+		const uint height = getWidgetHeight();
+		const double scaleFactor = getWidgetScaleFactor();
+
+		Image::setDrawScaleFactor(scaleFactor);
+
 		fSelf->onDisplayBefore();
 
 		FOR_EACH_WIDGET(it)
 		{
 			Widget *const widget(*it);
-			widget->pData->display(fWidth, fHeight);
+			widget->pData->display(width, height, scaleFactor);
 		}
 
 		fSelf->onDisplayAfter();
@@ -791,14 +1036,17 @@ struct Window::PrivateData
 		return 1;
 	}
 
-	void onPuglMouse(const int button, const bool press, const int x, const int y)
+	void onPuglMouse(const int button, const bool press, const int windowX, const int windowY)
 	{
-		DBGp("PUGL: onMouse : %i %i %i %i\n", button, press, x, y);
+		DBGp("PUGL: onMouse : %i %i %i %i\n", button, press, windowX, windowY);
 
 		// FIXME - pugl sends 2 of these for each window on init, don't ask me why. we'll ignore it
-		if (press && button == 0 && x == 0 && y == 0)
+		if (press && button == 0 && windowX == 0 && windowY == 0)
 			return;
 
+		const int x = toWidgetUnits(windowX);
+		const int y = toWidgetUnits(windowY);
+
 		if (fModal.childFocus != nullptr)
 		{
 			//this would cause some issues with right-click menu
@@ -811,14 +1059,45 @@ struct Window::PrivateData
 		//ev.mod = static_cast<Modifier>(puglGetModifiers(fView));
 		//ev.time = puglGetEventTimestamp(fView);
 
-		FOR_EACH_WIDGET_INV(rit)
+		// take the dispatch list, event handlers might run a nested event loop
+		std::vector<Widget *> widgets;
+		collectPointerWidgets(x, y);
+		widgets.swap(fDispatchWidgets);
+
+		Widget *handledBy = nullptr;
+
+		for (std::vector<Widget *>::iterator it = widgets.begin(); it != widgets.end(); ++it)
 		{
-			Widget *const widget(*rit);
+			Widget *const widget(*it);
 
 			ev.pos = Point<int>(x - widget->getAbsoluteX(), y - widget->getAbsoluteY());
 
 			if (widget->isVisible() && widget->onMouse(ev))
+			{
+				handledBy = widget;
 				break;
+			}
+		}
+
+		widgets.clear();
+		fDispatchWidgets.swap(widgets);
+
+		// the widget that takes a press keeps receiving pointer events until all buttons are released
+		const uint buttonMask = (button >= 0 && button < 32) ? (1u << button) : 0u;
+
+		if (press)
+		{
+			fPressedButtons |= buttonMask;
+
+			if (handledBy != nullptr)
+				fMouseGrabWidget = handledBy;
+		}
+		else
+		{
+			fPressedButtons &= ~buttonMask;
+
+			if (fPressedButtons == 0)
+				fMouseGrabWidget = nullptr;
 		}
 
 		if (fIsContextMenu && ev.press)
@@ -827,49 +1106,82 @@ struct Window::PrivateData
 		}
 	}
 
-	void onPuglMotion(const int x, const int y)
+	void onPuglMotion(const int windowX, const int windowY, const PuglMotionPoint *const history = nullptr, const int historySize = 0)
 	{
-		DBGp("PUGL: onMotion : %i %i\n", x, y);
+		DBGp("PUGL: onMotion : %i %i (%i merged)\n", windowX, windowY, historySize);
 
 		if (fModal.childFocus != nullptr)
 			return;
 
+		const int x = toWidgetUnits(windowX);
+		const int y = toWidgetUnits(windowY);
+
 		Widget::MotionEvent ev;
 		//ev.mod = static_cast<Modifier>(puglGetModifiers(fView));
 		//ev.time = puglGetEventTimestamp(fView);
 
-		FOR_EACH_WIDGET_INV(rit)
+		std::vector<Widget *> widgets;
+		collectPointerWidgets(x, y);
+		widgets.swap(fDispatchWidgets);
+
+		// merged positions, made widget-relative for each widget
+		std::vector<Point<int> > widgetHistory(historySize > 0 ? static_cast<std::size_t>(historySize) : 0);
+
+		if (! widgetHistory.empty())
 		{
-			Widget *const widget(*rit);
+			ev.history = &widgetHistory.front();
+			ev.historySize = static_cast<uint>(historySize);
+		}
+
+		for (std::vector<Widget *>::iterator it = widgets.begin(); it != widgets.end(); ++it)
+		{
+			Widget *const widget(*it);
 
 			ev.pos = Point<int>(x - widget->getAbsoluteX(), y - widget->getAbsoluteY());
 
+			for (std::size_t i = 0; i < widgetHistory.size(); ++i)
+				widgetHistory[i] = Point<int>(toWidgetUnits(history[i].x) - widget->getAbsoluteX(),
+											  toWidgetUnits(history[i].y) - widget->getAbsoluteY());
+
 			if (widget->isVisible() && widget->onMotion(ev))
 				break;
 		}
+
+		widgets.clear();
+		fDispatchWidgets.swap(widgets);
 	}
 
-	void onPuglScroll(const int x, const int y, const float dx, const float dy)
+	void onPuglScroll(const int windowX, const int windowY, const float dx, const float dy)
 	{
-		DBGp("PUGL: onScroll : %i %i %f %f\n", x, y, dx, dy);
+		DBGp("PUGL: onScroll : %i %i %f %f\n", windowX, windowY, dx, dy);
 
 		if (fModal.childFocus != nullptr)
 			return;
 
+		const int x = toWidgetUnits(windowX);
+		const int y = toWidgetUnits(windowY);
+
 		Widget::ScrollEvent ev;
 		ev.delta = Point<float>(dx, dy);
 		//ev.mod = static_cast<Modifier>(puglGetModifiers(fView));
 		//ev.time = puglGetEventTimestamp(fView);
 
-		FOR_EACH_WIDGET_INV(rit)
+		std::vector<Widget *> widgets;
+		collectPointerWidgets(x, y);
+		widgets.swap(fDispatchWidgets);
+
+		for (std::vector<Widget *>::iterator it = widgets.begin(); it != widgets.end(); ++it)
 		{
-			Widget *const widget(*rit);
+			Widget *const widget(*it);
 
 			ev.pos = Point<int>(x - widget->getAbsoluteX(), y - widget->getAbsoluteY());
 
 			if (widget->isVisible() && widget->onScroll(ev))
 				break;
 		}
+
+		widgets.clear();
+		fDispatchWidgets.swap(widgets);
 	}
 
 	void onPuglReshape(const int width, const int height)
@@ -881,15 +1193,17 @@ struct Window::PrivateData
 
 		fWidth = static_cast<uint>(width);
 		fHeight = static_cast<uint>(height);
+		fHitTestGrid.invalidate();
+		fNeedsReshape = false;
 
-		fSelf->onReshape(fWidth, fHeight);
+		fSelf->onReshape(getWidgetWidth(), getWidgetHeight());
 
 		FOR_EACH_WIDGET(it)
 		{
 			Widget *const widget(*it);
 
 			if (widget->pData->needsFullViewport)
-				widget->setSize(fWidth, fHeight);
+				widget->setSize(getWidgetWidth(), getWidgetHeight());
 		}
 	}
 
@@ -1022,6 +1336,14 @@ struct Window::PrivateData
 	uint fHeight;
 	char *fTitle;
 	std::list<Widget *> fWidgets;
+	WidgetHitTestGrid fHitTestGrid;
+	std::vector<Widget *> fDispatchWidgets;
+	std::vector<Widget *> fLastPointerWidgets;
+	Widget *fMouseGrabWidget;
+	uint fPressedButtons;
+	double fScaleFactor;
+	bool fAutoScaling;
+	bool fNeedsReshape;
 
 	//fork---------
 	bool fCursorIsClipped;
@@ -1056,7 +1378,10 @@ struct Window::PrivateData
 		DISTRHO_DECLARE_NON_COPY_STRUCT(Modal)
 	} fModal;
 
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+	// in window pixels, set by setCursorPos()
+	Point<int> headlessCursorPos;
+#elif defined(DISTRHO_OS_WINDOWS)
 	HWND hwnd;
 #elif defined(DISTRHO_OS_MAC)
 	bool fNeedsIdle;
@@ -1141,7 +1466,10 @@ struct Window::PrivateData
 
 	static void onMotionCallback(PuglView *view, int x, int y)
 	{
-		handlePtr->onPuglMotion(x, y);
+		const PuglMotionPoint *history;
+		const int historySize = puglGetMotionHistory(view, &history);
+
+		handlePtr->onPuglMotion(x, y, history, historySize);
 	}
 
 	static void onScrollCallback(PuglView *view, int x, int y, float dx, float dy)
@@ -1293,6 +1621,9 @@ bool Window::openFileBrowser(const FileBrowserOptions &options)
 #else
 	// not implemented
 	return false;
+
+	// unused
+	(void)options;
 #endif
 }
 #endif
@@ -1347,6 +1678,26 @@ void Window::setSize(Size<uint> size)
 	pData->setSize(size.getWidth(), size.getHeight());
 }
 
+bool Window::captureFrame(uchar *const pixels, const uint width, const uint height)
+{
+	return pData->captureFrame(pixels, width, height);
+}
+
+double Window::getScaleFactor() const noexcept
+{
+	return pData->fScaleFactor;
+}
+
+void Window::setAutoScaling(const bool autoScaling)
+{
+	pData->setAutoScaling(autoScaling);
+}
+
+bool Window::isAutoScaling() const noexcept
+{
+	return pData->fAutoScaling;
+}
+
 const char *Window::getTitle() const noexcept
 {
 	return pData->getTitle();
@@ -1382,6 +1733,11 @@ void Window::_removeWidget(Widget *const widget)
 	pData->removeWidget(widget);
 }
 
+void Window::_widgetBoundsChanged()
+{
+	pData->fHitTestGrid.invalidate();
+}
+
 void Window::_idle()
 {
 	pData->idle();
@@ -1422,7 +1778,8 @@ void Window::onReshape(uint width, uint height)
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
 	glOrtho(0.0, static_cast<GLdouble>(width), static_cast<GLdouble>(height), 0.0, 0.0, 1.0);
-	glViewport(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+	// width and height are in widget units, the viewport always covers the whole window
+	glViewport(0, 0, static_cast<GLsizei>(pData->fWidth), static_cast<GLsizei>(pData->fHeight));
 	glMatrixMode(GL_MODELVIEW);
 	glLoadIdentity();
 }
@@ -1442,7 +1799,7 @@ void Window::setMinSize(uint width, uint height)
 {
 #if defined(DISTRHO_OS_MAC)
 	[pData->mWindow setContentMinSize:NSMakeSize(width, height)];
-#elif !defined(DISTRHO_OS_WINDOWS) //Linux
+#elif !defined(DISTRHO_OS_WINDOWS) && !defined(DGL_HEADLESS) //Linux
 	XSizeHints sizeHints;
 	memset(&sizeHints, 0, sizeof(sizeHints));
 
@@ -1463,7 +1820,11 @@ Point<int> Window::getAbsolutePos()
 	int posX;
 	int posY;
 
-#if !defined(DISTRHO_OS_WINDOWS) && !defined(DISTRHO_OS_MAC)
+#if defined(DGL_HEADLESS)
+	posX = posY = 0;
+
+	return Point<int>(posX, posY);
+#elif !defined(DISTRHO_OS_WINDOWS) && !defined(DISTRHO_OS_MAC)
 	::Window unused;
 
 	XTranslateCoordinates(pData->xDisplay,
@@ -1485,19 +1846,23 @@ Point<int> Window::getAbsolutePos()
 
 void Window::setAbsolutePos(const uint x, const uint y)
 {
-#if !defined(DISTRHO_OS_WINDOWS) && !defined(DISTRHO_OS_MAC)
+#if !defined(DISTRHO_OS_WINDOWS) && !defined(DISTRHO_OS_MAC) && !defined(DGL_HEADLESS)
 	XMoveWindow(pData->xDisplay, pData->xWindow, x, y);
 
 #elif defined(DISTRHO_OS_WINDOWS)	
 	SetWindowPos(pData->hwnd, HWND_TOP, x, y, getWidth(), getHeight(), isVisible() ? SWP_SHOWWINDOW : SWP_HIDEWINDOW);
 
+#else
+	// unused
+	(void)x;
+	(void)y;
 #endif
 }
 
 //TODO: proper "ContextWindow" class, or similar
 void Window::hideFromTaskbar()
 {
-#if !defined(DISTRHO_OS_WINDOWS) && !defined(DISTRHO_OS_MAC)
+#if !defined(DISTRHO_OS_WINDOWS) && !defined(DISTRHO_OS_MAC) && !defined(DGL_HEADLESS)
 	Atom wmState = XInternAtom(pData->xDisplay,  "_NET_WM_STATE", False);
 	Atom atom = XInternAtom(pData->xDisplay, "_NET_WM_STATE_SKIP_TASKBAR", False);
 
@@ -1517,7 +1882,7 @@ void Window::hideFromTaskbar()
 
 void Window::setBorderless(bool borderless)
 {
-#if !defined(DISTRHO_OS_WINDOWS) && !defined(DISTRHO_OS_MAC)
+#if !defined(DISTRHO_OS_WINDOWS) && !defined(DISTRHO_OS_MAC) && !defined(DGL_HEADLESS)
 	struct MwmHints {
     	unsigned long flags;
     	unsigned long functions;
@@ -1548,12 +1913,15 @@ void Window::setBorderless(bool borderless)
 	LONG lStyle = GetWindowLong(pData->hwnd, GWL_STYLE);
 	lStyle &= ~(WS_CAPTION | WS_THICKFRAME | WS_MINIMIZEBOX | WS_MAXIMIZEBOX | WS_SYSMENU);
 	SetWindowLong(pData->hwnd, GWL_STYLE, lStyle);
+#else
+	// unused
+	(void)borderless;
 #endif
 }
 
 void Window::toggleFullscreen()
 {
-#if !defined(DISTRHO_OS_WINDOWS) && !defined(DISTRHO_OS_MAC)
+#if !defined(DISTRHO_OS_WINDOWS) && !defined(DISTRHO_OS_MAC) && !defined(DGL_HEADLESS)
 	XUnmapWindow(pData->xDisplay, pData->xWindow);
 	XSync(pData->xDisplay, False);
 
@@ -1594,7 +1962,10 @@ bool Window::mustSaveSize()
 
 void Window::setCursorStyle(CursorStyle style) noexcept
 {
-#if defined(DISTRHO_OS_WINDOWS)	
+#if defined(DGL_HEADLESS)
+	// no cursor to change
+	(void)style;
+#elif defined(DISTRHO_OS_WINDOWS)	
 	LPCSTR cursorName;
 
 	switch (style)
@@ -1680,7 +2051,9 @@ void Window::setCursorStyle(CursorStyle style) noexcept
 
 void Window::showCursor() noexcept
 {
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+	// no cursor to show
+#elif defined(DISTRHO_OS_WINDOWS)
 	while (ShowCursor(true) < 0)
 		;
 
@@ -1696,7 +2069,9 @@ void Window::showCursor() noexcept
 
 void Window::hideCursor() noexcept
 {
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+	// no cursor to hide
+#elif defined(DISTRHO_OS_WINDOWS)
 	while (ShowCursor(false) >= 0)
 		;
 
@@ -1712,13 +2087,17 @@ void Window::hideCursor() noexcept
 
 const Point<int> Window::getCursorPos() const noexcept
 {
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+	return Point<int>(pData->toWidgetUnits(pData->headlessCursorPos.getX()),
+					  pData->toWidgetUnits(pData->headlessCursorPos.getY()));
+
+#elif defined(DISTRHO_OS_WINDOWS)
 	POINT pos;
 	GetCursorPos(&pos);
 
 	ScreenToClient(pData->hwnd, &pos);
 
-	return Point<int>(pos.x, pos.y);
+	return Point<int>(pData->toWidgetUnits(pos.x), pData->toWidgetUnits(pos.y));
 
 #elif defined(DISTRHO_OS_MAC)
 	NSPoint mouseLoc = [NSEvent mouseLocation];
@@ -1727,7 +2106,7 @@ const Point<int> Window::getCursorPos() const noexcept
 	const int y = static_cast<int>(pData->fHeight - mouseLoc.y); //flip y so that the origin is at the top left
 
 	fprintf(stderr, "%d %d\n", x, y);
-	return Point<int>(x, y);
+	return Point<int>(pData->toWidgetUnits(x), pData->toWidgetUnits(y));
 
 #else
 	int posX, posY;
@@ -1739,7 +2118,7 @@ const Point<int> Window::getCursorPos() const noexcept
 
 	XQueryPointer(pData->xDisplay, pData->xWindow, &w, &w, &i, &i, &posX, &posY, &u);
 
-	return Point<int>(posX, posY);
+	return Point<int>(pData->toWidgetUnits(posX), pData->toWidgetUnits(posY));
 #endif
 }
 
@@ -1748,7 +2127,13 @@ const Point<int> Window::getCursorPos() const noexcept
  */
 void Window::setCursorPos(int x, int y) noexcept
 {
-#if defined(DISTRHO_OS_WINDOWS)
+	x = pData->toWindowPixels(x);
+	y = pData->toWindowPixels(y);
+
+#if defined(DGL_HEADLESS)
+	pData->headlessCursorPos = Point<int>(x, y);
+
+#elif defined(DISTRHO_OS_WINDOWS)
 	RECT winRect;
 	GetWindowRect(pData->hwnd, &winRect);
 
@@ -1794,7 +2179,13 @@ void Window::clipCursor(Rectangle<int> rect) const noexcept
 {
 	pData->fCursorIsClipped = true;
 
-#if defined(DISTRHO_OS_WINDOWS)
+	rect = Rectangle<int>(pData->toWindowPixels(rect.getX()), pData->toWindowPixels(rect.getY()),
+						  pData->toWindowPixels(rect.getWidth()), pData->toWindowPixels(rect.getHeight()));
+
+#if defined(DGL_HEADLESS)
+	// no cursor to confine
+
+#elif defined(DISTRHO_OS_WINDOWS)
 	RECT winRect, clipRect;
 	GetWindowRect(pData->hwnd, &winRect);
 
@@ -1830,7 +2221,10 @@ void Window::unclipCursor() const noexcept
 {
 	pData->fCursorIsClipped = false;
 
-#if defined(DISTRHO_OS_WINDOWS)
+#if defined(DGL_HEADLESS)
+	// no cursor to release
+
+#elif defined(DISTRHO_OS_WINDOWS)
 	ClipCursor(NULL);
 
 #elif defined(DISTRHO_OS_MAC)
@@ -309,6 +309,20 @@ typedef struct {
 	bool          focus;       /**< True iff this is the focused window. */
 } PuglEventMotion;
 
+/**
+   Maximum number of pointer positions merged into a single motion event.
+*/
+#define PUGL_MAX_MOTION_HISTORY 64
+
+/**
+   Pointer position of a motion event that was merged into a later one.
+*/
+typedef struct {
+	uint32_t time;             /**< Time in milliseconds. */
+	double   x;                /**< View-relative X coordinate. */
+	double   y;                /**< View-relative Y coordinate. */
+} PuglMotionPoint;
+
 /**
    Scroll event.
 
@@ -507,6 +521,18 @@ puglGetVisible(PuglView* view);
 PUGL_API void
 puglGetSize(PuglView* view, int* width, int* height);
 
+/**
+   Get the positions of the motion events merged into the current one.
+
+   Consecutive pointer motion events that are already queued are dispatched as
+   a single PUGL_MOTION_NOTIFY event with the latest position.  The earlier
+   positions, oldest first, are only valid while that event is dispatched.
+
+   @return The number of merged positions, 0 if nothing was merged.
+*/
+PUGL_API int
+puglGetMotionHistory(PuglView* view, const PuglMotionPoint** points);
+
 /**
    @name Context
    Functions for accessing the drawing context.
@@ -0,0 +1,294 @@
+/*
+  Copyright 2012-2018 Filipe Coelho <falktx@falktx.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/**
+   @file pugl_headless.c Headless Pugl Implementation.
+
+   Renders into an EGL pbuffer instead of a window, so it needs neither a
+   display server nor a GPU (Mesa's software renderer is enough).
+   There are no input events, the view only receives configure and expose.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+
+#include "pugl/pugl_internal.h"
+
+struct PuglInternalsImpl {
+	EGLDisplay display;
+	EGLConfig  config;
+	EGLContext ctx;
+	EGLSurface surface;
+	int        surfaceWidth;
+	int        surfaceHeight;
+	bool       configured;
+};
+
+PuglInternals*
+puglInitInternals(void)
+{
+	return (PuglInternals*)calloc(1, sizeof(PuglInternals));
+}
+
+static EGLDisplay
+getDisplay(void)
+{
+	// prefer Mesa's surfaceless platform, which works without any display server
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+	if (getPlatformDisplay) {
+		EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+		                                        EGL_DEFAULT_DISPLAY, NULL);
+		if (display != EGL_NO_DISPLAY && eglInitialize(display, NULL, NULL)) {
+			return display;
+		}
+	}
+#endif
+
+	EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	if (display != EGL_NO_DISPLAY && eglInitialize(display, NULL, NULL)) {
+		return display;
+	}
+
+	return EGL_NO_DISPLAY;
+}
+
+static bool
+createSurface(PuglView* view, int width, int height)
+{
+	PuglInternals* const impl = view->impl;
+
+	const EGLint attrs[] = {
+		EGL_WIDTH,  width,
+		EGL_HEIGHT, height,
+		EGL_NONE
+	};
+
+	const EGLSurface surface = eglCreatePbufferSurface(impl->display, impl->config, attrs);
+	if (surface == EGL_NO_SURFACE) {
+		fprintf(stderr, "error: failed to create %ix%i pbuffer\n", width, height);
+		return false;
+	}
+
+	if (impl->surface != EGL_NO_SURFACE) {
+		if (eglGetCurrentSurface(EGL_DRAW) == impl->surface) {
+			eglMakeCurrent(impl->display, surface, surface, impl->ctx);
+		}
+		eglDestroySurface(impl->display, impl->surface);
+	}
+
+	impl->surface       = surface;
+	impl->surfaceWidth  = width;
+	impl->surfaceHeight = height;
+	return true;
+}
+
+void
+puglEnterContext(PuglView* view)
+{
+	eglMakeCurrent(view->impl->display, view->impl->surface, view->impl->surface, view->impl->ctx);
+}
+
+void
+puglLeaveContext(PuglView* view, bool flush)
+{
+	if (flush) {
+		glFlush();
+	}
+
+	eglMakeCurrent(view->impl->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+int
+puglCreateWindow(PuglView* view, const char* title)
+{
+	PuglInternals* const impl = view->impl;
+
+	impl->display = getDisplay();
+	if (impl->display == EGL_NO_DISPLAY) {
+		fprintf(stderr, "error: failed to initialize EGL\n");
+		return 1;
+	}
+
+	// nanovg needs a stencil buffer
+	const EGLint configAttrs[] = {
+		EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE,        8,
+		EGL_GREEN_SIZE,      8,
+		EGL_BLUE_SIZE,       8,
+		EGL_ALPHA_SIZE,      8,
+		EGL_STENCIL_SIZE,    8,
+		EGL_NONE
+	};
+
+	EGLint numConfigs = 0;
+	if (!eglChooseConfig(impl->display, configAttrs, &impl->config, 1, &numConfigs) || numConfigs == 0) {
+		fprintf(stderr, "error: no suitable EGL config\n");
+		return 1;
+	}
+
+	// DGL uses the fixed-function pipeline, so this must be desktop GL
+	eglBindAPI(EGL_OPENGL_API);
+
+	impl->ctx = eglCreateContext(impl->display, impl->config, EGL_NO_CONTEXT, NULL);
+	if (impl->ctx == EGL_NO_CONTEXT) {
+		fprintf(stderr, "error: failed to create EGL context\n");
+		return 2;
+	}
+
+	if (!createSurface(view, view->width, view->height)) {
+		return 2;
+	}
+
+	return 0;
+
+	// unused
+	(void)title;
+}
+
+/** Resize the offscreen surface, the view gets a configure event on the next puglProcessEvents(). */
+static void
+puglHeadlessResize(PuglView* view, int width, int height)
+{
+	view->width  = width;
+	view->height = height;
+}
+
+void
+puglShowWindow(PuglView* view)
+{
+	view->visible   = true;
+	view->redisplay = true;
+}
+
+void
+puglHideWindow(PuglView* view)
+{
+	view->visible = false;
+}
+
+void
+puglDestroy(PuglView* view)
+{
+	if (view) {
+		PuglInternals* const impl = view->impl;
+
+		if (impl->display != EGL_NO_DISPLAY) {
+			if (eglGetCurrentContext() == impl->ctx) {
+				eglMakeCurrent(impl->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+			}
+			if (impl->surface != EGL_NO_SURFACE) {
+				eglDestroySurface(impl->display, impl->surface);
+			}
+			if (impl->ctx != EGL_NO_CONTEXT) {
+				eglDestroyContext(impl->display, impl->ctx);
+			}
+			// the display is shared by all views, eglTerminate() would destroy their resources too
+		}
+
+		free(view->windowClass);
+		free(view->impl);
+		free(view);
+	}
+}
+
+void
+puglGrabFocus(PuglView* view)
+{
+	// unused
+	(void)view;
+}
+
+PuglStatus
+puglWaitForEvent(PuglView* view)
+{
+	// unused
+	(void)view;
+	return PUGL_SUCCESS;
+}
+
+PuglStatus
+puglProcessEvents(PuglView* view)
+{
+	PuglInternals* const impl = view->impl;
+
+	if (impl->surface == EGL_NO_SURFACE) {
+		return PUGL_SUCCESS;
+	}
+
+	const bool resized = view->width != impl->surfaceWidth || view->height != impl->surfaceHeight;
+
+	if (resized && !createSurface(view, view->width, view->height)) {
+		return PUGL_SUCCESS;
+	}
+
+	// the first configure event is sent here too, like a window being mapped
+	if (resized || !impl->configured) {
+		PuglEvent config_event = { PUGL_NOTHING };
+		config_event.configure.type   = PUGL_CONFIGURE;
+		config_event.configure.view   = view;
+		config_event.configure.width  = view->width;
+		config_event.configure.height = view->height;
+		puglDispatchEvent(view, &config_event);
+
+		impl->configured = true;
+		view->redisplay  = true;
+	}
+
+	if (view->redisplay && view->visible) {
+		PuglEvent expose_event = { PUGL_NOTHING };
+		expose_event.expose.type   = PUGL_EXPOSE;
+		expose_event.expose.view   = view;
+		expose_event.expose.x      = 0;
+		expose_event.expose.y      = 0;
+		expose_event.expose.width  = view->width;
+		expose_event.expose.height = view->height;
+		view->redisplay            = false;
+		puglDispatchEvent(view, &expose_event);
+	}
+
+	return PUGL_SUCCESS;
+}
+
+void
+puglPostRedisplay(PuglView* view)
+{
+	view->redisplay = true;
+}
+
+PuglNativeWindow
+puglGetNativeWindow(PuglView* view)
+{
+	// there is no window to embed into or to embed
+	(void)view;
+	return 0;
+}
+
+void*
+puglGetContext(PuglView* view)
+{
+	// unused
+	(void)view;
+	return NULL;
+}
@@ -60,6 +60,9 @@ struct PuglViewImpl {
 	bool     visible;
 	
 	PuglFileSelectedFunc fileSelectedFunc;
+
+	PuglMotionPoint motionHistory[PUGL_MAX_MOTION_HISTORY];
+	int             motionHistorySize;
 };
 
 PuglInternals* puglInitInternals(void);
@@ -164,6 +167,13 @@ puglGetVisible(PuglView* view)
 	return view->visible;
 }
 
+int
+puglGetMotionHistory(PuglView* view, const PuglMotionPoint** points)
+{
+	*points = view->motionHistory;
+	return view->motionHistorySize;
+}
+
 void
 puglGetSize(PuglView* view, int* width, int* height)
 {
@@ -189,6 +199,7 @@ puglSetFileSelectedFunc(PuglView* view, PuglFileSelectedFunc fileSelectedFunc)
 	view->fileSelectedFunc = fileSelectedFunc;
 }
 
+#ifdef PUGL_HAVE_UTF8_DECODE
 /** Return the code point for buf, or the replacement character on error. */
 static uint32_t
 puglDecodeUTF8(const uint8_t* buf)
@@ -222,6 +233,7 @@ puglDecodeUTF8(const uint8_t* buf)
 	}
 	return 0xFFFD;
 }
+#endif
 
 static void
 puglDispatchEvent(PuglView* view, const PuglEvent* event)
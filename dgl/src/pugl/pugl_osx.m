@@ -25,6 +25,8 @@
 
 #include "pugl/cairo_gl.h"
 #include "pugl/gl.h"
+// used for key events
+#define PUGL_HAVE_UTF8_DECODE
 #include "pugl/pugl_internal.h"
 
 @class PuglOpenGLView;
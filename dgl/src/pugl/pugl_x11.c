@@ -40,6 +40,8 @@
 #endif
 
 #include "pugl/cairo_gl.h"
+// used for key events
+#define PUGL_HAVE_UTF8_DECODE
 #include "pugl/pugl_internal.h"
 
 #ifndef DGL_FILE_BROWSER_DISABLED
@@ -670,6 +672,27 @@ puglProcessEvents(PuglView* view)
 					continue;
 				}
 			}
+		} else if (xevent.type == MotionNotify) {
+			// Merge queued motion events, only the latest position is dispatched
+			view->motionHistorySize = 0;
+
+			while (view->motionHistorySize < PUGL_MAX_MOTION_HISTORY &&
+			       XEventsQueued(view->impl->display, QueuedAfterReading)) {
+				XEvent next;
+				XPeekEvent(view->impl->display, &next);
+				if (next.type != MotionNotify ||
+				    next.xmotion.window != xevent.xmotion.window ||
+				    next.xmotion.state != xevent.xmotion.state) {
+					break;
+				}
+
+				PuglMotionPoint* const point = &view->motionHistory[view->motionHistorySize++];
+				point->time = xevent.xmotion.time;
+				point->x    = xevent.xmotion.x;
+				point->y    = xevent.xmotion.y;
+
+				XNextEvent(view->impl->display, &xevent);
+			}
 		} else if (xevent.type == FocusIn) {
 			XSetICFocus(view->impl->xic);
 		} else if (xevent.type == FocusOut) {
@@ -689,6 +712,8 @@ puglProcessEvents(PuglView* view)
 			// Dispatch event to application immediately
 			puglDispatchEvent(view, &event);
 		}
+
+		view->motionHistorySize = 0;
 	}
 
 	if (config_event.type) {
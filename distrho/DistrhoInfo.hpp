@@ -32,7 +32,8 @@ START_NAMESPACE_DISTRHO
    The framework facilitates exporting various different plugin formats from the same code-base.
 
    DPF can build for LADSPA, DSSI, LV2 and VST2 formats.@n
-   A JACK/Standalone mode is also available, allowing you to quickly test plugins.
+   A JACK/Standalone mode is also available, allowing you to quickly test plugins.@n
+   An offline render mode can process audio files or generated signals without a host, useful for regression tests and benchmarks.
 
    @section Macros
    You start by creating a "DistrhoPluginInfo.h" file describing the plugin via macros, see @ref PluginMacros.@n
@@ -511,12 +512,52 @@ START_NAMESPACE_DISTRHO
  */
 #define DISTRHO_PLUGIN_WANT_DIRECT_ACCESS 0
 
+/**
+   Wherever the plugin implements a double precision run() function.@n
+   Hosts processing in double precision then pass their buffers directly, without converting to single precision.@n
+   Plugins without it can still be used by such hosts, DPF converts the buffers for them.
+   @note Currently only used by the VST format.
+ */
+#define DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION 0
+
 /**
    Wherever the plugin introduces latency during audio or midi processing.
    @see Plugin::setLatency(uint32_t)
  */
 #define DISTRHO_PLUGIN_WANT_LATENCY 1
 
+/**
+   Wherever the plugin output only depends on its inputs and MIDI events, with a known tail.@n
+   When enabled, run() is skipped and the outputs are zeroed while the inputs are silent,
+   there are no MIDI events and the tail is over.@n
+   Plugins without audio inputs, like synths, are only skipped after calling Plugin::setOutputSilent(),
+   as a held note can sound for any time after its MIDI event.@n
+   VST hosts are told the tail length, other formats have no such concept.
+   @see Plugin::setTailLength(uint32_t)
+   @see Plugin::setOutputSilent()
+ */
+#define DISTRHO_PLUGIN_WANT_TAIL 1
+
+/**
+   Wherever denormals should be flushed to zero during run().@n
+   Many hosts leave this to plugins, filter and reverb tails then decay into denormals and the CPU load spikes.@n
+   When enabled, FTZ/DAZ (x86) or FZ (ARM) are set before calling run() and the host settings are restored afterwards.
+   @see ScopedDenormalDisable
+ */
+#define DISTRHO_PLUGIN_WANT_FLUSH_DENORMALS 1
+
+/**
+   Wherever DPF handles bypass instead of the plugin.@n
+   When bypass is engaged the output is crossfaded to the dry signal (delayed by the plugin latency) over 10ms,
+   after which run() is not called anymore and the inputs are copied to the outputs.
+   Disengaging deactivates and activates the plugin again to clear its old state,
+   keeps the dry signal for the plugin latency and then crossfades back to the plugin output.@n
+   Bypass is controlled by the parameter with the bypass designation, and by the host bypass in VST.
+   That parameter is still passed to the plugin, which does not need to do anything with it.
+   @see kParameterDesignationBypass
+ */
+#define DISTRHO_PLUGIN_WANT_HOST_BYPASS 1
+
 /**
    Wherever the plugin wants MIDI input.@n
    This is automatically enabled if @ref DISTRHO_PLUGIN_IS_SYNTH is true.
@@ -536,6 +577,21 @@ START_NAMESPACE_DISTRHO
  */
 #define DISTRHO_PLUGIN_WANT_PROGRAMS 1
 
+/**
+   Wherever programs requested by the host are loaded outside of the audio thread.@n
+   Plugin::loadProgram(uint32_t) is then called on a separate plugin instance in a background thread,
+   and the resulting parameter values and states are applied to the plugin at the start of a later audio block,
+   usually within a few milliseconds. Only an active plugin loads programs this way.
+   This keeps program changes from the audio thread glitch-free, even if loading a program is slow.@n
+   That instance starts from the current parameter values and states of the plugin,
+   and only what loadProgram() changes through parameters and states is carried over, so it must not touch anything else.@n
+   Changed states are applied with Plugin::setState(const char*, const char*) from the audio thread,
+   so it must be realtime safe for the states programs change.@n
+   Requires @ref DISTRHO_PLUGIN_WANT_PROGRAMS.
+   @see Plugin::loadProgram(uint32_t)
+ */
+#define DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS 1
+
 /**
    Wherever the plugin uses internal non-parameter data.
    @see Plugin::initState(uint32_t, String&, String&)
@@ -561,6 +617,18 @@ START_NAMESPACE_DISTRHO
  */
 #define DISTRHO_UI_URI DISTRHO_PLUGIN_URI "#UI"
 
+/**
+   The initial size of the %UI, in pixels.@n
+   Lets plugin formats report the editor size without creating the %UI (which means creating a window and
+   a GL context), and is used as the default size in the UI constructor.
+   When not set, the VST wrapper creates a temporary %UI instance the first time the host asks for the size.
+   Only VST needs the size before the %UI exists, LV2, DSSI and JACK get it from the %UI once created.
+   @note Both macros must be set together, and must match the size the %UI is created with.
+         A %UI constructed with a different size prints a warning.
+ */
+#define DISTRHO_UI_DEFAULT_WIDTH 800
+#define DISTRHO_UI_DEFAULT_HEIGHT 600
+
 /** @} */
 
 // -----------------------------------------------------------------------------------------------------------
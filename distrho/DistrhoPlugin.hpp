@@ -160,7 +160,8 @@ enum ParameterDesignation {
 
    /**
      Bypass designation.@n
-     When on (> 0.5f), it means the plugin must run in a bypassed state.
+     When on (> 0.5f), it means the plugin must run in a bypassed state.@n
+     With DISTRHO_PLUGIN_WANT_HOST_BYPASS enabled this is handled by DPF, and run() is not called while bypassed.
     */
     kParameterDesignationBypass = 1
 };
@@ -573,7 +574,8 @@ struct TimePosition {
         double ticksPerBeat;
 
        /**
-          Number of beats per minute.
+          Number of beats per minute.@n
+          Beats are counted in @a beatType units, so 120 quarter notes per minute are 240 beats per minute in 6/8.
         */
         double beatsPerMinute;
 
@@ -601,6 +603,31 @@ struct TimePosition {
           bbt() {}
 };
 
+/**
+   Time position from a given frame within the current block.
+   Hosts can change tempo or position in the middle of a block, each change starts a new segment.
+   @see Plugin::getTimePositionSegments(uint32_t&)
+ */
+struct TimePositionSegment {
+   /**
+      Frame within the current block where this segment starts.@n
+      The first segment always starts at 0.
+    */
+    uint32_t frame;
+
+   /**
+      Time position at the start of this segment.
+    */
+    TimePosition position;
+
+   /**
+      Default constructor for a time position segment.
+    */
+    TimePositionSegment() noexcept
+        : frame(0),
+          position() {}
+};
+
 /** @} */
 
 /* ------------------------------------------------------------------------------------------------------------
@@ -636,6 +663,8 @@ struct TimePosition {
 
    The process function run() changes wherever DISTRHO_PLUGIN_WANT_MIDI_INPUT is enabled or not.@n
    When enabled it provides midi input events.
+
+   DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION adds a run() function for double precision buffers.
  */
 class Plugin
 {
@@ -674,10 +703,23 @@ public:
    /**
       Get the current host transport time position.@n
       This function should only be called during run().@n
-      You can call this during other times, but the returned position is not guaranteed to be in sync.
+      You can call this during other times, but the returned position is not guaranteed to be in sync.@n
+      Some formats only fetch the position from the host on the first call during each run(),
+      so there is no cost when it is not needed.
       @note TimePosition is not supported in LADSPA and DSSI plugin formats.
     */
     const TimePosition& getTimePosition() const noexcept;
+
+   /**
+      Get the host transport time position for each part of the current block.@n
+      Hosts that change tempo or position in the middle of a block give more than one segment,
+      with the position at the start of each one; the first one is the same as getTimePosition().@n
+      Formats that cannot report such changes always give a single segment.@n
+      This function should only be called during run().
+      @param count Number of segments, at least 1
+      @note Segments are supported in LV2, other formats give a single one.
+    */
+    const TimePositionSegment* getTimePositionSegments(uint32_t& count) const noexcept;
 #endif
 
 #if DISTRHO_PLUGIN_WANT_LATENCY
@@ -689,6 +731,27 @@ public:
     void setLatency(uint32_t frames) noexcept;
 #endif
 
+#if DISTRHO_PLUGIN_WANT_TAIL
+   /**
+      Change the plugin tail length to @a frames.@n
+      This is for how long the outputs can be non-silent after the inputs became silent, including any latency.@n
+      Once the tail is over run() is not called anymore, until the inputs become non-silent or MIDI events arrive.@n
+      Plugins without audio inputs are not stopped by the tail, only by setOutputSilent().@n
+      This function should only be called in the constructor, activate() and run().
+      @note This function is only available if DISTRHO_PLUGIN_WANT_TAIL is enabled.
+    */
+    void setTailLength(uint32_t frames) noexcept;
+
+   /**
+      Report the outputs of the current run() as silent, for as long as the inputs stay silent.@n
+      This ends the tail early, useful when the tail length varies (a reverb decaying faster at some settings).@n
+      Plugins without audio inputs must call this once all their voices are done, or run() is never skipped.@n
+      This function must only be called during run().
+      @note This function is only available if DISTRHO_PLUGIN_WANT_TAIL is enabled.
+    */
+    void setOutputSilent() noexcept;
+#endif
+
 #if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
    /**
       Write a MIDI output event.@n
@@ -755,20 +818,23 @@ protected:
 
    /**
       Initialize the audio port @a index.@n
-      This function will be called once, shortly after the plugin is created.
+      This function will be called once, shortly after the first plugin instance is created.@n
+      The result is shared by all instances in the process, so it must not depend on instance state.
     */
     virtual void initAudioPort(bool input, uint32_t index, AudioPort& port);
 
    /**
       Initialize the parameter @a index.@n
-      This function will be called once, shortly after the plugin is created.
+      This function will be called once, shortly after the first plugin instance is created.@n
+      The result is shared by all instances in the process, so it must not depend on instance state.
     */
     virtual void initParameter(uint32_t index, Parameter& parameter) = 0;
 
 #if DISTRHO_PLUGIN_WANT_PROGRAMS
    /**
       Set the name of the program @a index.@n
-      This function will be called once, shortly after the plugin is created.@n
+      This function will be called once, shortly after the first plugin instance is created.@n
+      The result is shared by all instances in the process, so it must not depend on instance state.@n
       Must be implemented by your plugin class only if DISTRHO_PLUGIN_WANT_PROGRAMS is enabled.
     */
     virtual void initProgramName(uint32_t index, String& programName) = 0;
@@ -777,7 +843,8 @@ protected:
 #if DISTRHO_PLUGIN_WANT_STATE
    /**
       Set the state key and default value of @a index.@n
-      This function will be called once, shortly after the plugin is created.@n
+      This function will be called once, shortly after the first plugin instance is created.@n
+      The result is shared by all instances in the process, so it must not depend on instance state.@n
       Must be implemented by your plugin class only if DISTRHO_PLUGIN_WANT_STATE is enabled.
     */
     virtual void initState(uint32_t index, String& stateKey, String& defaultStateValue) = 0;
@@ -800,10 +867,30 @@ protected:
     */
     virtual void setParameterValue(uint32_t index, float value) = 0;
 
+   /**
+      Get the text representation of a parameter @a value, for hosts that show parameters as text.@n
+      Write at most @a size bytes into @a text, including the null terminator.@n
+      The default implementation uses the label of the matching enumeration value,
+      or prints the value as a number (after rounding integer and boolean parameters).@n
+      The host may call this function from any non-realtime context.
+      @note The result may be cached per value, so it must only depend on @a index and @a value.
+    */
+    virtual void getParameterValueText(uint32_t index, float value, char* text, uint32_t size) const;
+
+   /**
+      Get the parameter value matching @a text, as typed by the user in the host.@n
+      The default implementation matches the labels of enumeration values, and parses numbers otherwise.@n
+      Return false if @a text is not a valid value for this parameter.@n
+      The host may call this function from any non-realtime context.
+    */
+    virtual bool getParameterValueFromText(uint32_t index, const char* text, float& value) const;
+
 #if DISTRHO_PLUGIN_WANT_PROGRAMS
    /**
       Load a program.@n
       The host may call this function from any context, including realtime processing.@n
+      With DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS enabled it is called from a background thread on another instance instead,
+      see @ref DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS.@n
       Must be implemented by your plugin class only if DISTRHO_PLUGIN_WANT_PROGRAMS is enabled.
     */
     virtual void loadProgram(uint32_t index) = 0;
@@ -855,6 +942,27 @@ protected:
     virtual void run(const float** inputs, float** outputs, uint32_t frames) = 0;
 #endif
 
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+   /**
+      Double precision run/process function for plugins with MIDI input.@n
+      Called instead of the single precision one when the host processes in double precision.@n
+      Must be implemented by your plugin class only if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION is enabled.
+      @note Some parameters might be null if there are no audio inputs/outputs or MIDI events.
+    */
+    virtual void run(const double** inputs, double** outputs, uint32_t frames,
+                     const MidiEvent* midiEvents, uint32_t midiEventCount) = 0;
+# else
+   /**
+      Double precision run/process function for plugins without MIDI input.@n
+      Called instead of the single precision one when the host processes in double precision.@n
+      Must be implemented by your plugin class only if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION is enabled.
+      @note Some parameters might be null if there are no audio inputs or outputs.
+    */
+    virtual void run(const double** inputs, double** outputs, uint32_t frames) = 0;
+# endif
+#endif
+
    /* --------------------------------------------------------------------------------------------------------
     * Callbacks (optional) */
 
@@ -880,6 +988,9 @@ private:
     struct PrivateData;
     PrivateData* const pData;
     friend class PluginExporter;
+#if DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS
+    friend class ProgramLoader;
+#endif
 
     DISTRHO_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Plugin)
 };
@@ -53,8 +53,9 @@ public:
    /**
       UI class constructor.
       The UI should be initialized to a default state that matches the plugin side.
+      The size defaults to DISTRHO_UI_DEFAULT_WIDTH and DISTRHO_UI_DEFAULT_HEIGHT, if set.
     */
-    UI(uint width = 0, uint height = 0);
+    UI(uint width = DISTRHO_UI_DEFAULT_WIDTH, uint height = DISTRHO_UI_DEFAULT_HEIGHT);
 
    /**
       Destructor.
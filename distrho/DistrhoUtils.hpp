@@ -24,6 +24,7 @@
 #include <cstdlib>
 #include <cstring>
 
+#include <clocale>
 #include <cmath>
 #include <limits>
 
@@ -228,6 +229,337 @@ uint32_t d_nextPowerOf2(uint32_t size) noexcept
     return ++size;
 }
 
+// -----------------------------------------------------------------------
+// locale-independent floating point conversion
+
+/*
+ * Get an exact power of 10, 'exp' must be between 0 and 22.
+ */
+static inline
+double d_pow10(const int exp) noexcept
+{
+    static const double kPowersOf10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    DISTRHO_SAFE_ASSERT_RETURN(exp >= 0 && exp <= 22, 1.0);
+
+    return kPowersOf10[exp];
+}
+
+/*
+ * Write the shortest decimal representation of 'value' that converts back to the same value.
+ * Always uses '.' as decimal separator, regardless of the current locale.
+ * Plain notation is used for exponents between -6 and 20, scientific notation otherwise.
+ * 'strBuf' must have room for at least 32 characters. Returns the string length.
+ */
+static inline
+std::size_t d_fp2str(char* const strBuf, const double value, const bool singlePrecision) noexcept
+{
+    char* s = strBuf;
+
+    if (std::isnan(value))
+    {
+        std::memcpy(strBuf, "nan", 4);
+        return 3;
+    }
+
+    if (std::signbit(value))
+        *s++ = '-';
+
+    if (std::isinf(value))
+    {
+        std::memcpy(s, "inf", 4);
+        return static_cast<std::size_t>(s - strBuf) + 3;
+    }
+
+    if (value == 0.0)
+    {
+        *s++ = '0';
+        *s = '\0';
+        return static_cast<std::size_t>(s - strBuf);
+    }
+
+    const double absValue = std::fabs(value);
+
+    char digits[20];
+    int numDigits = 0, exponent = 0;
+
+    // fast path, scale by exact powers of 10 and take the first precision that converts back to the same value.
+    // the check matches what d_str2double does, where a single operation on exact values is correctly rounded
+    const int log10Value = static_cast<int>(std::floor(std::log10(absValue)));
+
+    for (int precision = 1, maxPrecision = singlePrecision ? 9 : 15; precision <= maxPrecision; ++precision)
+    {
+        const int scale = precision - 1 - log10Value;
+
+        if (scale < -22 || scale > 22)
+            break;
+
+        const double scaled = (scale >= 0) ? absValue * d_pow10(scale) : absValue / d_pow10(-scale);
+        const uint64_t mantissa = static_cast<uint64_t>(scaled + 0.5);
+        const double check = (scale >= 0) ? static_cast<double>(mantissa) / d_pow10(scale)
+                                          : static_cast<double>(mantissa) * d_pow10(-scale);
+
+        if (singlePrecision ? static_cast<float>(check) != static_cast<float>(absValue) : check != absValue)
+            continue;
+
+        char tmpBuf[20];
+        int tmpLen = 0;
+
+        for (uint64_t m = mantissa; m != 0; m /= 10)
+            tmpBuf[tmpLen++] = static_cast<char>('0' + m % 10);
+
+        for (int i=0; i < tmpLen; ++i)
+            digits[i] = tmpBuf[tmpLen-1-i];
+
+        numDigits = tmpLen;
+        exponent  = tmpLen - 1 - scale;
+        break;
+    }
+
+    // slow path, find the smallest precision that converts back to the same value using the C library.
+    // snprintf and strtod use the same locale, so this check does not depend on it
+    if (numDigits == 0)
+    {
+        char tmpBuf[32];
+        int low = 1, high = singlePrecision ? 9 : 17;
+
+        while (low < high)
+        {
+            const int precision = (low + high) / 2;
+            std::snprintf(tmpBuf, sizeof(tmpBuf), "%.*e", precision-1, absValue);
+
+            if (singlePrecision ? std::strtof(tmpBuf, nullptr) == static_cast<float>(absValue)
+                                : std::strtod(tmpBuf, nullptr) == absValue)
+                high = precision;
+            else
+                low = precision + 1;
+        }
+
+        std::snprintf(tmpBuf, sizeof(tmpBuf), "%.*e", low-1, absValue);
+
+        // split into digits and exponent, skipping the locale decimal separator
+        const char* t = tmpBuf;
+
+        for (; *t != 'e' && *t != '\0'; ++t)
+        {
+            if (*t >= '0' && *t <= '9' && numDigits < 20)
+                digits[numDigits++] = *t;
+        }
+
+        exponent = (*t == 'e') ? std::atoi(t+1) : 0;
+    }
+
+    for (; numDigits > 1 && digits[numDigits-1] == '0';)
+        --numDigits;
+
+    if (exponent >= -6 && exponent <= 20)
+    {
+        if (exponent < 0)
+        {
+            *s++ = '0';
+            *s++ = '.';
+
+            for (int i=-1; i > exponent; --i)
+                *s++ = '0';
+            for (int i=0; i < numDigits; ++i)
+                *s++ = digits[i];
+        }
+        else
+        {
+            for (int i=0; i <= exponent; ++i)
+                *s++ = (i < numDigits) ? digits[i] : '0';
+
+            if (numDigits > exponent+1)
+            {
+                *s++ = '.';
+
+                for (int i=exponent+1; i < numDigits; ++i)
+                    *s++ = digits[i];
+            }
+        }
+    }
+    else
+    {
+        *s++ = digits[0];
+
+        if (numDigits > 1)
+        {
+            *s++ = '.';
+
+            for (int i=1; i < numDigits; ++i)
+                *s++ = digits[i];
+        }
+
+        s += std::snprintf(s, 8, "e%d", exponent);
+    }
+
+    *s = '\0';
+    return static_cast<std::size_t>(s - strBuf);
+}
+
+/*
+ * Shortest round-trip representation of a single-precision number, see d_fp2str.
+ */
+static inline
+std::size_t d_float2str(char* const strBuf, const float value) noexcept
+{
+    return d_fp2str(strBuf, value, true);
+}
+
+/*
+ * Shortest round-trip representation of a double-precision number, see d_fp2str.
+ */
+static inline
+std::size_t d_double2str(char* const strBuf, const double value) noexcept
+{
+    return d_fp2str(strBuf, value, false);
+}
+
+/*
+ * Convert a string to a double-precision number, always using '.' as decimal separator.
+ * Numbers with up to 15 significant digits and small exponents are converted exactly without going through strtod.
+ * Like strtod, 'end' (if not null) is set to the first character after the number, or to 'str' if nothing was parsed.
+ */
+static inline
+double d_str2double(const char* const str, const char** const end = nullptr) noexcept
+{
+    if (end != nullptr)
+        *end = str;
+
+    DISTRHO_SAFE_ASSERT_RETURN(str != nullptr, 0.0);
+
+    const char* s = str;
+
+    for (; *s == ' ' || *s == '\t' || *s == '\n' || *s == '\r';)
+        ++s;
+
+    const bool negative = (*s == '-');
+
+    if (*s == '-' || *s == '+')
+        ++s;
+
+    uint64_t mantissa = 0;
+    int numDigits = 0, exponent = 0;
+    bool hasDigits = false, exact = true;
+
+    for (; *s >= '0' && *s <= '9'; ++s)
+    {
+        hasDigits = true;
+
+        if (numDigits < 15)
+        {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*s - '0');
+            if (mantissa != 0)
+                ++numDigits;
+        }
+        else
+        {
+            exact = exact && *s == '0';
+            ++exponent;
+        }
+    }
+
+    if (*s == '.')
+    {
+        for (++s; *s >= '0' && *s <= '9'; ++s)
+        {
+            hasDigits = true;
+
+            if (numDigits < 15)
+            {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*s - '0');
+                if (mantissa != 0)
+                    ++numDigits;
+                --exponent;
+            }
+            else
+            {
+                exact = exact && *s == '0';
+            }
+        }
+    }
+
+    if (hasDigits && (*s == 'e' || *s == 'E'))
+    {
+        const char* e = s + 1;
+        const bool negativeExp = (*e == '-');
+
+        if (*e == '-' || *e == '+')
+            ++e;
+
+        if (*e >= '0' && *e <= '9')
+        {
+            int exp = 0;
+
+            for (; *e >= '0' && *e <= '9'; ++e)
+            {
+                if (exp < 10000)
+                    exp = exp * 10 + (*e - '0');
+            }
+
+            exponent += negativeExp ? -exp : exp;
+            s = e;
+        }
+    }
+
+    // the mantissa and the power of 10 are exact, so a single multiplication or division is correctly rounded
+    // (hexadecimal numbers stop at the 'x' here and are left to strtod)
+    if (hasDigits && exact && exponent >= -22 && exponent <= 22 && *s != 'x' && *s != 'X')
+    {
+        if (end != nullptr)
+            *end = s;
+
+        const double fvalue = static_cast<double>(mantissa);
+        const double result = (exponent < 0) ? fvalue / d_pow10(-exponent) : fvalue * d_pow10(exponent);
+        return negative ? -result : result;
+    }
+
+    // slow path, strtod expects the locale decimal separator
+    const struct lconv* const lc = std::localeconv();
+    const char decimalPoint = (lc != nullptr && lc->decimal_point != nullptr && lc->decimal_point[0] != '\0')
+                            ? lc->decimal_point[0] : '.';
+
+    char* tmpEnd = nullptr;
+
+    if (decimalPoint == '.')
+    {
+        const double result = std::strtod(str, &tmpEnd);
+
+        if (end != nullptr)
+            *end = tmpEnd;
+
+        return result;
+    }
+
+    char tmpBuf[64];
+    std::strncpy(tmpBuf, str, sizeof(tmpBuf)-1);
+    tmpBuf[sizeof(tmpBuf)-1] = '\0';
+
+    if (char* const dot = std::strchr(tmpBuf, '.'))
+        *dot = decimalPoint;
+
+    const double result = std::strtod(tmpBuf, &tmpEnd);
+
+    // tmpBuf is a copy of str, so offsets match
+    if (end != nullptr)
+        *end = str + (tmpEnd - tmpBuf);
+
+    return result;
+}
+
+/*
+ * Convert a string to a single-precision number, always using '.' as decimal separator.
+ * See d_str2double for 'end'.
+ */
+static inline
+float d_str2float(const char* const str, const char** const end = nullptr) noexcept
+{
+    return static_cast<float>(d_str2double(str, end));
+}
+
 // -----------------------------------------------------------------------
 
 #ifndef DONT_SET_USING_DISTRHO_NAMESPACE
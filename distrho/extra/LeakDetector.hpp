@@ -1,6 +1,6 @@
 /*
  * DISTRHO Plugin Framework (DPF)
- * Copyright (C) 2012-2016 Filipe Coelho <falktx@falktx.com>
+ * Copyright (C) 2012-2018 Filipe Coelho <falktx@falktx.com>
  *
  * Permission to use, copy, modify, and/or distribute this software for any purpose with
  * or without fee is hereby granted, provided that the above copyright notice and this
@@ -19,6 +19,10 @@
 
 #include "../DistrhoUtils.hpp"
 
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+# include <atomic>
+#endif
+
 START_NAMESPACE_DISTRHO
 
 // -----------------------------------------------------------------------
@@ -32,7 +36,17 @@ START_NAMESPACE_DISTRHO
 #define DISTRHO_JOIN_MACRO_HELPER(a, b) a ## b
 #define DISTRHO_JOIN_MACRO(item1, item2) DISTRHO_JOIN_MACRO_HELPER(item1, item2)
 
-#ifdef DEBUG
+/** Define DISTRHO_LEAK_DETECTOR_STATS to keep leak detection active on release builds.\n
+    Object counters are cheap relaxed atomics (or __sync builtins without C++11), so this can be used to watch live and peak object counts
+    of long-running sessions, see d_printLeakDetectorStats().
+*/
+#if defined(DEBUG) || defined(DISTRHO_LEAK_DETECTOR_STATS)
+# define DISTRHO_LEAK_DETECTOR_ENABLED 1
+#else
+# define DISTRHO_LEAK_DETECTOR_ENABLED 0
+#endif
+
+#if DISTRHO_LEAK_DETECTOR_ENABLED
 /** This macro lets you embed a leak-detecting object inside a class.\n
     To use it, simply declare a DISTRHO_LEAK_DETECTOR(YourClassName) inside a private section
     of the class declaration. E.g.
@@ -63,6 +77,161 @@ START_NAMESPACE_DISTRHO
     DISTRHO_DECLARE_NON_COPY_CLASS(ClassName)
 #endif
 
+//==============================================================================
+/**
+    Per-class object counter used by LeakedObjectDetector.
+
+    All counters register themselves in a global list when first used,
+    so that the current statistics of every tracked class can be printed at runtime.
+*/
+class LeakedObjectCounter
+{
+public:
+    LeakedObjectCounter(const char* const className) noexcept
+        : fClassName(className),
+          fNumObjects(0),
+          fPeakObjects(0),
+          fTotalObjects(0),
+          fNext(nullptr)
+    {
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+        fNext = getList().load(std::memory_order_relaxed);
+        while (! getList().compare_exchange_weak(fNext, this, std::memory_order_release, std::memory_order_relaxed)) {}
+#else
+        do {
+            fNext = getList();
+        } while (! __sync_bool_compare_and_swap(&getList(), fNext, this));
+#endif
+    }
+
+    ~LeakedObjectCounter() noexcept
+    {
+        const int numObjects = getNumObjects();
+
+        if (numObjects > 0)
+        {
+            /** If you hit this, then you've leaked one or more objects of the type specified by
+                the 'OwnerClass' template parameter - the name should have been printed by the line above.
+
+                If you're leaking, it's probably because you're using old-fashioned, non-RAII techniques for
+                your object management. Tut, tut. Always, always use ScopedPointers, OwnedArrays,
+                ReferenceCountedObjects, etc, and avoid the 'delete' operator at all costs!
+            */
+            d_stderr2("*** Leaked objects detected: %i instance(s) of class '%s'", numObjects, fClassName);
+        }
+    }
+
+    void increment() noexcept
+    {
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+        const int numObjects = fNumObjects.fetch_add(1, std::memory_order_relaxed) + 1;
+        fTotalObjects.fetch_add(1, std::memory_order_relaxed);
+
+        for (int peak = fPeakObjects.load(std::memory_order_relaxed); numObjects > peak;)
+        {
+            if (fPeakObjects.compare_exchange_weak(peak, numObjects, std::memory_order_relaxed))
+                break;
+        }
+#else
+        const int numObjects = __sync_add_and_fetch(&fNumObjects, 1);
+        __sync_add_and_fetch(&fTotalObjects, 1);
+
+        for (int peak = fPeakObjects; numObjects > peak; peak = fPeakObjects)
+        {
+            if (__sync_bool_compare_and_swap(&fPeakObjects, peak, numObjects))
+                break;
+        }
+#endif
+    }
+
+    int decrement() noexcept
+    {
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+        return fNumObjects.fetch_sub(1, std::memory_order_relaxed) - 1;
+#else
+        return __sync_sub_and_fetch(&fNumObjects, 1);
+#endif
+    }
+
+    const char* getClassName() const noexcept
+    {
+        return fClassName;
+    }
+
+    int getNumObjects() const noexcept
+    {
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+        return fNumObjects.load(std::memory_order_relaxed);
+#else
+        return fNumObjects;
+#endif
+    }
+
+    int getPeakObjects() const noexcept
+    {
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+        return fPeakObjects.load(std::memory_order_relaxed);
+#else
+        return fPeakObjects;
+#endif
+    }
+
+    long getTotalObjects() const noexcept
+    {
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+        return fTotalObjects.load(std::memory_order_relaxed);
+#else
+        return fTotalObjects;
+#endif
+    }
+
+    const LeakedObjectCounter* getNext() const noexcept
+    {
+        return fNext;
+    }
+
+    static const LeakedObjectCounter* getFirst() noexcept
+    {
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+        return getList().load(std::memory_order_acquire);
+#else
+        const LeakedObjectCounter* const first = getList();
+        __sync_synchronize();
+        return first;
+#endif
+    }
+
+private:
+    const char* const fClassName;
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+    std::atomic<int>  fNumObjects;
+    std::atomic<int>  fPeakObjects;
+    std::atomic<long> fTotalObjects;
+#else
+    // no <atomic> without C++11, these are only accessed with __sync builtins or plain reads
+    volatile int  fNumObjects;
+    volatile int  fPeakObjects;
+    volatile long fTotalObjects;
+#endif
+    LeakedObjectCounter* fNext;
+
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+    static std::atomic<LeakedObjectCounter*>& getList() noexcept
+    {
+        static std::atomic<LeakedObjectCounter*> list(nullptr);
+        return list;
+    }
+#else
+    static LeakedObjectCounter* volatile& getList() noexcept
+    {
+        static LeakedObjectCounter* volatile list = nullptr;
+        return list;
+    }
+#endif
+
+    DISTRHO_DECLARE_NON_COPY_CLASS(LeakedObjectCounter)
+};
+
 //==============================================================================
 /**
     Embedding an instance of this class inside another class can be used as a low-overhead
@@ -80,12 +249,14 @@ class LeakedObjectDetector
 {
 public:
     //==============================================================================
-    LeakedObjectDetector() noexcept                            { ++(getCounter().numObjects); }
-    LeakedObjectDetector(const LeakedObjectDetector&) noexcept { ++(getCounter().numObjects); }
+    LeakedObjectDetector() noexcept                            { getCounter().increment(); }
+    LeakedObjectDetector(const LeakedObjectDetector&) noexcept { getCounter().increment(); }
 
     ~LeakedObjectDetector() noexcept
     {
-        if (--(getCounter().numObjects) < 0)
+        const int numObjects = getCounter().decrement();
+
+        if (numObjects < 0)
         {
             /** If you hit this, then you've managed to delete more instances of this class than you've
                 created.. That indicates that you're deleting some dangling pointers.
@@ -98,48 +269,37 @@ public:
                 your object management. Tut, tut. Always, always use ScopedPointers, OwnedArrays,
                 ReferenceCountedObjects, etc, and avoid the 'delete' operator at all costs!
             */
-            d_stderr2("*** Dangling pointer deletion! Class: '%s', Count: %i", getLeakedObjectClassName(), getCounter().numObjects);
+            d_stderr2("*** Dangling pointer deletion! Class: '%s', Count: %i", OwnerClass::getLeakedObjectClassName(), numObjects);
         }
     }
 
 private:
-    //==============================================================================
-    class LeakCounter
+    static LeakedObjectCounter& getCounter() noexcept
     {
-    public:
-        LeakCounter() noexcept
-            : numObjects(0) {}
-
-        ~LeakCounter() noexcept
-        {
-            if (numObjects > 0)
-            {
-                /** If you hit this, then you've leaked one or more objects of the type specified by
-                    the 'OwnerClass' template parameter - the name should have been printed by the line above.
-
-                    If you're leaking, it's probably because you're using old-fashioned, non-RAII techniques for
-                    your object management. Tut, tut. Always, always use ScopedPointers, OwnedArrays,
-                    ReferenceCountedObjects, etc, and avoid the 'delete' operator at all costs!
-                */
-                d_stderr2("*** Leaked objects detected: %i instance(s) of class '%s'", numObjects, getLeakedObjectClassName());
-            }
-        }
-
-        // this should be an atomic...
-        volatile int numObjects;
-    };
-
-    static const char* getLeakedObjectClassName() noexcept
-    {
-        return OwnerClass::getLeakedObjectClassName();
+        static LeakedObjectCounter counter(OwnerClass::getLeakedObjectClassName());
+        return counter;
     }
+};
+
+//==============================================================================
+/**
+    Print the live, peak and total object counts of every class using DISTRHO_LEAK_DETECTOR.\n
+    Only classes that have been instantiated at least once are listed.
+    Does nothing when leak detection is not enabled.
+*/
+static inline
+void d_printLeakDetectorStats() noexcept
+{
+#if DISTRHO_LEAK_DETECTOR_ENABLED
+    d_stdout("Object statistics (live / peak / total):");
 
-    static LeakCounter& getCounter() noexcept
+    for (const LeakedObjectCounter* counter = LeakedObjectCounter::getFirst(); counter != nullptr; counter = counter->getNext())
     {
-        static LeakCounter counter;
-        return counter;
+        d_stdout("  %-32s %8i %8i %10li", counter->getClassName(),
+                 counter->getNumObjects(), counter->getPeakObjects(), counter->getTotalObjects());
     }
-};
+#endif
+}
 
 // -----------------------------------------------------------------------
 
@@ -26,6 +26,11 @@
 
 #include <pthread.h>
 
+#ifndef DISTRHO_OS_WINDOWS
+# include <sys/time.h>
+# include <time.h>
+#endif
+
 START_NAMESPACE_DISTRHO
 
 class Signal;
@@ -195,6 +200,10 @@ public:
         pthread_condattr_t cattr;
         pthread_condattr_init(&cattr);
         pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_PRIVATE);
+#ifdef DISTRHO_OS_LINUX
+        // timed waits should not be affected by system clock changes
+        pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC);
+#endif
         pthread_cond_init(&fCondition, &cattr);
         pthread_condattr_destroy(&cattr);
 
@@ -234,6 +243,53 @@ public:
         pthread_mutex_unlock(&fMutex);
     }
 
+    /*
+     * Wait for a signal, at most 'timeOutMilliseconds'.
+     * A timeout of 0 only checks and clears the signal.
+     * Returns false if the wait timed out.
+     */
+    bool wait(const uint timeOutMilliseconds) noexcept
+    {
+        struct timespec deadline;
+
+        if (timeOutMilliseconds != 0)
+        {
+#ifdef DISTRHO_OS_LINUX
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+#else
+            struct timeval now;
+            gettimeofday(&now, nullptr);
+            deadline.tv_sec  = now.tv_sec;
+            deadline.tv_nsec = now.tv_usec * 1000;
+#endif
+            deadline.tv_sec  += static_cast<time_t>(timeOutMilliseconds / 1000);
+            deadline.tv_nsec += static_cast<long>(timeOutMilliseconds % 1000) * 1000000L;
+
+            if (deadline.tv_nsec >= 1000000000L)
+            {
+                deadline.tv_sec  += 1;
+                deadline.tv_nsec -= 1000000000L;
+            }
+        }
+
+        pthread_mutex_lock(&fMutex);
+
+        while (! fTriggered && timeOutMilliseconds != 0)
+        {
+            try {
+                if (pthread_cond_timedwait(&fCondition, &fMutex, &deadline) != 0)
+                    break;
+            } DISTRHO_SAFE_EXCEPTION_BREAK("pthread_cond_timedwait");
+        }
+
+        const bool triggered = fTriggered;
+        fTriggered = false;
+
+        pthread_mutex_unlock(&fMutex);
+
+        return triggered;
+    }
+
     /*
      * Wake up all waiting threads.
      */
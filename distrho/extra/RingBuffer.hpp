@@ -0,0 +1,271 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef DISTRHO_RING_BUFFER_HPP_INCLUDED
+#define DISTRHO_RING_BUFFER_HPP_INCLUDED
+
+#include "../DistrhoUtils.hpp"
+
+#ifndef DISTRHO_PROPER_CPP11_SUPPORT
+# error RingBuffer.hpp requires C++11 (std::atomic and alignas)
+#endif
+
+#include <atomic>
+
+START_NAMESPACE_DISTRHO
+
+// -----------------------------------------------------------------------
+
+/*
+ * Size used to keep data written by different threads on separate cache lines.
+ */
+static const std::size_t kCacheLineSize = 64;
+
+// -----------------------------------------------------------------------
+// SpscRingBuffer class
+
+/*
+ * Bounded wait-free queue for a single producer and a single consumer thread,
+ * e.g. sending parameter changes from the audio thread to the UI or the other way around.
+ * Neither side ever blocks or allocates, so both can be realtime threads.
+ * 'kCapacity' must be a power of 2.
+ */
+template<typename T, uint32_t kCapacity>
+class SpscRingBuffer
+{
+public:
+    /*
+     * Constructor.
+     */
+    SpscRingBuffer() noexcept
+        : fWriteIndex(0),
+          fCachedReadIndex(0),
+          fReadIndex(0),
+          fCachedWriteIndex(0),
+          fBuffer() {}
+
+    /*
+     * Add an item, called from the producer thread only.
+     * Returns false if the buffer is full.
+     */
+    bool tryPush(const T& item) noexcept
+    {
+        const uint32_t writeIndex = fWriteIndex.load(std::memory_order_relaxed);
+
+        if (writeIndex - fCachedReadIndex == kCapacity)
+        {
+            fCachedReadIndex = fReadIndex.load(std::memory_order_acquire);
+
+            if (writeIndex - fCachedReadIndex == kCapacity)
+                return false;
+        }
+
+        fBuffer[writeIndex & kMask] = item;
+        fWriteIndex.store(writeIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*
+     * Take the oldest item, called from the consumer thread only.
+     * Returns false if the buffer is empty.
+     */
+    bool tryPop(T& item) noexcept
+    {
+        const uint32_t readIndex = fReadIndex.load(std::memory_order_relaxed);
+
+        if (readIndex == fCachedWriteIndex)
+        {
+            fCachedWriteIndex = fWriteIndex.load(std::memory_order_acquire);
+
+            if (readIndex == fCachedWriteIndex)
+                return false;
+        }
+
+        item = fBuffer[readIndex & kMask];
+        fReadIndex.store(readIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*
+     * Check if there is nothing to read.
+     * Only exact when called from the consumer thread.
+     */
+    bool isEmpty() const noexcept
+    {
+        return fReadIndex.load(std::memory_order_acquire) == fWriteIndex.load(std::memory_order_acquire);
+    }
+
+    /*
+     * Number of items waiting to be read.
+     * Only a snapshot, as the other thread might be working on the buffer.
+     */
+    uint32_t getReadableCount() const noexcept
+    {
+        return fWriteIndex.load(std::memory_order_acquire) - fReadIndex.load(std::memory_order_acquire);
+    }
+
+    /*
+     * Maximum number of items the buffer can hold.
+     */
+    static uint32_t getCapacity() noexcept
+    {
+        return kCapacity;
+    }
+
+private:
+    static const uint32_t kMask = kCapacity - 1;
+
+    // written by the producer
+    alignas(kCacheLineSize) std::atomic<uint32_t> fWriteIndex;
+    uint32_t fCachedReadIndex;
+
+    // written by the consumer
+    alignas(kCacheLineSize) std::atomic<uint32_t> fReadIndex;
+    uint32_t fCachedWriteIndex;
+
+    alignas(kCacheLineSize) T fBuffer[kCapacity];
+
+    static_assert(kCapacity >= 2 && (kCapacity & kMask) == 0, "Capacity must be a power of 2");
+
+    DISTRHO_PREVENT_HEAP_ALLOCATION
+    DISTRHO_DECLARE_NON_COPY_CLASS(SpscRingBuffer)
+};
+
+// -----------------------------------------------------------------------
+// MpscRingBuffer class
+
+/*
+ * Bounded lock-free queue for many producer threads and a single consumer thread,
+ * e.g. several worker or UI threads reporting to the audio thread.
+ * Each slot carries a sequence number, so producers only compete on a single index
+ * and the consumer never waits for a producer that is still writing a later slot.
+ * 'kCapacity' must be a power of 2.
+ */
+template<typename T, uint32_t kCapacity>
+class MpscRingBuffer
+{
+public:
+    /*
+     * Constructor.
+     */
+    MpscRingBuffer() noexcept
+        : fWriteIndex(0),
+          fReadIndex(0),
+          fSlots()
+    {
+        for (uint32_t i=0; i < kCapacity; ++i)
+            fSlots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    /*
+     * Add an item, can be called from any thread.
+     * Returns false if the buffer is full.
+     */
+    bool tryPush(const T& item) noexcept
+    {
+        uint32_t writeIndex = fWriteIndex.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            Slot& slot(fSlots[writeIndex & kMask]);
+            const uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const int32_t diff = static_cast<int32_t>(sequence - writeIndex);
+
+            if (diff == 0)
+            {
+                // slot is free, try to claim it
+                if (fWriteIndex.compare_exchange_weak(writeIndex, writeIndex + 1, std::memory_order_relaxed))
+                {
+                    slot.item = item;
+                    slot.sequence.store(writeIndex + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                // slot not read yet, buffer is full
+                return false;
+            }
+            else
+            {
+                // another producer claimed this slot
+                writeIndex = fWriteIndex.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /*
+     * Take the oldest item, called from the consumer thread only.
+     * Returns false if the buffer is empty or the oldest item is still being written.
+     */
+    bool tryPop(T& item) noexcept
+    {
+        const uint32_t readIndex = fReadIndex.load(std::memory_order_relaxed);
+        Slot& slot(fSlots[readIndex & kMask]);
+
+        if (slot.sequence.load(std::memory_order_acquire) != readIndex + 1)
+            return false;
+
+        item = slot.item;
+        slot.sequence.store(readIndex + kCapacity, std::memory_order_release);
+        fReadIndex.store(readIndex + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /*
+     * Check if there is nothing to read, called from the consumer thread only.
+     */
+    bool isEmpty() const noexcept
+    {
+        const uint32_t readIndex = fReadIndex.load(std::memory_order_relaxed);
+        return fSlots[readIndex & kMask].sequence.load(std::memory_order_acquire) != readIndex + 1;
+    }
+
+    /*
+     * Maximum number of items the buffer can hold.
+     */
+    static uint32_t getCapacity() noexcept
+    {
+        return kCapacity;
+    }
+
+private:
+    static const uint32_t kMask = kCapacity - 1;
+
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        T item;
+
+        Slot() noexcept
+            : sequence(0),
+              item() {}
+    };
+
+    alignas(kCacheLineSize) std::atomic<uint32_t> fWriteIndex;
+    alignas(kCacheLineSize) std::atomic<uint32_t> fReadIndex;
+    alignas(kCacheLineSize) Slot fSlots[kCapacity];
+
+    static_assert(kCapacity >= 2 && (kCapacity & kMask) == 0, "Capacity must be a power of 2");
+
+    DISTRHO_PREVENT_HEAP_ALLOCATION
+    DISTRHO_DECLARE_NON_COPY_CLASS(MpscRingBuffer)
+};
+
+// -----------------------------------------------------------------------
+
+END_NAMESPACE_DISTRHO
+
+#endif // DISTRHO_RING_BUFFER_HPP_INCLUDED
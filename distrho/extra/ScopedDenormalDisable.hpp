@@ -0,0 +1,127 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef DISTRHO_SCOPED_DENORMAL_DISABLE_HPP_INCLUDED
+#define DISTRHO_SCOPED_DENORMAL_DISABLE_HPP_INCLUDED
+
+#include "../DistrhoUtils.hpp"
+
+#if defined(__SSE__) || defined(__x86_64__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+# include <xmmintrin.h>
+# define DISTRHO_DENORMALS_SSE 1
+#elif defined(__aarch64__)
+# define DISTRHO_DENORMALS_AARCH64 1
+#elif defined(__arm__) && defined(__VFP_FP__) && ! defined(__SOFTFP__)
+# define DISTRHO_DENORMALS_ARM 1
+#endif
+
+START_NAMESPACE_DISTRHO
+
+// -----------------------------------------------------------------------
+// ScopedDenormalDisable class
+
+/*
+ * Flush denormals to zero for the lifetime of this object, restoring the previous state afterwards.
+ * Filter and reverb tails decaying into the denormal range otherwise make the CPU load spike.
+ * This sets FTZ and DAZ in MXCSR on x86 and the FZ bit in FPCR/FPSCR on ARM (which covers NEON too),
+ * the registers are per thread so this only affects the calling thread.
+ * Does nothing on other architectures.
+ */
+class ScopedDenormalDisable
+{
+public:
+    ScopedDenormalDisable() noexcept
+        : fPreviousState(getState())
+    {
+        const uintptr_t newState = fPreviousState | kFlushBits;
+
+        // writing the control register stalls the pipeline, skip it when the host set these already
+        if (newState != fPreviousState)
+            setState(newState);
+    }
+
+    ~ScopedDenormalDisable() noexcept
+    {
+        if ((fPreviousState | kFlushBits) != fPreviousState)
+            setState(fPreviousState);
+    }
+
+private:
+    const uintptr_t fPreviousState;
+
+#if defined(DISTRHO_DENORMALS_SSE)
+    // FTZ (bit 15) and DAZ (bit 6)
+    static const uintptr_t kFlushBits = 0x8040;
+
+    static uintptr_t getState() noexcept
+    {
+        return _mm_getcsr();
+    }
+
+    static void setState(const uintptr_t state) noexcept
+    {
+        _mm_setcsr(static_cast<uint>(state));
+    }
+#elif defined(DISTRHO_DENORMALS_AARCH64)
+    // FZ (bit 24)
+    static const uintptr_t kFlushBits = 1 << 24;
+
+    static uintptr_t getState() noexcept
+    {
+        uintptr_t state;
+        asm volatile("mrs %0, fpcr" : "=r" (state));
+        return state;
+    }
+
+    static void setState(const uintptr_t state) noexcept
+    {
+        asm volatile("msr fpcr, %0" : : "r" (state));
+    }
+#elif defined(DISTRHO_DENORMALS_ARM)
+    // FZ (bit 24)
+    static const uintptr_t kFlushBits = 1 << 24;
+
+    static uintptr_t getState() noexcept
+    {
+        uintptr_t state;
+        asm volatile("vmrs %0, fpscr" : "=r" (state));
+        return state;
+    }
+
+    static void setState(const uintptr_t state) noexcept
+    {
+        asm volatile("vmsr fpscr, %0" : : "r" (state));
+    }
+#else
+    static const uintptr_t kFlushBits = 0;
+
+    static uintptr_t getState() noexcept
+    {
+        return 0;
+    }
+
+    static void setState(const uintptr_t) noexcept {}
+#endif
+
+    DISTRHO_DECLARE_NON_COPY_CLASS(ScopedDenormalDisable)
+    DISTRHO_PREVENT_HEAP_ALLOCATION
+};
+
+// -----------------------------------------------------------------------
+
+END_NAMESPACE_DISTRHO
+
+#endif // DISTRHO_SCOPED_DENORMAL_DISABLE_HPP_INCLUDED
@@ -1,6 +1,6 @@
 /*
  * DISTRHO Plugin Framework (DPF)
- * Copyright (C) 2012-2016 Filipe Coelho <falktx@falktx.com>
+ * Copyright (C) 2012-2018 Filipe Coelho <falktx@falktx.com>
  *
  * Permission to use, copy, modify, and/or distribute this software for any purpose with
  * or without fee is hereby granted, provided that the above copyright notice and this
@@ -36,49 +36,58 @@ public:
      * Empty string.
      */
     explicit String() noexcept
-        : fBuffer(_null()),
-          fBufferLen(0) {}
+        : fBuffer(fSmallBuffer),
+          fBufferLen(0),
+          fBufferAlloc(0)
+    {
+        fSmallBuffer[0] = '\0';
+    }
 
     /*
      * Simple character.
      */
     explicit String(const char c) noexcept
-        : fBuffer(_null()),
-          fBufferLen(0)
+        : fBuffer(fSmallBuffer),
+          fBufferLen(0),
+          fBufferAlloc(0)
     {
-        char ch[2];
-        ch[0] = c;
-        ch[1] = '\0';
-
-        _dup(ch);
+        fSmallBuffer[0] = c;
+        fSmallBuffer[1] = '\0';
+        fBufferLen = (c != '\0') ? 1 : 0;
     }
 
     /*
      * Simple char string.
      */
     explicit String(char* const strBuf, const bool copyData = true) noexcept
-        : fBuffer(_null()),
-          fBufferLen(0)
+        : fBuffer(fSmallBuffer),
+          fBufferLen(0),
+          fBufferAlloc(0)
     {
+        fSmallBuffer[0] = '\0';
+
         if (copyData || strBuf == nullptr)
         {
             _dup(strBuf);
         }
         else
         {
-            fBuffer    = strBuf;
-            fBufferLen = std::strlen(strBuf);
+            // take ownership of an allocated buffer
+            fBuffer      = strBuf;
+            fBufferLen   = std::strlen(strBuf);
+            fBufferAlloc = fBufferLen+1;
         }
-
     }
 
     /*
      * Simple const char string.
      */
     explicit String(const char* const strBuf) noexcept
-        : fBuffer(_null()),
-          fBufferLen(0)
+        : fBuffer(fSmallBuffer),
+          fBufferLen(0),
+          fBufferAlloc(0)
     {
+        fSmallBuffer[0] = '\0';
         _dup(strBuf);
     }
 
@@ -86,9 +95,12 @@ public:
      * Integer.
      */
     explicit String(const int value) noexcept
-        : fBuffer(_null()),
-          fBufferLen(0)
+        : fBuffer(fSmallBuffer),
+          fBufferLen(0),
+          fBufferAlloc(0)
     {
+        fSmallBuffer[0] = '\0';
+
         char strBuf[0xff+1];
         std::snprintf(strBuf, 0xff, "%d", value);
         strBuf[0xff] = '\0';
@@ -100,9 +112,12 @@ public:
      * Unsigned integer, possibly in hexadecimal.
      */
     explicit String(const unsigned int value, const bool hexadecimal = false) noexcept
-        : fBuffer(_null()),
-          fBufferLen(0)
+        : fBuffer(fSmallBuffer),
+          fBufferLen(0),
+          fBufferAlloc(0)
     {
+        fSmallBuffer[0] = '\0';
+
         char strBuf[0xff+1];
         std::snprintf(strBuf, 0xff, hexadecimal ? "0x%x" : "%u", value);
         strBuf[0xff] = '\0';
@@ -114,9 +129,12 @@ public:
      * Long integer.
      */
     explicit String(const long value) noexcept
-        : fBuffer(_null()),
-          fBufferLen(0)
+        : fBuffer(fSmallBuffer),
+          fBufferLen(0),
+          fBufferAlloc(0)
     {
+        fSmallBuffer[0] = '\0';
+
         char strBuf[0xff+1];
         std::snprintf(strBuf, 0xff, "%ld", value);
         strBuf[0xff] = '\0';
@@ -128,9 +146,12 @@ public:
      * Long unsigned integer, possibly hexadecimal.
      */
     explicit String(const unsigned long value, const bool hexadecimal = false) noexcept
-        : fBuffer(_null()),
-          fBufferLen(0)
+        : fBuffer(fSmallBuffer),
+          fBufferLen(0),
+          fBufferAlloc(0)
     {
+        fSmallBuffer[0] = '\0';
+
         char strBuf[0xff+1];
         std::snprintf(strBuf, 0xff, hexadecimal ? "0x%lx" : "%lu", value);
         strBuf[0xff] = '\0';
@@ -142,9 +163,12 @@ public:
      * Long long integer.
      */
     explicit String(const long long value) noexcept
-        : fBuffer(_null()),
-          fBufferLen(0)
+        : fBuffer(fSmallBuffer),
+          fBufferLen(0),
+          fBufferAlloc(0)
     {
+        fSmallBuffer[0] = '\0';
+
         char strBuf[0xff+1];
         std::snprintf(strBuf, 0xff, "%lld", value);
         strBuf[0xff] = '\0';
@@ -156,9 +180,12 @@ public:
      * Long long unsigned integer, possibly hexadecimal.
      */
     explicit String(const unsigned long long value, const bool hexadecimal = false) noexcept
-        : fBuffer(_null()),
-          fBufferLen(0)
+        : fBuffer(fSmallBuffer),
+          fBufferLen(0),
+          fBufferAlloc(0)
     {
+        fSmallBuffer[0] = '\0';
+
         char strBuf[0xff+1];
         std::snprintf(strBuf, 0xff, hexadecimal ? "0x%llx" : "%llu", value);
         strBuf[0xff] = '\0';
@@ -168,30 +195,36 @@ public:
 
     /*
      * Single-precision floating point number.
+     * Uses the shortest representation that converts back to the same value, independent of locale.
      */
     explicit String(const float value) noexcept
-        : fBuffer(_null()),
-          fBufferLen(0)
+        : fBuffer(fSmallBuffer),
+          fBufferLen(0),
+          fBufferAlloc(0)
     {
-        char strBuf[0xff+1];
-        std::snprintf(strBuf, 0xff, "%f", value);
-        strBuf[0xff] = '\0';
+        fSmallBuffer[0] = '\0';
 
-        _dup(strBuf);
+        char strBuf[32];
+        const std::size_t strBufLen = d_float2str(strBuf, value);
+
+        _dup(strBuf, strBufLen);
     }
 
     /*
      * Double-precision floating point number.
+     * Uses the shortest representation that converts back to the same value, independent of locale.
      */
     explicit String(const double value) noexcept
-        : fBuffer(_null()),
-          fBufferLen(0)
+        : fBuffer(fSmallBuffer),
+          fBufferLen(0),
+          fBufferAlloc(0)
     {
-        char strBuf[0xff+1];
-        std::snprintf(strBuf, 0xff, "%g", value);
-        strBuf[0xff] = '\0';
+        fSmallBuffer[0] = '\0';
 
-        _dup(strBuf);
+        char strBuf[32];
+        const std::size_t strBufLen = d_double2str(strBuf, value);
+
+        _dup(strBuf, strBufLen);
     }
 
     // -------------------------------------------------------------------
@@ -201,12 +234,29 @@ public:
      * Create string from another string.
      */
     String(const String& str) noexcept
-        : fBuffer(_null()),
-          fBufferLen(0)
+        : fBuffer(fSmallBuffer),
+          fBufferLen(0),
+          fBufferAlloc(0)
     {
-        _dup(str.fBuffer);
+        fSmallBuffer[0] = '\0';
+        _dup(str.fBuffer, str.fBufferLen);
     }
 
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+    /*
+     * Move string from another string.
+     * Heap buffers are taken over, short strings are copied.
+     */
+    String(String&& str) noexcept
+        : fBuffer(fSmallBuffer),
+          fBufferLen(0),
+          fBufferAlloc(0)
+    {
+        fSmallBuffer[0] = '\0';
+        _move(str);
+    }
+#endif
+
     // -------------------------------------------------------------------
     // destructor
 
@@ -217,13 +267,14 @@ public:
     {
         DISTRHO_SAFE_ASSERT_RETURN(fBuffer != nullptr,);
 
-        if (fBuffer == _null())
+        if (fBuffer == fSmallBuffer)
             return;
 
         std::free(fBuffer);
 
-        fBuffer    = nullptr;
-        fBufferLen = 0;
+        fBuffer       = nullptr;
+        fBufferLen    = 0;
+        fBufferAlloc  = 0;
     }
 
     // -------------------------------------------------------------------
@@ -253,6 +304,23 @@ public:
         return (fBufferLen != 0);
     }
 
+    /*
+     * Get the number of characters the string can hold without reallocating.
+     */
+    std::size_t capacity() const noexcept
+    {
+        return (fBuffer == fSmallBuffer ? kSmallBufferSize : fBufferAlloc) - 1;
+    }
+
+    /*
+     * Make sure the string can hold at least 'size' characters without reallocating.
+     * Returns false if memory allocation failed.
+     */
+    bool reserve(const std::size_t size) noexcept
+    {
+        return _reserve(size, false);
+    }
+
     /*
      * Check if the string contains another string, optionally ignoring case.
      */
@@ -268,7 +336,7 @@ public:
             String tmp1(fBuffer), tmp2(strBuf);
 
             // memory allocation failed or empty string(s)
-            if (tmp1.fBuffer == _null() || tmp2.fBuffer == _null())
+            if (tmp1.isEmpty() || tmp2.isEmpty())
                 return false;
 
             tmp1.toLower();
@@ -579,18 +647,15 @@ public:
             "abcdefghijklmnopqrstuvwxyz"
             "0123456789+/";
 
-        const std::size_t kTmpBufSize = std::min(d_nextPowerOf2(dataSize/3), 65536U);
-
         const uchar* bytesToEncode((const uchar*)data);
 
         uint i=0, j=0;
         uint charArray3[3], charArray4[4];
 
-        char strBuf[kTmpBufSize+1];
-        strBuf[kTmpBufSize] = '\0';
-        std::size_t strBufIndex = 0;
+        char strBuf[4];
 
         String ret;
+        ret.reserve((dataSize + 2) / 3 * 4);
 
         for (std::size_t s=0; s<dataSize; ++s)
         {
@@ -604,14 +669,9 @@ public:
                 charArray4[3] =   charArray3[2] & 0x3f;
 
                 for (i=0; i<4; ++i)
-                    strBuf[strBufIndex++] = kBase64Chars[charArray4[i]];
+                    strBuf[i] = kBase64Chars[charArray4[i]];
 
-                if (strBufIndex >= kTmpBufSize-7)
-                {
-                    strBuf[strBufIndex] = '\0';
-                    strBufIndex = 0;
-                    ret += strBuf;
-                }
+                ret._append(strBuf, 4);
 
                 i = 0;
             }
@@ -628,16 +688,12 @@ public:
             charArray4[3] =   charArray3[2] & 0x3f;
 
             for (j=0; j<4 && i<3 && j<i+1; ++j)
-                strBuf[strBufIndex++] = kBase64Chars[charArray4[j]];
+                strBuf[j] = kBase64Chars[charArray4[j]];
 
             for (; i++ < 3;)
-                strBuf[strBufIndex++] = '=';
-        }
+                strBuf[j++] = '=';
 
-        if (strBufIndex != 0)
-        {
-            strBuf[strBufIndex] = '\0';
-            ret += strBuf;
+            ret._append(strBuf, 4);
         }
 
         return ret;
@@ -704,43 +760,57 @@ public:
 
     String& operator=(const String& str) noexcept
     {
-        _dup(str.fBuffer);
+        _dup(str.fBuffer, str.fBufferLen);
+
+        return *this;
+    }
+
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+    String& operator=(String&& str) noexcept
+    {
+        if (this != &str)
+            _move(str);
 
         return *this;
     }
+#endif
 
     String& operator+=(const char* const strBuf) noexcept
     {
         if (strBuf == nullptr)
             return *this;
 
-        const std::size_t newBufSize = fBufferLen + std::strlen(strBuf) + 1;
-        char              newBuf[newBufSize];
-
-        std::strcpy(newBuf, fBuffer);
-        std::strcat(newBuf, strBuf);
-
-        _dup(newBuf, newBufSize-1);
+        _append(strBuf, std::strlen(strBuf));
 
         return *this;
     }
 
     String& operator+=(const String& str) noexcept
     {
-        return operator+=(str.fBuffer);
+        _append(str.fBuffer, str.fBufferLen);
+
+        return *this;
     }
 
-    String operator+(const char* const strBuf) noexcept
+    String& operator+=(const char c) noexcept
     {
-        const std::size_t newBufSize = fBufferLen + ((strBuf != nullptr) ? std::strlen(strBuf) : 0) + 1;
-        char              newBuf[newBufSize];
+        if (c == '\0')
+            return *this;
 
-        std::strcpy(newBuf, fBuffer);
+        _append(&c, 1);
 
-        if (strBuf != nullptr)
-            std::strcat(newBuf, strBuf);
+        return *this;
+    }
+
+    String operator+(const char* const strBuf) noexcept
+    {
+        const std::size_t strBufLen = (strBuf != nullptr) ? std::strlen(strBuf) : 0;
 
-        return String(newBuf);
+        String ret;
+        ret.reserve(fBufferLen + strBufLen);
+        ret._append(fBuffer, fBufferLen);
+        ret._append(strBuf, strBufLen);
+        return ret;
     }
 
     String operator+(const String& str) noexcept
@@ -751,25 +821,56 @@ public:
     // -------------------------------------------------------------------
 
 private:
-    char*       fBuffer;    // the actual string buffer
-    std::size_t fBufferLen; // string length
+    // strings up to this size (including the null terminator) are stored inline, without allocation
+    static const std::size_t kSmallBufferSize = 24;
+
+    char*       fBuffer;      // the actual string buffer, points to fSmallBuffer for short strings
+    std::size_t fBufferLen;   // string length
+    std::size_t fBufferAlloc; // allocated size of the heap buffer, 0 when using fSmallBuffer
+    char        fSmallBuffer[kSmallBufferSize];
 
     /*
-     * Static null string.
-     * Prevents allocation for new and/or empty strings.
+     * Helper function.
+     * Makes sure the buffer can hold 'size' characters plus the null terminator, keeping the current contents.
+     * When 'grow' is true the buffer size is at least doubled, so that repeated appends stay linear.
      */
-    static char* _null() noexcept
+    bool _reserve(const std::size_t size, const bool grow) noexcept
     {
-        static char sNull = '\0';
-        return &sNull;
+        const std::size_t curAlloc = (fBuffer == fSmallBuffer) ? kSmallBufferSize : fBufferAlloc;
+
+        if (size < curAlloc)
+            return true;
+
+        std::size_t newAlloc = size+1;
+
+        if (grow && newAlloc < curAlloc*2)
+            newAlloc = curAlloc*2;
+
+        char* newBuf;
+
+        if (fBuffer == fSmallBuffer)
+        {
+            newBuf = (char*)std::malloc(newAlloc);
+            DISTRHO_SAFE_ASSERT_RETURN(newBuf != nullptr, false);
+            std::memcpy(newBuf, fSmallBuffer, fBufferLen+1);
+        }
+        else
+        {
+            newBuf = (char*)std::realloc(fBuffer, newAlloc);
+            DISTRHO_SAFE_ASSERT_RETURN(newBuf != nullptr, false);
+        }
+
+        fBuffer      = newBuf;
+        fBufferAlloc = newAlloc;
+        return true;
     }
 
     /*
      * Helper function.
-     * Called whenever the string needs to be allocated.
+     * Called whenever the string contents are replaced.
      *
      * Notes:
-     * - Allocates string only if 'strBuf' is not null and new string contents are different
+     * - Reuses the current buffer if big enough, allocates only for strings that do not fit inline
      * - If 'strBuf' is null, 'size' must be 0
      */
     void _dup(const char* const strBuf, const std::size_t size = 0) noexcept
@@ -777,40 +878,100 @@ private:
         if (strBuf != nullptr)
         {
             // don't recreate string if contents match
-            if (std::strcmp(fBuffer, strBuf) == 0)
+            if (strBuf == fBuffer)
                 return;
 
-            if (fBuffer != _null())
-                std::free(fBuffer);
-
-            fBufferLen = (size > 0) ? size : std::strlen(strBuf);
-            fBuffer    = (char*)std::malloc(fBufferLen+1);
+            const std::size_t strBufLen = (size > 0) ? size : std::strlen(strBuf);
 
-            if (fBuffer == nullptr)
+            if (strBufLen >= ((fBuffer == fSmallBuffer) ? kSmallBufferSize : fBufferAlloc))
             {
-                fBuffer    = _null();
-                fBufferLen = 0;
-                return;
+                // old contents are not needed, start from an empty buffer
+                _clear();
+
+                if (! _reserve(strBufLen, false))
+                    return;
             }
 
-            std::strcpy(fBuffer, strBuf);
+            std::memmove(fBuffer, strBuf, strBufLen);
 
+            fBufferLen = strBufLen;
             fBuffer[fBufferLen] = '\0';
         }
         else
         {
             DISTRHO_SAFE_ASSERT(size == 0);
 
-            // don't recreate null string
-            if (fBuffer == _null())
-                return;
+            _clear();
+        }
+    }
+
+    /*
+     * Helper function.
+     * Appends 'size' characters from 'strBuf', growing the buffer geometrically.
+     */
+    void _append(const char* strBuf, const std::size_t size) noexcept
+    {
+        if (strBuf == nullptr || size == 0)
+            return;
+
+        // appending to itself, buffer might move
+        const bool isSelf = (strBuf >= fBuffer && strBuf <= fBuffer + fBufferLen);
+        const std::size_t selfOffset = isSelf ? static_cast<std::size_t>(strBuf - fBuffer) : 0;
+
+        if (! _reserve(fBufferLen + size, true))
+            return;
+
+        if (isSelf)
+            strBuf = fBuffer + selfOffset;
+
+        std::memmove(fBuffer + fBufferLen, strBuf, size);
 
+        fBufferLen += size;
+        fBuffer[fBufferLen] = '\0';
+    }
+
+    /*
+     * Helper function.
+     * Frees any heap buffer and goes back to the empty inline one.
+     */
+    void _clear() noexcept
+    {
+        if (fBuffer != fSmallBuffer)
+        {
             DISTRHO_SAFE_ASSERT(fBuffer != nullptr);
             std::free(fBuffer);
+        }
+
+        fBuffer         = fSmallBuffer;
+        fBufferLen      = 0;
+        fBufferAlloc    = 0;
+        fSmallBuffer[0] = '\0';
+    }
 
-            fBuffer    = _null();
-            fBufferLen = 0;
+    /*
+     * Helper function.
+     * Takes the contents of 'str', leaving it empty.
+     */
+    void _move(String& str) noexcept
+    {
+        if (str.fBuffer == str.fSmallBuffer)
+        {
+            _dup(str.fBuffer, str.fBufferLen);
         }
+        else
+        {
+            _clear();
+
+            fBuffer      = str.fBuffer;
+            fBufferLen   = str.fBufferLen;
+            fBufferAlloc = str.fBufferAlloc;
+
+            str.fBuffer      = str.fSmallBuffer;
+            str.fBufferAlloc = 0;
+        }
+
+        str.fBufferLen = 0;
+        str.fSmallBuffer[0] = '\0';
     }
 
     DISTRHO_PREVENT_HEAP_ALLOCATION
@@ -821,28 +982,151 @@ private:
 static inline
 String operator+(const String& strBefore, const char* const strBufAfter) noexcept
 {
-    const char* const strBufBefore = strBefore.buffer();
-    const std::size_t newBufSize   = strBefore.length() + ((strBufAfter != nullptr) ? std::strlen(strBufAfter) : 0) + 1;
-    char newBuf[newBufSize];
-
-    std::strcpy(newBuf, strBufBefore);
-    std::strcat(newBuf, strBufAfter);
-
-    return String(newBuf);
+    String ret;
+    ret.reserve(strBefore.length() + ((strBufAfter != nullptr) ? std::strlen(strBufAfter) : 0));
+    ret += strBefore;
+    ret += strBufAfter;
+    return ret;
 }
 
 static inline
 String operator+(const char* const strBufBefore, const String& strAfter) noexcept
 {
-    const char* const strBufAfter = strAfter.buffer();
-    const std::size_t newBufSize  = ((strBufBefore != nullptr) ? std::strlen(strBufBefore) : 0) + strAfter.length() + 1;
-    char newBuf[newBufSize];
+    String ret;
+    ret.reserve(((strBufBefore != nullptr) ? std::strlen(strBufBefore) : 0) + strAfter.length());
+    ret += strBufBefore;
+    ret += strAfter;
+    return ret;
+}
 
-    std::strcpy(newBuf, strBufBefore);
-    std::strcat(newBuf, strBufAfter);
+// -----------------------------------------------------------------------
+// StringBuilder class
 
-    return String(newBuf);
-}
+/*
+ * Helper for building long strings out of many small pieces.
+ * Appending reuses a single growing buffer, the final string is handed over without a copy.
+ */
+class StringBuilder
+{
+public:
+    /*
+     * Constructor, optionally reserving space for 'size' characters.
+     */
+    explicit StringBuilder(const std::size_t size = 0) noexcept
+        : fString()
+    {
+        if (size != 0)
+            fString.reserve(size);
+    }
+
+    /*
+     * Get length of the string built so far.
+     */
+    std::size_t length() const noexcept
+    {
+        return fString.length();
+    }
+
+    /*
+     * Make sure the builder can hold at least 'size' characters without reallocating.
+     */
+    bool reserve(const std::size_t size) noexcept
+    {
+        return fString.reserve(size);
+    }
+
+    /*
+     * Clear the string built so far, keeping the allocated memory.
+     */
+    void clear() noexcept
+    {
+        fString.clear();
+    }
+
+    /*
+     * Direct access to the string built so far (read-only).
+     */
+    const String& toString() const noexcept
+    {
+        return fString;
+    }
+
+    /*
+     * Take the built string, leaving the builder empty.
+     */
+    String release() noexcept
+    {
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+        return String(static_cast<String&&>(fString));
+#else
+        String ret(fString);
+        fString.clear();
+        return ret;
+#endif
+    }
+
+    StringBuilder& operator<<(const char* const strBuf) noexcept
+    {
+        fString += strBuf;
+        return *this;
+    }
+
+    StringBuilder& operator<<(const String& str) noexcept
+    {
+        fString += str;
+        return *this;
+    }
+
+    StringBuilder& operator<<(const char c) noexcept
+    {
+        fString += c;
+        return *this;
+    }
+
+    StringBuilder& operator<<(const int value) noexcept
+    {
+        char strBuf[0xff+1];
+        std::snprintf(strBuf, 0xff, "%d", value);
+        strBuf[0xff] = '\0';
+
+        fString += strBuf;
+        return *this;
+    }
+
+    StringBuilder& operator<<(const uint value) noexcept
+    {
+        char strBuf[0xff+1];
+        std::snprintf(strBuf, 0xff, "%u", value);
+        strBuf[0xff] = '\0';
+
+        fString += strBuf;
+        return *this;
+    }
+
+    StringBuilder& operator<<(const float value) noexcept
+    {
+        char strBuf[32];
+        d_float2str(strBuf, value);
+
+        fString += strBuf;
+        return *this;
+    }
+
+    StringBuilder& operator<<(const double value) noexcept
+    {
+        char strBuf[32];
+        d_double2str(strBuf, value);
+
+        fString += strBuf;
+        return *this;
+    }
+
+private:
+    String fString;
+
+    DISTRHO_DECLARE_NON_COPY_CLASS(StringBuilder)
+    DISTRHO_PREVENT_HEAP_ALLOCATION
+};
 
 // -----------------------------------------------------------------------
 
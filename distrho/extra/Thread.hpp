@@ -21,6 +21,18 @@
 #include "Sleep.hpp"
 #include "String.hpp"
 
+#include <algorithm>
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+# include <atomic>
+#endif
+#include <cerrno>
+#include <climits>
+
+#ifndef DISTRHO_OS_WINDOWS
+# include <sched.h>
+# include <sys/mman.h>
+#endif
+
 #ifdef DISTRHO_OS_LINUX
 # include <sys/prctl.h>
 #endif
@@ -39,13 +51,21 @@ protected:
     Thread(const char* const threadName = nullptr) noexcept
         : fLock(),
           fSignal(),
+          fExitSignal(),
+          fShouldExitSignal(),
           fName(threadName),
 #ifdef PTW32_DLLPORT
           fHandle({nullptr, 0}),
 #else
           fHandle(0),
 #endif
-          fShouldExit(false) {}
+          fIsRunning(false),
+          fShouldExit(false),
+          fStarted(false),
+          fPriority(-1),
+          fAffinityMask(0),
+          fStackSize(0),
+          fLockStack(false) {}
 
     /*
      * Destructor.
@@ -70,11 +90,7 @@ public:
      */
     bool isThreadRunning() const noexcept
     {
-#ifdef PTW32_DLLPORT
-        return (fHandle.p != nullptr);
-#else
-        return (fHandle != 0);
-#endif
+        return _loadFlag(fIsRunning);
     }
 
     /*
@@ -82,7 +98,7 @@ public:
      */
     bool shouldThreadExit() const noexcept
     {
-        return fShouldExit;
+        return _loadFlag(fShouldExit);
     }
 
     /*
@@ -95,11 +111,54 @@ public:
 
         const MutexLocker ml(fLock);
 
-        fShouldExit = false;
+        // a previous run that returned on its own might still be about to send its exit signal
+        if (fStarted)
+        {
+            fExitSignal.wait();
+            fStarted = false;
+        }
+
+        _storeFlag(fShouldExit, false);
+        fShouldExitSignal.wait(0);
 
         pthread_t handle;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+
+        if (fStackSize != 0)
+            pthread_attr_setstacksize(&attr, std::max(fStackSize, static_cast<std::size_t>(PTHREAD_STACK_MIN)));
+
+#ifndef DISTRHO_OS_WINDOWS
+        if (fPriority >= 0)
+        {
+            const int policy = fPriority > 0 ? SCHED_FIFO : SCHED_OTHER;
+
+            struct sched_param param;
+            param.sched_priority = fPriority > 0 ? std::max(sched_get_priority_min(SCHED_FIFO),
+                                                            std::min(fPriority, sched_get_priority_max(SCHED_FIFO))) : 0;
 
-        if (pthread_create(&handle, nullptr, _entryPoint, this) == 0)
+            pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+            pthread_attr_setschedpolicy(&attr, policy);
+            pthread_attr_setschedparam(&attr, &param);
+        }
+#endif
+
+        int ret = pthread_create(&handle, &attr, _entryPoint, this);
+
+#ifndef DISTRHO_OS_WINDOWS
+        if (ret == EPERM && fPriority > 0)
+        {
+            // no rtprio granted, run with the creator's scheduling instead
+            d_stderr("Thread '%s': realtime priority not permitted, using normal scheduling", fName.buffer());
+
+            pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+            ret = pthread_create(&handle, &attr, _entryPoint, this);
+        }
+#endif
+
+        pthread_attr_destroy(&attr);
+
+        if (ret == 0)
         {
 #ifdef PTW32_DLLPORT
             DISTRHO_SAFE_ASSERT_RETURN(handle.p != nullptr, false);
@@ -107,9 +166,9 @@ public:
             DISTRHO_SAFE_ASSERT_RETURN(handle != 0, false);
 #endif
             pthread_detach(handle);
-            _copyFrom(handle);
+            fStarted = true;
 
-            // wait for thread to start
+            // wait for thread to start, the handle is set by the thread itself
             fSignal.wait();
             return true;
         }
@@ -128,45 +187,50 @@ public:
     {
         const MutexLocker ml(fLock);
 
-        if (isThreadRunning())
-        {
-            signalThreadShouldExit();
+        if (! fStarted)
+            return true;
 
-            if (timeOutMilliseconds != 0)
-            {
-                // Wait for the thread to stop
-                int timeOutCheck = (timeOutMilliseconds == 1 || timeOutMilliseconds == -1) ? timeOutMilliseconds : timeOutMilliseconds/2;
+        signalThreadShouldExit();
+
+        // wait for the thread to report it has stopped
+        bool stopped;
 
-                for (; isThreadRunning();)
-                {
-                    d_msleep(2);
+        if (timeOutMilliseconds < 0)
+        {
+            fExitSignal.wait();
+            stopped = true;
+        }
+        else
+        {
+            stopped = fExitSignal.wait(static_cast<uint>(timeOutMilliseconds));
+        }
 
-                    if (timeOutCheck < 0)
-                        continue;
+        // run() already returned, the thread is about to send the exit signal
+        // and must be done touching this object before we return
+        if (! stopped && ! isThreadRunning())
+        {
+            fExitSignal.wait();
+            stopped = true;
+        }
 
-                    if (timeOutCheck > 0)
-                        timeOutCheck -= 1;
-                    else
-                        break;
-                }
-            }
+        fStarted = false;
 
-            if (isThreadRunning())
-            {
-                // should never happen!
-                d_stderr2("assertion failure: \"! isThreadRunning()\" in file %s, line %i", __FILE__, __LINE__);
+        if (! stopped)
+        {
+            // should never happen!
+            d_stderr2("assertion failure: \"! isThreadRunning()\" in file %s, line %i", __FILE__, __LINE__);
 
-                // copy thread id so we can clear our one
-                pthread_t threadId;
-                _copyTo(threadId);
-                _init();
+            // copy thread id so we can clear our one
+            pthread_t threadId;
+            _copyTo(threadId);
+            _init();
+            _storeFlag(fIsRunning, false);
 
-                try {
-                    pthread_cancel(threadId);
-                } DISTRHO_SAFE_EXCEPTION("pthread_cancel");
+            try {
+                pthread_cancel(threadId);
+            } DISTRHO_SAFE_EXCEPTION("pthread_cancel");
 
-                return false;
-            }
+            return false;
         }
 
         return true;
@@ -177,7 +241,72 @@ public:
      */
     void signalThreadShouldExit() noexcept
     {
-        fShouldExit = true;
+        _storeFlag(fShouldExit, true);
+        fShouldExitSignal.signal();
+    }
+
+    /*
+     * Sleep for up to 'timeOutMilliseconds', waking up early if the thread is told to stop.
+     * Meant to be used inside run() instead of d_msleep, so stopping the thread does not wait for the sleep.
+     * Returns true if the thread should exit.
+     */
+    bool waitForThreadShouldExit(const uint timeOutMilliseconds) noexcept
+    {
+        if (shouldThreadExit())
+            return true;
+
+        fShouldExitSignal.wait(timeOutMilliseconds);
+        return shouldThreadExit();
+    }
+
+    // -------------------------------------------------------------------
+    // Scheduling options, these are used the next time the thread starts.
+
+    /*
+     * Set the scheduling priority.
+     * < 0 -> same scheduling as the thread calling startThread (default)
+     * = 0 -> normal scheduling (SCHED_OTHER)
+     * > 0 -> realtime scheduling (SCHED_FIFO) with this priority, falls back to normal if not permitted
+     * Ignored on Windows.
+     */
+    void setThreadPriority(const int priority) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(! isThreadRunning(),);
+
+        fPriority = priority;
+    }
+
+    /*
+     * Set the CPUs the thread may run on, as a bitmask of CPU indexes (0 for any).
+     * Only used on Linux.
+     */
+    void setThreadAffinity(const uint64_t cpuMask) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(! isThreadRunning(),);
+
+        fAffinityMask = cpuMask;
+    }
+
+    /*
+     * Set the stack size in bytes (0 for the system default).
+     */
+    void setThreadStackSize(const std::size_t stackSize) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(! isThreadRunning(),);
+
+        fStackSize = stackSize;
+    }
+
+    /*
+     * Lock the whole thread stack in memory so it never page-faults, see mlock().
+     * Best combined with a small stack size, as the default one can be several megabytes.
+     * Ignored on Windows.
+     */
+    void setThreadLockStack(const bool lockStack) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(! isThreadRunning(),);
+
+        fLockStack = lockStack;
     }
 
     // -------------------------------------------------------------------
@@ -203,17 +332,56 @@ public:
 #endif
 #if defined(__GLIBC__) && (__GLIBC__ * 1000 + __GLIBC_MINOR__) >= 2012
         pthread_setname_np(pthread_self(), name);
+#elif defined(DISTRHO_OS_MAC)
+        pthread_setname_np(name);
 #endif
     }
 
     // -------------------------------------------------------------------
 
 private:
-    Mutex              fLock;       // Thread lock
-    Signal             fSignal;     // Thread start wait signal
-    const String       fName;       // Thread name
-    volatile pthread_t fHandle;     // Handle for this thread
-    volatile bool      fShouldExit; // true if thread should exit
+    Mutex              fLock;             // Thread lock
+    Signal             fSignal;           // Thread start wait signal
+    Signal             fExitSignal;       // Thread exit wait signal
+    Signal             fShouldExitSignal; // Wakes up waitForThreadShouldExit
+    const String       fName;             // Thread name
+    volatile pthread_t fHandle;           // Handle for this thread
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+    typedef std::atomic<bool> AtomicFlag;
+#else
+    typedef volatile bool AtomicFlag;
+#endif
+    AtomicFlag         fIsRunning;        // true while the thread is inside run()
+    AtomicFlag         fShouldExit;       // true if thread should exit
+    bool               fStarted;          // true until the exit signal of the last run was collected
+    int                fPriority;         // Scheduling priority, see setThreadPriority
+    uint64_t           fAffinityMask;     // CPUs to run on, 0 for any
+    std::size_t        fStackSize;        // Stack size, 0 for default
+    bool               fLockStack;        // Lock stack in memory
+
+    /*
+     * Flag access with acquire/release ordering, using __sync builtins without C++11.
+     */
+    static bool _loadFlag(const AtomicFlag& flag) noexcept
+    {
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+        return flag.load(std::memory_order_acquire);
+#else
+        const bool value = flag;
+        __sync_synchronize();
+        return value;
+#endif
+    }
+
+    static void _storeFlag(AtomicFlag& flag, const bool value) noexcept
+    {
+#ifdef DISTRHO_PROPER_CPP11_SUPPORT
+        flag.store(value, std::memory_order_release);
+#else
+        __sync_synchronize();
+        flag = value;
+#endif
+    }
 
     /*
      * Init pthread type.
@@ -259,8 +427,36 @@ private:
      */
     void _runEntryPoint() noexcept
     {
+        // setting the handle here instead of in startThread makes sure it is never set after _init(),
+        // which could happen when run() returns quickly
+        _copyFrom(pthread_self());
+        _storeFlag(fIsRunning, true);
+
         setCurrentThreadName(fName);
 
+#ifdef DISTRHO_OS_LINUX
+        if (fAffinityMask != 0)
+        {
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+
+            for (uint i=0; i < 64 && i < CPU_SETSIZE; ++i)
+            {
+                if (fAffinityMask & (static_cast<uint64_t>(1) << i))
+                    CPU_SET(i, &cpuSet);
+            }
+
+            if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0)
+                d_stderr("Thread '%s': failed to set CPU affinity", fName.buffer());
+        }
+#endif
+
+        void* lockedStack = nullptr;
+        std::size_t lockedStackSize = 0;
+
+        if (fLockStack)
+            _lockStack(lockedStack, lockedStackSize);
+
         // report ready
         fSignal.signal();
 
@@ -268,8 +464,43 @@ private:
             run();
         } catch(...) {}
 
-        // done
+#ifndef DISTRHO_OS_WINDOWS
+        if (lockedStack != nullptr)
+            munlock(lockedStack, lockedStackSize);
+#endif
+
+        // done, stopThread waits for this signal.
+        // this object may be deleted as soon as it is sent, so it must be the last thing touched here
         _init();
+        _storeFlag(fIsRunning, false);
+        fExitSignal.signal();
+    }
+
+    /*
+     * Lock the stack of the calling thread in memory.
+     */
+    void _lockStack(void*& stack, std::size_t& stackSize) noexcept
+    {
+#if defined(DISTRHO_OS_LINUX)
+        pthread_attr_t attr;
+
+        if (pthread_getattr_np(pthread_self(), &attr) == 0)
+        {
+            pthread_attr_getstack(&attr, &stack, &stackSize);
+            pthread_attr_destroy(&attr);
+        }
+#elif defined(DISTRHO_OS_MAC)
+        stackSize = pthread_get_stacksize_np(pthread_self());
+        stack = static_cast<char*>(pthread_get_stackaddr_np(pthread_self())) - stackSize;
+#endif
+
+#ifndef DISTRHO_OS_WINDOWS
+        if (stack != nullptr && mlock(stack, stackSize) != 0)
+        {
+            d_stderr("Thread '%s': failed to lock stack memory", fName.buffer());
+            stack = nullptr;
+        }
+#endif
     }
 
     /*
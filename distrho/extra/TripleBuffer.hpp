@@ -0,0 +1,126 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef DISTRHO_TRIPLE_BUFFER_HPP_INCLUDED
+#define DISTRHO_TRIPLE_BUFFER_HPP_INCLUDED
+
+#include "RingBuffer.hpp"
+
+START_NAMESPACE_DISTRHO
+
+// -----------------------------------------------------------------------
+// TripleBuffer class
+
+/*
+ * Wait-free "latest value" exchange between one writer and one reader thread,
+ * e.g. the audio thread publishing scope or meter snapshots for the UI.
+ * The writer fills its own buffer and publishes it, the reader always gets the most recent
+ * complete snapshot. Intermediate snapshots are dropped if the reader is slower than the writer.
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+    /*
+     * Constructor.
+     */
+    TripleBuffer() noexcept
+        : fWriteIndex(0),
+          fMiddle(1),
+          fReadIndex(2),
+          fBuffers() {}
+
+    /*
+     * Get the buffer to write the next snapshot into, called from the writer thread only.
+     */
+    T& getWriteBuffer() noexcept
+    {
+        return fBuffers[fWriteIndex];
+    }
+
+    /*
+     * Make the write buffer available to the reader, called from the writer thread only.
+     */
+    void publish() noexcept
+    {
+        const uint8_t previous = fMiddle.exchange(static_cast<uint8_t>(fWriteIndex | kNewDataFlag),
+                                                  std::memory_order_acq_rel);
+        fWriteIndex = previous & kIndexMask;
+    }
+
+    /*
+     * Copy and publish a snapshot, called from the writer thread only.
+     */
+    void write(const T& value) noexcept
+    {
+        fBuffers[fWriteIndex] = value;
+        publish();
+    }
+
+    /*
+     * Switch to the latest published snapshot, called from the reader thread only.
+     * Returns true if there was a new one since the last call.
+     */
+    bool update() noexcept
+    {
+        if ((fMiddle.load(std::memory_order_relaxed) & kNewDataFlag) == 0)
+            return false;
+
+        const uint8_t previous = fMiddle.exchange(fReadIndex, std::memory_order_acq_rel);
+        fReadIndex = previous & kIndexMask;
+        return true;
+    }
+
+    /*
+     * Get the current snapshot, called from the reader thread only.
+     * Stays valid until the next call to update().
+     */
+    const T& getReadBuffer() const noexcept
+    {
+        return fBuffers[fReadIndex];
+    }
+
+    /*
+     * Get a copy of the latest snapshot, called from the reader thread only.
+     * Returns true if it is newer than the one from the last call.
+     */
+    bool read(T& value) noexcept
+    {
+        const bool isNew = update();
+        value = fBuffers[fReadIndex];
+        return isNew;
+    }
+
+private:
+    static const uint8_t kIndexMask   = 0x3;
+    static const uint8_t kNewDataFlag = 0x4;
+
+    // the buffer indexes are only ever swapped, each one is owned by a single side at a time
+    alignas(kCacheLineSize) uint8_t fWriteIndex;
+    alignas(kCacheLineSize) std::atomic<uint8_t> fMiddle;
+    alignas(kCacheLineSize) uint8_t fReadIndex;
+
+    T fBuffers[3];
+
+    DISTRHO_PREVENT_HEAP_ALLOCATION
+    DISTRHO_DECLARE_NON_COPY_CLASS(TripleBuffer)
+};
+
+// -----------------------------------------------------------------------
+
+END_NAMESPACE_DISTRHO
+
+#endif // DISTRHO_TRIPLE_BUFFER_HPP_INCLUDED
@@ -119,6 +119,15 @@ private:                                 \
     static void operator delete(void*);
 #endif
 
+/* Define DISTRHO_THREAD_LOCAL */
+#if defined(DISTRHO_PROPER_CPP11_SUPPORT) && ! (defined(DISTRHO_OS_MAC) && defined(__clang__) && __clang_major__ < 8)
+# define DISTRHO_THREAD_LOCAL thread_local
+#elif defined(_MSC_VER)
+# define DISTRHO_THREAD_LOCAL __declspec(thread)
+#else
+# define DISTRHO_THREAD_LOCAL __thread
+#endif
+
 /* Define namespace */
 #ifndef DISTRHO_NAMESPACE
 # define DISTRHO_NAMESPACE WOLF_DISTRHO
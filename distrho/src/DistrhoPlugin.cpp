@@ -21,8 +21,8 @@ START_NAMESPACE_DISTRHO
 /* ------------------------------------------------------------------------------------------------------------
  * Static data, see DistrhoPluginInternal.hpp */
 
-uint32_t d_lastBufferSize = 0;
-double   d_lastSampleRate = 0.0;
+DISTRHO_THREAD_LOCAL uint32_t d_lastBufferSize = 0;
+DISTRHO_THREAD_LOCAL double   d_lastSampleRate = 0.0;
 
 /* ------------------------------------------------------------------------------------------------------------
  * Static fallback data, see DistrhoPluginInternal.hpp */
@@ -32,39 +32,36 @@ const AudioPort                  PluginExporter::sFallbackAudioPort;
 const ParameterRanges            PluginExporter::sFallbackRanges;
 const ParameterEnumerationValues PluginExporter::sFallbackEnumValues;
 
+/* ------------------------------------------------------------------------------------------------------------
+ * Shared metadata, see DistrhoPluginInternal.hpp */
+
+PluginMetadata* PluginExporter::sMetadata = nullptr;
+Mutex           PluginExporter::sMetadataMutex;
+
+#if DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS
+/* ------------------------------------------------------------------------------------------------------------
+ * Background program loading, see DistrhoPluginInternal.hpp */
+
+ProgramLoader PluginExporter::sProgramLoader;
+#endif
+
 /* ------------------------------------------------------------------------------------------------------------
  * Plugin */
 
 Plugin::Plugin(uint32_t parameterCount, uint32_t programCount, uint32_t stateCount)
     : pData(new PrivateData())
 {
-#if DISTRHO_PLUGIN_NUM_INPUTS+DISTRHO_PLUGIN_NUM_OUTPUTS > 0
-    pData->audioPorts = new AudioPort[DISTRHO_PLUGIN_NUM_INPUTS+DISTRHO_PLUGIN_NUM_OUTPUTS];
-#endif
-
-    if (parameterCount > 0)
-    {
-        pData->parameterCount = parameterCount;
-        pData->parameters     = new Parameter[parameterCount];
-    }
+    // the arrays are allocated and filled by PluginExporter, once per process
+    pData->parameterCount = parameterCount;
 
 #if DISTRHO_PLUGIN_WANT_PROGRAMS
-    if (programCount > 0)
-    {
-        pData->programCount = programCount;
-        pData->programNames = new String[programCount];
-    }
+    pData->programCount = programCount;
 #else
     DISTRHO_SAFE_ASSERT(programCount == 0);
 #endif
 
 #if DISTRHO_PLUGIN_WANT_STATE
-    if (stateCount > 0)
-    {
-        pData->stateCount     = stateCount;
-        pData->stateKeys      = new String[stateCount];
-        pData->stateDefValues = new String[stateCount];
-    }
+    pData->stateCount = stateCount;
 #else
     DISTRHO_SAFE_ASSERT(stateCount == 0);
 #endif
@@ -91,8 +88,24 @@ double Plugin::getSampleRate() const noexcept
 #if DISTRHO_PLUGIN_WANT_TIMEPOS
 const TimePosition& Plugin::getTimePosition() const noexcept
 {
+    pData->updateTimePositionIfNeeded();
     return pData->timePosition;
 }
+
+const TimePositionSegment* Plugin::getTimePositionSegments(uint32_t& count) const noexcept
+{
+    pData->updateTimePositionIfNeeded();
+
+    if (pData->timePositionSegmentCount != 0)
+    {
+        count = pData->timePositionSegmentCount;
+        return pData->timePositionSegments;
+    }
+
+    pData->timePositionSegment.position = pData->timePosition;
+    count = 1;
+    return &pData->timePositionSegment;
+}
 #endif
 
 #if DISTRHO_PLUGIN_WANT_LATENCY
@@ -102,6 +115,18 @@ void Plugin::setLatency(uint32_t frames) noexcept
 }
 #endif
 
+#if DISTRHO_PLUGIN_WANT_TAIL
+void Plugin::setTailLength(uint32_t frames) noexcept
+{
+    pData->tailLength = frames;
+}
+
+void Plugin::setOutputSilent() noexcept
+{
+    pData->outputSilent = true;
+}
+#endif
+
 #if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
 bool Plugin::writeMidiEvent(const MidiEvent& midiEvent) noexcept
 {
@@ -133,6 +158,80 @@ void Plugin::initAudioPort(bool input, uint32_t index, AudioPort& port)
 /* ------------------------------------------------------------------------------------------------------------
  * Callbacks (optional) */
 
+void Plugin::getParameterValueText(const uint32_t index, float value, char* const text, const uint32_t size) const
+{
+    DISTRHO_SAFE_ASSERT_RETURN(text != nullptr && size > 0,);
+    DISTRHO_SAFE_ASSERT_RETURN(pData->parameters != nullptr && index < pData->parameterCount,);
+
+    const Parameter& param(pData->parameters[index]);
+
+    if (param.hints & kParameterIsBoolean)
+    {
+        const float midRange = param.ranges.min + (param.ranges.max - param.ranges.min) / 2.0f;
+
+        value = value > midRange ? param.ranges.max : param.ranges.min;
+    }
+    else if (param.hints & kParameterIsInteger)
+    {
+        value = std::round(value);
+    }
+
+    for (uint8_t i = 0; i < param.enumValues.count; ++i)
+    {
+        if (d_isNotEqual(value, param.enumValues.values[i].value))
+            continue;
+
+        std::strncpy(text, param.enumValues.values[i].label.buffer(), size-1);
+        text[size-1] = '\0';
+        return;
+    }
+
+    if (param.hints & kParameterIsInteger)
+    {
+        std::snprintf(text, size, "%d", static_cast<int32_t>(value));
+    }
+    else
+    {
+        std::snprintf(text, size, "%f", static_cast<double>(value));
+
+        // hosts may run with a locale using ',' as decimal separator
+        const struct lconv* const lc = std::localeconv();
+
+        if (lc != nullptr && lc->decimal_point != nullptr && lc->decimal_point[0] != '\0' && lc->decimal_point[0] != '.')
+        {
+            if (char* const sep = std::strchr(text, lc->decimal_point[0]))
+                *sep = '.';
+        }
+    }
+}
+
+bool Plugin::getParameterValueFromText(const uint32_t index, const char* const text, float& value) const
+{
+    DISTRHO_SAFE_ASSERT_RETURN(text != nullptr, false);
+    DISTRHO_SAFE_ASSERT_RETURN(pData->parameters != nullptr && index < pData->parameterCount, false);
+
+    const Parameter& param(pData->parameters[index]);
+
+    for (uint8_t i = 0; i < param.enumValues.count; ++i)
+    {
+        if (param.enumValues.values[i].label != text)
+            continue;
+
+        value = param.enumValues.values[i].value;
+        return true;
+    }
+
+    const char* end;
+    const float fvalue = d_str2float(text, &end);
+
+    // nan would pass through the parameter range checks
+    if (end == text || std::isnan(fvalue))
+        return false;
+
+    value = fvalue;
+    return true;
+}
+
 void Plugin::bufferSizeChanged(uint32_t) {}
 void Plugin::sampleRateChanged(double)   {}
 
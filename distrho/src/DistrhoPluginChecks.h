@@ -61,6 +61,22 @@
 # define DISTRHO_PLUGIN_WANT_DIRECT_ACCESS 0
 #endif
 
+#ifndef DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+# define DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION 0
+#endif
+
+#ifndef DISTRHO_PLUGIN_WANT_TAIL
+# define DISTRHO_PLUGIN_WANT_TAIL 0
+#endif
+
+#ifndef DISTRHO_PLUGIN_WANT_FLUSH_DENORMALS
+# define DISTRHO_PLUGIN_WANT_FLUSH_DENORMALS 0
+#endif
+
+#ifndef DISTRHO_PLUGIN_WANT_HOST_BYPASS
+# define DISTRHO_PLUGIN_WANT_HOST_BYPASS 0
+#endif
+
 #ifndef DISTRHO_PLUGIN_WANT_LATENCY
 # define DISTRHO_PLUGIN_WANT_LATENCY 0
 #endif
@@ -73,6 +89,10 @@
 # define DISTRHO_PLUGIN_WANT_PROGRAMS 0
 #endif
 
+#ifndef DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS
+# define DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS 0
+#endif
+
 #ifndef DISTRHO_PLUGIN_WANT_STATE
 # define DISTRHO_PLUGIN_WANT_STATE 0
 #endif
@@ -107,6 +127,21 @@
 # define DISTRHO_UI_URI DISTRHO_PLUGIN_URI "#UI"
 #endif
 
+// -----------------------------------------------------------------------
+// Define DISTRHO_UI_DEFAULT_WIDTH and DISTRHO_UI_DEFAULT_HEIGHT if needed
+
+#ifndef DISTRHO_UI_DEFAULT_WIDTH
+# define DISTRHO_UI_DEFAULT_WIDTH 0
+#endif
+
+#ifndef DISTRHO_UI_DEFAULT_HEIGHT
+# define DISTRHO_UI_DEFAULT_HEIGHT 0
+#endif
+
+#if (DISTRHO_UI_DEFAULT_WIDTH > 0) != (DISTRHO_UI_DEFAULT_HEIGHT > 0)
+# error DISTRHO_UI_DEFAULT_WIDTH and DISTRHO_UI_DEFAULT_HEIGHT must be defined together
+#endif
+
 // -----------------------------------------------------------------------
 // Test if synth has audio outputs
 
@@ -114,6 +149,17 @@
 # error Synths need audio output to work!
 #endif
 
+// -----------------------------------------------------------------------
+// Test if host bypass has audio outputs
+
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS && DISTRHO_PLUGIN_NUM_OUTPUTS == 0
+# error Host bypass needs audio output to work!
+#endif
+
+#if DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS && ! DISTRHO_PLUGIN_WANT_PROGRAMS
+# error Asynchronous programs requested but programs are disabled!
+#endif
+
 // -----------------------------------------------------------------------
 // Enable MIDI input if synth, test if midi-input disabled when synth
 
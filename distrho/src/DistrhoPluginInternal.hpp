@@ -18,6 +18,23 @@
 #define DISTRHO_PLUGIN_INTERNAL_HPP_INCLUDED
 
 #include "../DistrhoPlugin.hpp"
+#include "../extra/Mutex.hpp"
+
+#if DISTRHO_PLUGIN_WANT_FLUSH_DENORMALS
+# include "../extra/ScopedDenormalDisable.hpp"
+#endif
+
+#if DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS
+# ifndef DISTRHO_PROPER_CPP11_SUPPORT
+#  error DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS requires C++11 (std::atomic)
+# endif
+# include "../extra/Thread.hpp"
+# include <atomic>
+#endif
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
 
 START_NAMESPACE_DISTRHO
 
@@ -26,29 +43,138 @@ START_NAMESPACE_DISTRHO
 
 static const uint32_t kMaxMidiEvents = 512;
 
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+// channels passed through when bypassed, any extra outputs are silent
+# if DISTRHO_PLUGIN_NUM_INPUTS < DISTRHO_PLUGIN_NUM_OUTPUTS
+#  define DISTRHO_PLUGIN_NUM_BYPASS_CHANNELS DISTRHO_PLUGIN_NUM_INPUTS
+# else
+#  define DISTRHO_PLUGIN_NUM_BYPASS_CHANNELS DISTRHO_PLUGIN_NUM_OUTPUTS
+# endif
+#endif
+
 // -----------------------------------------------------------------------
 // Static data, see DistrhoPlugin.cpp
 
-extern uint32_t d_lastBufferSize;
-extern double   d_lastSampleRate;
+extern DISTRHO_THREAD_LOCAL uint32_t d_lastBufferSize;
+extern DISTRHO_THREAD_LOCAL double   d_lastSampleRate;
+
+// -----------------------------------------------------------------------
+// Sample format conversion, used for double precision processing
+
+static inline
+void d_convertFloatToDouble(const float* const src, double* const dst, const uint32_t frames) noexcept
+{
+    uint32_t i = 0;
+
+#ifdef __SSE2__
+    for (; i + 4 <= frames; i += 4)
+    {
+        const __m128 v = _mm_loadu_ps(src + i);
+        _mm_storeu_pd(dst + i,     _mm_cvtps_pd(v));
+        _mm_storeu_pd(dst + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+    }
+#endif
+
+    for (; i < frames; ++i)
+        dst[i] = static_cast<double>(src[i]);
+}
+
+static inline
+void d_convertDoubleToFloat(const double* const src, float* const dst, const uint32_t frames) noexcept
+{
+    uint32_t i = 0;
+
+#ifdef __SSE2__
+    for (; i + 4 <= frames; i += 4)
+    {
+        const __m128 low  = _mm_cvtpd_ps(_mm_loadu_pd(src + i));
+        const __m128 high = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2));
+        _mm_storeu_ps(dst + i, _mm_movelh_ps(low, high));
+    }
+#endif
+
+    for (; i < frames; ++i)
+        dst[i] = static_cast<float>(src[i]);
+}
+
+// -----------------------------------------------------------------------
+// Silence detection, used for skipping run() once the plugin tail is over
+
+static inline
+bool d_isSilent(const float* const buffer, const uint32_t frames) noexcept
+{
+    uint32_t i = 0;
+
+#ifdef __SSE2__
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; i + 16 <= frames; i += 16)
+    {
+        const __m128 a = _mm_or_ps(_mm_cmpneq_ps(_mm_loadu_ps(buffer + i),     zero),
+                                   _mm_cmpneq_ps(_mm_loadu_ps(buffer + i + 4), zero));
+        const __m128 b = _mm_or_ps(_mm_cmpneq_ps(_mm_loadu_ps(buffer + i + 8),  zero),
+                                   _mm_cmpneq_ps(_mm_loadu_ps(buffer + i + 12), zero));
+
+        if (_mm_movemask_ps(_mm_or_ps(a, b)) != 0)
+            return false;
+    }
+#endif
+
+    for (; i < frames; ++i)
+    {
+        if (! (buffer[i] == 0.0f))
+            return false;
+    }
+
+    return true;
+}
+
+static inline
+bool d_isSilent(const double* const buffer, const uint32_t frames) noexcept
+{
+    uint32_t i = 0;
+
+#ifdef __SSE2__
+    const __m128d zero = _mm_setzero_pd();
+
+    for (; i + 8 <= frames; i += 8)
+    {
+        const __m128d a = _mm_or_pd(_mm_cmpneq_pd(_mm_loadu_pd(buffer + i),     zero),
+                                    _mm_cmpneq_pd(_mm_loadu_pd(buffer + i + 2), zero));
+        const __m128d b = _mm_or_pd(_mm_cmpneq_pd(_mm_loadu_pd(buffer + i + 4), zero),
+                                    _mm_cmpneq_pd(_mm_loadu_pd(buffer + i + 6), zero));
+
+        if (_mm_movemask_pd(_mm_or_pd(a, b)) != 0)
+            return false;
+    }
+#endif
+
+    for (; i < frames; ++i)
+    {
+        if (! (buffer[i] == 0.0))
+            return false;
+    }
+
+    return true;
+}
 
 // -----------------------------------------------------------------------
 // DSP callbacks
 
 typedef bool (*writeMidiFunc) (void* ptr, const MidiEvent& midiEvent);
+typedef void (*updateTimePositionFunc) (void* ptr);
 
 // -----------------------------------------------------------------------
-// Plugin private data
+// Plugin metadata, filled by the init functions of the first instance and shared by all others
 
-struct Plugin::PrivateData {
-    bool isProcessing;
+struct PluginMetadata {
+    uint32_t refCount;
 
 #if DISTRHO_PLUGIN_NUM_INPUTS+DISTRHO_PLUGIN_NUM_OUTPUTS > 0
     AudioPort* audioPorts;
 #endif
 
     uint32_t   parameterCount;
-    uint32_t   parameterOffset;
     Parameter* parameters;
 
 #if DISTRHO_PLUGIN_WANT_PROGRAMS
@@ -62,17 +188,98 @@ struct Plugin::PrivateData {
     String*  stateDefValues;
 #endif
 
+    PluginMetadata(const uint32_t paramCount, const uint32_t progCount, const uint32_t stCount)
+        : refCount(1),
+#if DISTRHO_PLUGIN_NUM_INPUTS+DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+          audioPorts(new AudioPort[DISTRHO_PLUGIN_NUM_INPUTS+DISTRHO_PLUGIN_NUM_OUTPUTS]),
+#endif
+          parameterCount(paramCount),
+          parameters(paramCount > 0 ? new Parameter[paramCount] : nullptr)
+#if DISTRHO_PLUGIN_WANT_PROGRAMS
+        , programCount(progCount),
+          programNames(progCount > 0 ? new String[progCount] : nullptr)
+#endif
+#if DISTRHO_PLUGIN_WANT_STATE
+        , stateCount(stCount),
+          stateKeys(stCount > 0 ? new String[stCount] : nullptr),
+          stateDefValues(stCount > 0 ? new String[stCount] : nullptr)
+#endif
+    {
+        // unused
+        return; (void)progCount; (void)stCount;
+    }
+
+    ~PluginMetadata()
+    {
+#if DISTRHO_PLUGIN_NUM_INPUTS+DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        delete[] audioPorts;
+#endif
+        delete[] parameters;
+#if DISTRHO_PLUGIN_WANT_PROGRAMS
+        delete[] programNames;
+#endif
+#if DISTRHO_PLUGIN_WANT_STATE
+        delete[] stateKeys;
+        delete[] stateDefValues;
+#endif
+    }
+
+    DISTRHO_DECLARE_NON_COPY_STRUCT(PluginMetadata)
+};
+
+// -----------------------------------------------------------------------
+// Plugin private data
+
+struct Plugin::PrivateData {
+    bool isProcessing;
+
+    // read-only, point into the shared PluginMetadata
+
+#if DISTRHO_PLUGIN_NUM_INPUTS+DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+    const AudioPort* audioPorts;
+#endif
+
+    uint32_t         parameterCount;
+    uint32_t         parameterOffset;
+    const Parameter* parameters;
+
+#if DISTRHO_PLUGIN_WANT_PROGRAMS
+    uint32_t      programCount;
+    const String* programNames;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_STATE
+    uint32_t      stateCount;
+    const String* stateKeys;
+    const String* stateDefValues;
+#endif
+
 #if DISTRHO_PLUGIN_WANT_LATENCY
     uint32_t latency;
 #endif
 
+#if DISTRHO_PLUGIN_WANT_TAIL
+    uint32_t tailLength;
+    bool     outputSilent;
+#endif
+
 #if DISTRHO_PLUGIN_WANT_TIMEPOS
     TimePosition timePosition;
+    // set by formats that fetch the time position on first use in a block
+    bool timePositionPending;
+    // set by formats that report position changes within a block
+    const TimePositionSegment* timePositionSegments;
+    uint32_t timePositionSegmentCount;
+    // single segment for the other formats
+    TimePositionSegment timePositionSegment;
 #endif
 
     // Callbacks
     void*         callbacksPtr;
     writeMidiFunc writeMidiCallbackFunc;
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+    updateTimePositionFunc updateTimePositionCallbackFunc;
+#endif
 
     uint32_t bufferSize;
     double   sampleRate;
@@ -96,9 +303,22 @@ struct Plugin::PrivateData {
 #endif
 #if DISTRHO_PLUGIN_WANT_LATENCY
           latency(0),
+#endif
+#if DISTRHO_PLUGIN_WANT_TAIL
+          tailLength(0),
+          outputSilent(false),
+#endif
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+          timePositionPending(false),
+          timePositionSegments(nullptr),
+          timePositionSegmentCount(0),
+          timePositionSegment(),
 #endif
           callbacksPtr(nullptr),
           writeMidiCallbackFunc(nullptr),
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+          updateTimePositionCallbackFunc(nullptr),
+#endif
           bufferSize(d_lastBufferSize),
           sampleRate(d_lastSampleRate)
     {
@@ -122,45 +342,6 @@ struct Plugin::PrivateData {
 #endif
     }
 
-    ~PrivateData() noexcept
-    {
-#if DISTRHO_PLUGIN_NUM_INPUTS+DISTRHO_PLUGIN_NUM_OUTPUTS > 0
-        if (audioPorts != nullptr)
-        {
-            delete[] audioPorts;
-            audioPorts = nullptr;
-        }
-#endif
-
-        if (parameters != nullptr)
-        {
-            delete[] parameters;
-            parameters = nullptr;
-        }
-
-#if DISTRHO_PLUGIN_WANT_PROGRAMS
-        if (programNames != nullptr)
-        {
-            delete[] programNames;
-            programNames = nullptr;
-        }
-#endif
-
-#if DISTRHO_PLUGIN_WANT_STATE
-        if (stateKeys != nullptr)
-        {
-            delete[] stateKeys;
-            stateKeys = nullptr;
-        }
-
-        if (stateDefValues != nullptr)
-        {
-            delete[] stateDefValues;
-            stateDefValues = nullptr;
-        }
-#endif
-    }
-
 #if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
     bool writeMidiCallback(const MidiEvent& midiEvent)
     {
@@ -170,153 +351,532 @@ struct Plugin::PrivateData {
         return false;
     }
 #endif
-};
-
-// -----------------------------------------------------------------------
-// Plugin exporter class
 
-class PluginExporter
-{
-public:
-    PluginExporter(void* const callbacksPtr, const writeMidiFunc writeMidiCall)
-        : fPlugin(createPlugin()),
-          fData((fPlugin != nullptr) ? fPlugin->pData : nullptr),
-          fIsActive(false)
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+    void updateTimePositionIfNeeded()
     {
-        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
-        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
+        // only ask the host while processing, where its time info is valid
+        if (! timePositionPending || ! isProcessing)
+            return;
 
-#if DISTRHO_PLUGIN_NUM_INPUTS+DISTRHO_PLUGIN_NUM_OUTPUTS > 0
-        {
-            uint32_t j=0;
-# if DISTRHO_PLUGIN_NUM_INPUTS > 0
-            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i, ++j)
-                fPlugin->initAudioPort(true, i, fData->audioPorts[j]);
-# endif
-# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
-            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i, ++j)
-                fPlugin->initAudioPort(false, i, fData->audioPorts[j]);
-# endif
-        }
+        timePositionPending = false;
+        updateTimePositionCallbackFunc(callbacksPtr);
+    }
 #endif
+};
 
-        for (uint32_t i=0, count=fData->parameterCount; i < count; ++i)
-            fPlugin->initParameter(i, fData->parameters[i]);
-
-#if DISTRHO_PLUGIN_WANT_PROGRAMS
-        for (uint32_t i=0, count=fData->programCount; i < count; ++i)
-            fPlugin->initProgramName(i, fData->programNames[i]);
-#endif
+#if DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS
+// -----------------------------------------------------------------------
+// Programs loaded in the background
 
-#if DISTRHO_PLUGIN_WANT_STATE
-        for (uint32_t i=0, count=fData->stateCount; i < count; ++i)
-            fPlugin->initState(i, fData->stateKeys[i], fData->stateDefValues[i]);
-#endif
+/*
+ * Parameter values and states of a program, prepared by the ProgramLoader thread.
+ * Only the values the program changed are applied, the others may have been changed since the request.
+ */
+struct ProgramSnapshot {
+    uint32_t program;
+    float*   parameterValues;
+    bool*    parameterChanged;
+# if DISTRHO_PLUGIN_WANT_FULL_STATE
+    String*  stateValues;
+    bool*    stateChanged;
+# endif
+    ProgramSnapshot* next;  // used while waiting to be deleted
 
-        fData->callbacksPtr          = callbacksPtr;
-        fData->writeMidiCallbackFunc = writeMidiCall;
+    ProgramSnapshot(const uint32_t prog, const PluginMetadata* const metadata)
+        : program(prog),
+          parameterValues(metadata->parameterCount > 0 ? new float[metadata->parameterCount] : nullptr),
+          parameterChanged(metadata->parameterCount > 0 ? new bool[metadata->parameterCount] : nullptr),
+# if DISTRHO_PLUGIN_WANT_FULL_STATE
+          stateValues(metadata->stateCount > 0 ? new String[metadata->stateCount] : nullptr),
+          stateChanged(metadata->stateCount > 0 ? new bool[metadata->stateCount] : nullptr),
+# endif
+          next(nullptr)
+    {
+        for (uint32_t i=0; i < metadata->parameterCount; ++i)
+            parameterChanged[i] = false;
+# if DISTRHO_PLUGIN_WANT_FULL_STATE
+        for (uint32_t i=0; i < metadata->stateCount; ++i)
+            stateChanged[i] = false;
+# endif
     }
 
-    ~PluginExporter()
+    ~ProgramSnapshot()
     {
-        delete fPlugin;
+        delete[] parameterValues;
+        delete[] parameterChanged;
+# if DISTRHO_PLUGIN_WANT_FULL_STATE
+        delete[] stateValues;
+        delete[] stateChanged;
+# endif
     }
 
-    // -------------------------------------------------------------------
+    DISTRHO_DECLARE_NON_COPY_STRUCT(ProgramSnapshot)
+};
 
-    const char* getName() const noexcept
+/*
+ * Program requests of a single plugin instance, registered to the ProgramLoader while the instance is active.
+ * The audio thread writes 'pending', the loader thread turns it into a snapshot in 'ready',
+ * the audio thread takes it from there and hands it back through 'applied' once used,
+ * so snapshots are only allocated and deleted by the loader thread.
+ */
+struct ProgramRequest {
+    Plugin* plugin;
+    const PluginMetadata* metadata;
+    uint32_t bufferSize; // protected by the loader requests mutex while registered
+    double   sampleRate; // same
+
+    std::atomic<bool>             registered;
+    std::atomic<int32_t>          pending;
+    std::atomic<ProgramSnapshot*> ready;
+    std::atomic<ProgramSnapshot*> applied;
+
+    ProgramRequest* next; // list of the ProgramLoader
+
+    ProgramRequest() noexcept
+        : plugin(nullptr),
+          metadata(nullptr),
+          bufferSize(0),
+          sampleRate(0.0),
+          registered(false),
+          pending(-1),
+          ready(nullptr),
+          applied(nullptr),
+          next(nullptr) {}
+
+    ~ProgramRequest()
     {
-        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, "");
-
-        return fPlugin->getName();
+        clear();
     }
 
-    const char* getLabel() const noexcept
+    // called while not registered
+    void clear()
     {
-        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, "");
-
-        return fPlugin->getLabel();
+        pending.store(-1);
+        delete ready.exchange(nullptr);
+        deleteApplied();
     }
 
-    const char* getDescription() const noexcept
+    // called from the audio thread, lock-free
+    void pushApplied(ProgramSnapshot* const snapshot) noexcept
     {
-        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, "");
+        ProgramSnapshot* head = applied.load(std::memory_order_relaxed);
 
-        return fPlugin->getDescription();
+        do {
+            snapshot->next = head;
+        } while (! applied.compare_exchange_weak(head, snapshot, std::memory_order_release, std::memory_order_relaxed));
     }
 
-    const char* getMaker() const noexcept
+    void deleteApplied()
     {
-        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, "");
-
-        return fPlugin->getMaker();
+        for (ProgramSnapshot* snapshot = applied.exchange(nullptr, std::memory_order_acquire), *next; snapshot != nullptr; snapshot = next)
+        {
+            next = snapshot->next;
+            delete snapshot;
+        }
     }
 
-    const char* getHomePage() const noexcept
+    DISTRHO_DECLARE_NON_COPY_STRUCT(ProgramRequest)
+};
+
+/*
+ * Background thread shared by all plugin instances, loads requested programs into a separate plugin instance.
+ * Runs while there are active instances. The audio thread never waits on it,
+ * requests are picked up by polling every few milliseconds.
+ */
+class ProgramLoader : public Thread
+{
+public:
+    ProgramLoader() noexcept
+        : Thread("DPF programs"),
+          fRequests(nullptr),
+          fThreadMutex(),
+          fRequestsMutex(),
+          fSignal() {}
+
+    void addRequest(ProgramRequest* const request)
     {
-        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, "");
+        const MutexLocker cml(fThreadMutex);
 
-        return fPlugin->getHomePage();
+        bool wasEmpty;
+        {
+            const MutexLocker crml(fRequestsMutex);
+            wasEmpty = fRequests == nullptr;
+            request->next = fRequests;
+            fRequests = request;
+        }
+
+        if (wasEmpty)
+            startThread();
     }
 
-    const char* getLicense() const noexcept
+    void removeRequest(ProgramRequest* const request)
     {
-        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, "");
+        const MutexLocker cml(fThreadMutex);
 
-        return fPlugin->getLicense();
+        bool isEmpty;
+        {
+            const MutexLocker crml(fRequestsMutex);
+
+            for (ProgramRequest** it = &fRequests; *it != nullptr; it = &(*it)->next)
+            {
+                if (*it == request)
+                {
+                    *it = request->next;
+                    break;
+                }
+            }
+
+            isEmpty = fRequests == nullptr;
+        }
+
+        if (isEmpty)
+        {
+            signalThreadShouldExit();
+            fSignal.signal();
+            stopThread(-1);
+        }
     }
 
-    uint32_t getVersion() const noexcept
+    void updateRequest(ProgramRequest* const request, const uint32_t bufferSize, const double sampleRate)
     {
-        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, 0);
+        const MutexLocker crml(fRequestsMutex);
 
-        return fPlugin->getVersion();
+        request->bufferSize = bufferSize;
+        request->sampleRate = sampleRate;
     }
 
-    long getUniqueId() const noexcept
+protected:
+    void run() override
     {
-        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, 0);
+        Plugin* shadow = nullptr;
 
-        return fPlugin->getUniqueId();
-    }
+        while (! shouldThreadExit())
+        {
+            // woken up early only when stopping
+            fSignal.wait(kPollInterval);
 
-    void* getInstancePointer() const noexcept
-    {
-        return fPlugin;
+            const MutexLocker crml(fRequestsMutex);
+
+            for (ProgramRequest* request = fRequests; request != nullptr; request = request->next)
+                prepare(shadow, *request);
+        }
+
+        delete shadow;
     }
 
-    // -------------------------------------------------------------------
+private:
+    static const uint kPollInterval = 10; // ms
 
-#if DISTRHO_PLUGIN_WANT_LATENCY
-    uint32_t getLatency() const noexcept
+    ProgramRequest* fRequests;
+    Mutex  fThreadMutex;   // serializes starting and stopping the thread
+    Mutex  fRequestsMutex; // protects fRequests, held while preparing
+    Signal fSignal;
+
+    void prepare(Plugin*& shadow, ProgramRequest& request)
     {
-        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, 0);
+        request.deleteApplied();
 
-        return fData->latency;
-    }
-#endif
+        const int32_t program = request.pending.exchange(-1);
 
-#if DISTRHO_PLUGIN_NUM_INPUTS+DISTRHO_PLUGIN_NUM_OUTPUTS > 0
-    const AudioPort& getAudioPort(const bool input, const uint32_t index) const noexcept
-    {
-        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, sFallbackAudioPort);
+        if (program < 0)
+            return;
 
-        if (input)
+        const PluginMetadata* const metadata = request.metadata;
+        const uint32_t bufferSize = request.bufferSize;
+        const double   sampleRate = request.sampleRate;
+
+        // start from the current values of the instance, read like a host would from a non-realtime thread
+        ProgramSnapshot* const snapshot = new ProgramSnapshot(static_cast<uint32_t>(program), metadata);
+
+        for (uint32_t i=0; i < metadata->parameterCount; ++i)
         {
-# if DISTRHO_PLUGIN_NUM_INPUTS > 0
-            DISTRHO_SAFE_ASSERT_RETURN(index < DISTRHO_PLUGIN_NUM_INPUTS,  sFallbackAudioPort);
+            // outputs are written by run() and never applied
+            snapshot->parameterValues[i] = (metadata->parameters[i].hints & kParameterIsOutput)
+                                         ? 0.0f
+                                         : request.plugin->getParameterValue(i);
+        }
+# if DISTRHO_PLUGIN_WANT_FULL_STATE
+        for (uint32_t i=0; i < metadata->stateCount; ++i)
+            snapshot->stateValues[i] = request.plugin->getState(metadata->stateKeys[i]);
 # endif
+
+        // created on first use, then following the settings of the instance asking for a program
+        if (shadow == nullptr)
+        {
+            d_lastBufferSize = bufferSize;
+            d_lastSampleRate = sampleRate;
+            shadow = createPlugin();
         }
         else
         {
-# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
-            DISTRHO_SAFE_ASSERT_RETURN(index < DISTRHO_PLUGIN_NUM_OUTPUTS, sFallbackAudioPort);
-# endif
+            if (shadow->pData->bufferSize != bufferSize)
+            {
+                shadow->pData->bufferSize = bufferSize;
+                shadow->bufferSizeChanged(bufferSize);
+            }
+
+            if (d_isNotEqual(shadow->pData->sampleRate, sampleRate))
+            {
+                shadow->pData->sampleRate = sampleRate;
+                shadow->sampleRateChanged(sampleRate);
+            }
         }
 
-        return fData->audioPorts[index + (input ? 0 : DISTRHO_PLUGIN_NUM_INPUTS)];
-    }
-#endif
+        const bool shadowValid = shadow != nullptr && shadow->pData->parameterCount == metadata->parameterCount;
+
+        if (! shadowValid)
+            delete snapshot;
+
+        DISTRHO_SAFE_ASSERT_RETURN(shadowValid,);
+
+        // load the program on top of the instance values, so what it does not touch stays as is
+        for (uint32_t i=0; i < metadata->parameterCount; ++i)
+        {
+            if ((metadata->parameters[i].hints & kParameterIsOutput) == 0)
+                shadow->setParameterValue(i, snapshot->parameterValues[i]);
+        }
+
+# if DISTRHO_PLUGIN_WANT_FULL_STATE
+        for (uint32_t i=0; i < metadata->stateCount; ++i)
+        {
+            const String& key(metadata->stateKeys[i]);
+
+            if (shadow->getState(key) != snapshot->stateValues[i])
+                shadow->setState(key, snapshot->stateValues[i]);
+        }
+# endif
+
+        shadow->loadProgram(snapshot->program);
+
+        for (uint32_t i=0; i < metadata->parameterCount; ++i)
+        {
+            if (metadata->parameters[i].hints & kParameterIsOutput)
+                continue;
+
+            const float value = shadow->getParameterValue(i);
+
+            snapshot->parameterChanged[i] = d_isNotEqual(value, snapshot->parameterValues[i]);
+            snapshot->parameterValues[i]  = value;
+        }
+
+# if DISTRHO_PLUGIN_WANT_FULL_STATE
+        for (uint32_t i=0; i < metadata->stateCount; ++i)
+        {
+            const String value(shadow->getState(metadata->stateKeys[i]));
+
+            snapshot->stateChanged[i] = value != snapshot->stateValues[i];
+            snapshot->stateValues[i]  = value;
+        }
+# endif
+
+        // replace a program the audio thread did not get to, keeping the changes only it made
+        if (ProgramSnapshot* const previous = request.ready.exchange(nullptr))
+        {
+            for (uint32_t i=0; i < metadata->parameterCount; ++i)
+            {
+                if (previous->parameterChanged[i] && ! snapshot->parameterChanged[i])
+                {
+                    snapshot->parameterValues[i]  = previous->parameterValues[i];
+                    snapshot->parameterChanged[i] = true;
+                }
+            }
+# if DISTRHO_PLUGIN_WANT_FULL_STATE
+            for (uint32_t i=0; i < metadata->stateCount; ++i)
+            {
+                if (previous->stateChanged[i] && ! snapshot->stateChanged[i])
+                {
+                    snapshot->stateValues[i]  = previous->stateValues[i];
+                    snapshot->stateChanged[i] = true;
+                }
+            }
+# endif
+            delete previous;
+        }
+
+        request.ready.store(snapshot);
+    }
+
+    DISTRHO_DECLARE_NON_COPY_CLASS(ProgramLoader)
+};
+#endif
+
+// -----------------------------------------------------------------------
+// Plugin exporter class
+
+class PluginExporter
+{
+public:
+    PluginExporter(void* const callbacksPtr, const writeMidiFunc writeMidiCall)
+        : fPlugin(createPlugin()),
+          fData((fPlugin != nullptr) ? fPlugin->pData : nullptr),
+          fMetadata(acquireMetadata()),
+          fIsActive(false)
+#if DISTRHO_PLUGIN_WANT_TAIL
+        , fSilentFrames(0)
+#endif
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+        , fBypassEnabled(false),
+          fBypassBuffers(nullptr),
+          fBypassBufferSize(0),
+          fBypassWritePos(0),
+          fBypassFadeLength(1),
+          fBypassFadePos(0),
+          fBypassHoldFrames(0),
+          fBypassPluginStale(false)
+#endif
+#if ! DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+        , fConversionFrames(0),
+          fConversionBuffers(nullptr),
+          fConversionMidiEvents(nullptr)
+#endif
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
+        DISTRHO_SAFE_ASSERT_RETURN(fMetadata != nullptr,);
+
+#if DISTRHO_PLUGIN_NUM_INPUTS+DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        fData->audioPorts = fMetadata->audioPorts;
+#endif
+        fData->parameters = fMetadata->parameters;
+#if DISTRHO_PLUGIN_WANT_PROGRAMS
+        fData->programNames = fMetadata->programNames;
+#endif
+#if DISTRHO_PLUGIN_WANT_STATE
+        fData->stateKeys      = fMetadata->stateKeys;
+        fData->stateDefValues = fMetadata->stateDefValues;
+#endif
+
+        fData->callbacksPtr          = callbacksPtr;
+        fData->writeMidiCallbackFunc = writeMidiCall;
+
+#if DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS
+        // the loader thread only runs while there are active instances
+        fProgramRequest.plugin   = fPlugin;
+        fProgramRequest.metadata = fMetadata;
+#endif
+    }
+
+    ~PluginExporter()
+    {
+#if DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS
+        unregisterProgramRequest();
+#endif
+        delete fPlugin;
+        releaseMetadata();
+#if ! DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+        delete[] fConversionBuffers;
+        delete[] fConversionMidiEvents;
+#endif
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+        delete[] fBypassBuffers;
+#endif
+    }
+
+    // -------------------------------------------------------------------
+
+    const char* getName() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, "");
+
+        return fPlugin->getName();
+    }
+
+    const char* getLabel() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, "");
+
+        return fPlugin->getLabel();
+    }
+
+    const char* getDescription() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, "");
+
+        return fPlugin->getDescription();
+    }
+
+    const char* getMaker() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, "");
+
+        return fPlugin->getMaker();
+    }
+
+    const char* getHomePage() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, "");
+
+        return fPlugin->getHomePage();
+    }
+
+    const char* getLicense() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, "");
+
+        return fPlugin->getLicense();
+    }
+
+    uint32_t getVersion() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, 0);
+
+        return fPlugin->getVersion();
+    }
+
+    long getUniqueId() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, 0);
+
+        return fPlugin->getUniqueId();
+    }
+
+    void* getInstancePointer() const noexcept
+    {
+        return fPlugin;
+    }
+
+    // -------------------------------------------------------------------
+
+#if DISTRHO_PLUGIN_WANT_LATENCY
+    uint32_t getLatency() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, 0);
+
+        return fData->latency;
+    }
+#endif
+
+#if DISTRHO_PLUGIN_WANT_TAIL
+    uint32_t getTailLength() const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, 0);
+
+        return fData->tailLength;
+    }
+#endif
+
+#if DISTRHO_PLUGIN_NUM_INPUTS+DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+    const AudioPort& getAudioPort(const bool input, const uint32_t index) const noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, sFallbackAudioPort);
+
+        if (input)
+        {
+# if DISTRHO_PLUGIN_NUM_INPUTS > 0
+            DISTRHO_SAFE_ASSERT_RETURN(index < DISTRHO_PLUGIN_NUM_INPUTS,  sFallbackAudioPort);
+# endif
+        }
+        else
+        {
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+            DISTRHO_SAFE_ASSERT_RETURN(index < DISTRHO_PLUGIN_NUM_OUTPUTS, sFallbackAudioPort);
+# endif
+        }
+
+        return fData->audioPorts[index + (input ? 0 : DISTRHO_PLUGIN_NUM_INPUTS)];
+    }
+#endif
 
     uint32_t getParameterCount() const noexcept
     {
@@ -423,9 +983,41 @@ public:
         DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
         DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr && index < fData->parameterCount,);
 
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+        if (fData->parameters[index].designation == kParameterDesignationBypass)
+            fBypassEnabled = value > 0.5f;
+#endif
+
         fPlugin->setParameterValue(index, value);
     }
 
+    void getParameterValueText(const uint32_t index, const float value, char* const text, const uint32_t size) const
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr && index < fData->parameterCount,);
+        DISTRHO_SAFE_ASSERT_RETURN(text != nullptr && size > 0,);
+
+        text[0] = '\0';
+        fPlugin->getParameterValueText(index, value, text, size);
+        text[size-1] = '\0';
+    }
+
+    // the value is clamped to the parameter ranges
+    bool getParameterValueFromText(const uint32_t index, const char* const text, float& value) const
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, false);
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr && index < fData->parameterCount, false);
+        DISTRHO_SAFE_ASSERT_RETURN(text != nullptr, false);
+
+        float parsed;
+
+        if (! fPlugin->getParameterValueFromText(index, text, parsed))
+            return false;
+
+        value = fData->parameters[index].ranges.getFixedValue(parsed);
+        return true;
+    }
+
 #if DISTRHO_PLUGIN_WANT_PROGRAMS
     uint32_t getProgramCount() const noexcept
     {
@@ -448,6 +1040,67 @@ public:
 
         fPlugin->loadProgram(index);
     }
+
+    /*
+     * Load a program on behalf of the host, from any thread.
+     * Returns true if the program was loaded right away.
+     * With async programs and an active plugin it is prepared in the background instead, without locking or allocating,
+     * applyRequestedProgram() then applies it at the start of a later audio block.
+     */
+    bool requestProgram(const uint32_t index)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, false);
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr && index < fData->programCount, false);
+
+# if DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS
+        if (fProgramRequest.registered.load())
+        {
+            // only the latest request matters, lock-free as this is usually the audio thread
+            fProgramRequest.pending.store(static_cast<int32_t>(index));
+            return false;
+        }
+# endif
+
+        fPlugin->loadProgram(index);
+        return true;
+    }
+
+    /*
+     * Apply the last program prepared in the background, called from the audio thread before processing.
+     * Returns the program index, or -1 if there was nothing to apply.
+     */
+    int32_t applyRequestedProgram()
+    {
+# if DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr, -1);
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr, -1);
+
+        ProgramSnapshot* const snapshot = fProgramRequest.ready.exchange(nullptr);
+
+        if (snapshot == nullptr)
+            return -1;
+
+        for (uint32_t i=0; i < fData->parameterCount; ++i)
+        {
+            if (snapshot->parameterChanged[i])
+                setParameterValue(i, snapshot->parameterValues[i]);
+        }
+
+#  if DISTRHO_PLUGIN_WANT_FULL_STATE
+        for (uint32_t i=0; i < fData->stateCount; ++i)
+        {
+            if (snapshot->stateChanged[i])
+                fPlugin->setState(fData->stateKeys[i], snapshot->stateValues[i]);
+        }
+#  endif
+
+        const int32_t program = static_cast<int32_t>(snapshot->program);
+        fProgramRequest.pushApplied(snapshot);
+        return program;
+# else
+        return -1;
+# endif
+    }
 #endif
 
 #if DISTRHO_PLUGIN_WANT_STATE
@@ -512,6 +1165,38 @@ public:
         DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
 
         std::memcpy(&fData->timePosition, &timePosition, sizeof(TimePosition));
+        fData->timePositionPending = false;
+    }
+
+    /*
+     * Time positions within the current block, the first one must match setTimePosition().
+     * The segments must stay valid until the next call, or pass a null pointer to clear them.
+     */
+    void setTimePositionSegments(const TimePositionSegment* const segments, const uint32_t count) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
+
+        fData->timePositionSegments     = segments;
+        fData->timePositionSegmentCount = segments != nullptr ? count : 0;
+    }
+
+    /*
+     * Fetch the time position from the wrapper only if the plugin asks for it during this block.
+     * The callback is expected to call setTimePosition().
+     */
+    void setTimePositionCallback(const updateTimePositionFunc updateTimePositionCall) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
+
+        fData->updateTimePositionCallbackFunc = updateTimePositionCall;
+    }
+
+    void invalidateTimePosition() noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
+        DISTRHO_SAFE_ASSERT_RETURN(fData->updateTimePositionCallbackFunc != nullptr,);
+
+        fData->timePositionPending = true;
     }
 #endif
 
@@ -528,7 +1213,12 @@ public:
         DISTRHO_SAFE_ASSERT_RETURN(! fIsActive,);
 
         fIsActive = true;
+        resetSilence();
         fPlugin->activate();
+        resetBypass();
+#if DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS
+        registerProgramRequest();
+#endif
     }
 
     void deactivate()
@@ -536,6 +1226,9 @@ public:
         DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
         DISTRHO_SAFE_ASSERT_RETURN(fIsActive,);
 
+#if DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS
+        unregisterProgramRequest();
+#endif
         fIsActive = false;
         fPlugin->deactivate();
     }
@@ -546,6 +1239,9 @@ public:
 
         if (fIsActive)
         {
+#if DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS
+            unregisterProgramRequest();
+#endif
             fIsActive = false;
             fPlugin->deactivate();
         }
@@ -558,15 +1254,42 @@ public:
         DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
         DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
 
+#if DISTRHO_PLUGIN_WANT_FLUSH_DENORMALS
+        const ScopedDenormalDisable sdd;
+#endif
+
         if (! fIsActive)
         {
             fIsActive = true;
+            resetSilence();
             fPlugin->activate();
+            resetBypass();
+        }
+
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+        bool dryValid = false;
+
+        if (processBypassBefore(inputs, outputs, frames, dryValid))
+            return;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_TAIL
+        if (skipSilentRun(inputs, outputs, frames, midiEventCount))
+        {
+# if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+            processBypassAfter(outputs, frames, dryValid);
+# endif
+            return;
         }
+#endif
 
         fData->isProcessing = true;
         fPlugin->run(inputs, outputs, frames, midiEvents, midiEventCount);
         fData->isProcessing = false;
+
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+        processBypassAfter(outputs, frames, dryValid);
+#endif
     }
 #else
     void run(const float** const inputs, float** const outputs, const uint32_t frames)
@@ -574,16 +1297,142 @@ public:
         DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
         DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
 
+#if DISTRHO_PLUGIN_WANT_FLUSH_DENORMALS
+        const ScopedDenormalDisable sdd;
+#endif
+
         if (! fIsActive)
         {
             fIsActive = true;
+            resetSilence();
             fPlugin->activate();
+            resetBypass();
+        }
+
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+        bool dryValid = false;
+
+        if (processBypassBefore(inputs, outputs, frames, dryValid))
+            return;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_TAIL
+        if (skipSilentRun(inputs, outputs, frames, 0))
+        {
+# if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+            processBypassAfter(outputs, frames, dryValid);
+# endif
+            return;
         }
+#endif
 
         fData->isProcessing = true;
         fPlugin->run(inputs, outputs, frames);
         fData->isProcessing = false;
-    }
+
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+        processBypassAfter(outputs, frames, dryValid);
+#endif
+    }
+#endif
+
+    // -------------------------------------------------------------------
+    // Double precision processing
+
+   /*
+    * Prepare for double precision processing, called by the wrappers that may process in double precision.
+    * Plugins without their own double precision run() get conversion buffers here, which then follow
+    * buffer size changes. Does nothing if already prepared, but must not be called during processing.
+    */
+    void prepareDoublePrecision()
+    {
+#if ! DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
+
+        if (fConversionBuffers == nullptr || fConversionFrames != fData->bufferSize)
+            allocateConversionBuffers(fData->bufferSize);
+#endif
+    }
+
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+    void run(const double** const inputs, double** const outputs, const uint32_t frames,
+             const MidiEvent* const midiEvents, const uint32_t midiEventCount)
+#else
+    void run(const double** const inputs, double** const outputs, const uint32_t frames)
+#endif
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fData != nullptr,);
+        DISTRHO_SAFE_ASSERT_RETURN(fPlugin != nullptr,);
+
+#if DISTRHO_PLUGIN_WANT_FLUSH_DENORMALS
+        const ScopedDenormalDisable sdd;
+#endif
+
+        if (! fIsActive)
+        {
+            fIsActive = true;
+            resetSilence();
+            fPlugin->activate();
+            resetBypass();
+        }
+
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+        bool dryValid = false;
+
+        if (processBypassBefore(inputs, outputs, frames, dryValid))
+            return;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_TAIL
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        if (skipSilentRun(inputs, outputs, frames, midiEventCount))
+# else
+        if (skipSilentRun(inputs, outputs, frames, 0))
+# endif
+        {
+# if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+            processBypassAfter(outputs, frames, dryValid);
+# endif
+            return;
+        }
+#endif
+
+#if DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+        fData->isProcessing = true;
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        fPlugin->run(inputs, outputs, frames, midiEvents, midiEventCount);
+# else
+        fPlugin->run(inputs, outputs, frames);
+# endif
+        fData->isProcessing = false;
+#elif DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        runConverted(inputs, outputs, frames, midiEvents, midiEventCount);
+#else
+        runConverted(inputs, outputs, frames, nullptr, 0);
+#endif
+
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+        processBypassAfter(outputs, frames, dryValid);
+#endif
+    }
+
+    // -------------------------------------------------------------------
+    // Host bypass
+
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+   /*
+    * Engage or disengage bypass, the switch is crossfaded during the next runs.
+    * Setting the bypass designated parameter does this too.
+    */
+    void setBypass(const bool bypass) noexcept
+    {
+        fBypassEnabled = bypass;
+    }
+
+    bool isBypassed() const noexcept
+    {
+        return fBypassEnabled;
+    }
 #endif
 
     // -------------------------------------------------------------------
@@ -611,6 +1460,20 @@ public:
 
         fData->bufferSize = bufferSize;
 
+#if DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS
+        if (fProgramRequest.registered.load())
+            sProgramLoader.updateRequest(&fProgramRequest, fData->bufferSize, fData->sampleRate);
+#endif
+
+#if ! DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+        if (fConversionBuffers != nullptr)
+            allocateConversionBuffers(bufferSize);
+#endif
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+        if (fBypassBuffers != nullptr)
+            resetBypass();
+#endif
+
         if (doCallback)
         {
             if (fIsActive) fPlugin->deactivate();
@@ -630,6 +1493,11 @@ public:
 
         fData->sampleRate = sampleRate;
 
+#if DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS
+        if (fProgramRequest.registered.load())
+            sProgramLoader.updateRequest(&fProgramRequest, fData->bufferSize, fData->sampleRate);
+#endif
+
         if (doCallback)
         {
             if (fIsActive) fPlugin->deactivate();
@@ -644,8 +1512,539 @@ private:
 
     Plugin* const fPlugin;
     Plugin::PrivateData* const fData;
+    PluginMetadata* const fMetadata;
     bool fIsActive;
 
+#if DISTRHO_PLUGIN_WANT_TAIL
+    // -------------------------------------------------------------------
+    // Silence detection
+
+    // consecutive frames of silent input the plugin has been run for
+    uint64_t fSilentFrames;
+
+    /*
+     * Skip run() if the inputs are silent, there are no MIDI events and the plugin tail is over.
+     * The outputs are zeroed in that case.
+     * Plugins without audio inputs (synths) are only skipped once they call setOutputSilent(),
+     * as held notes keep sounding for any time after their last MIDI event.
+     */
+    template<typename T>
+    bool skipSilentRun(const T** const inputs, T** const outputs, const uint32_t frames, const uint32_t midiEventCount)
+    {
+        bool silent = midiEventCount == 0;
+
+# if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS && silent; ++i)
+            silent = d_isSilent(inputs[i], frames);
+# endif
+
+        if (! silent)
+        {
+            fSilentFrames = 0;
+            fData->outputSilent = false;
+            return false;
+        }
+
+# if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        if (fData->outputSilent || fSilentFrames >= fData->tailLength)
+# else
+        if (fData->outputSilent)
+# endif
+        {
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+                std::memset(outputs[i], 0, sizeof(T)*frames);
+# endif
+            return true;
+        }
+
+        fSilentFrames += frames;
+        return false;
+
+        // unused
+        (void)inputs; (void)outputs;
+    }
+#endif
+
+    // a freshly activated plugin has no tail to play
+    void resetSilence() noexcept
+    {
+#if DISTRHO_PLUGIN_WANT_TAIL
+        fSilentFrames = 0;
+        fData->outputSilent = true;
+#endif
+    }
+
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+    // -------------------------------------------------------------------
+    // Host bypass
+
+    bool fBypassEnabled;
+
+    // history of the dry signal, one delay line per bypass channel
+    double*  fBypassBuffers;
+    uint32_t fBypassBufferSize;
+    uint32_t fBypassWritePos;
+
+    // crossfade position, 0 is fully processed and fBypassFadeLength fully bypassed
+    uint32_t fBypassFadeLength;
+    uint32_t fBypassFadePos;
+
+    // frames to keep the output dry after disengaging, while the plugin fills its latency
+    uint32_t fBypassHoldFrames;
+
+    // the plugin did not run while fully bypassed, its internal state is outdated
+    bool fBypassPluginStale;
+
+    uint32_t getBypassLatency() const noexcept
+    {
+# if DISTRHO_PLUGIN_WANT_LATENCY
+        return fData->latency;
+# else
+        return 0;
+# endif
+    }
+
+   /*
+    * Store the dry signal for this run, and pass it through when fully bypassed.
+    * Returns true if the plugin must not run.
+    */
+    template<typename T>
+    bool processBypassBefore(const T** const inputs, T** const outputs, const uint32_t frames, bool& dryValid)
+    {
+        const bool bypassed = fBypassEnabled && fBypassFadePos == fBypassFadeLength;
+
+        if (fBypassPluginStale && ! fBypassEnabled)
+        {
+            // resuming from full bypass, start from a clean state instead of playing old delay lines and tails
+            fPlugin->deactivate();
+            fPlugin->activate();
+            resetSilence();
+            fBypassPluginStale = false;
+            fBypassHoldFrames  = getBypassLatency();
+        }
+
+# if DISTRHO_PLUGIN_NUM_BYPASS_CHANNELS > 0
+        const uint32_t latency = getBypassLatency();
+        const bool fading = fBypassFadePos != (fBypassEnabled ? fBypassFadeLength : 0);
+
+        // needed for crossfading and latency compensation, and must be stored before running the plugin
+        // as hosts can use the same buffers for inputs and outputs
+        dryValid = (fading || latency != 0) && fBypassBuffers != nullptr && frames + latency <= fBypassBufferSize;
+
+        if (dryValid)
+        {
+            const uint32_t mask = fBypassBufferSize - 1;
+
+            for (uint32_t c=0; c < DISTRHO_PLUGIN_NUM_BYPASS_CHANNELS; ++c)
+            {
+                double* const buffer = fBypassBuffers + c * fBypassBufferSize;
+
+                for (uint32_t i=0; i < frames; ++i)
+                    buffer[(fBypassWritePos + i) & mask] = inputs[c][i];
+            }
+        }
+# else
+        dryValid = true;
+# endif
+
+        if (! bypassed)
+            return false;
+
+        fBypassPluginStale = true;
+
+# if DISTRHO_PLUGIN_NUM_BYPASS_CHANNELS > 0
+        for (uint32_t c=0; c < DISTRHO_PLUGIN_NUM_BYPASS_CHANNELS; ++c)
+        {
+            if (dryValid && latency != 0)
+            {
+                const uint32_t mask = fBypassBufferSize - 1;
+                const double* const buffer = fBypassBuffers + c * fBypassBufferSize;
+
+                for (uint32_t i=0; i < frames; ++i)
+                    outputs[c][i] = static_cast<T>(buffer[(fBypassWritePos + i - latency) & mask]);
+            }
+            else if (outputs[c] != inputs[c])
+            {
+                std::memcpy(outputs[c], inputs[c], sizeof(T)*frames);
+            }
+        }
+
+        if (dryValid)
+            fBypassWritePos = (fBypassWritePos + frames) & (fBypassBufferSize - 1);
+# endif
+
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > DISTRHO_PLUGIN_NUM_BYPASS_CHANNELS
+        for (uint32_t c=DISTRHO_PLUGIN_NUM_BYPASS_CHANNELS; c < DISTRHO_PLUGIN_NUM_OUTPUTS; ++c)
+            std::memset(outputs[c], 0, sizeof(T)*frames);
+# endif
+
+        return true;
+
+        // unused
+        (void)inputs;
+    }
+
+   /*
+    * Crossfade the plugin output with the dry signal while bypass is being engaged or disengaged.
+    */
+    template<typename T>
+    void processBypassAfter(T** const outputs, const uint32_t frames, const bool dryValid)
+    {
+        const uint32_t target = fBypassEnabled ? fBypassFadeLength : 0;
+
+        if (fBypassEnabled)
+            fBypassHoldFrames = 0;
+
+        if (fBypassFadePos != target && ! dryValid)
+        {
+            // no dry signal to fade to (the host block is bigger than expected), switch on the next run
+            fBypassFadePos    = target;
+            fBypassHoldFrames = 0;
+        }
+        else if (fBypassFadePos != target)
+        {
+            const double fadeLength = fBypassFadeLength;
+            uint32_t pos = fBypassFadePos;
+            uint32_t hold = fBypassHoldFrames;
+
+# if DISTRHO_PLUGIN_NUM_BYPASS_CHANNELS > 0
+            const uint32_t latency = getBypassLatency();
+            const uint32_t mask = fBypassBufferSize - 1;
+
+            for (uint32_t c=0; c < DISTRHO_PLUGIN_NUM_BYPASS_CHANNELS; ++c)
+            {
+                const double* const buffer = fBypassBuffers + c * fBypassBufferSize;
+                pos  = fBypassFadePos;
+                hold = fBypassHoldFrames;
+
+                for (uint32_t i=0; i < frames; ++i)
+                {
+                    if (hold != 0) --hold;
+                    else if (pos < target) ++pos; else if (pos > target) --pos;
+
+                    const double wet = outputs[c][i];
+                    const double dry = buffer[(fBypassWritePos + i - latency) & mask];
+                    outputs[c][i] = static_cast<T>(wet + (dry - wet) * (pos / fadeLength));
+                }
+            }
+# endif
+
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > DISTRHO_PLUGIN_NUM_BYPASS_CHANNELS
+            for (uint32_t c=DISTRHO_PLUGIN_NUM_BYPASS_CHANNELS; c < DISTRHO_PLUGIN_NUM_OUTPUTS; ++c)
+            {
+                pos  = fBypassFadePos;
+                hold = fBypassHoldFrames;
+
+                for (uint32_t i=0; i < frames; ++i)
+                {
+                    if (hold != 0) --hold;
+                    else if (pos < target) ++pos; else if (pos > target) --pos;
+
+                    outputs[c][i] = static_cast<T>(outputs[c][i] * (1.0 - pos / fadeLength));
+                }
+            }
+# endif
+
+            fBypassFadePos    = pos;
+            fBypassHoldFrames = hold;
+        }
+
+# if DISTRHO_PLUGIN_NUM_BYPASS_CHANNELS > 0
+        if (dryValid)
+            fBypassWritePos = (fBypassWritePos + frames) & (fBypassBufferSize - 1);
+# endif
+
+    }
+#endif
+
+    // called after activation, when the plugin latency is known
+    void resetBypass()
+    {
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+        // 10ms crossfade
+        fBypassFadeLength = static_cast<uint32_t>(fData->sampleRate * 0.01 + 0.5);
+
+        if (fBypassFadeLength == 0)
+            fBypassFadeLength = 1;
+
+        fBypassFadePos     = fBypassEnabled ? fBypassFadeLength : 0;
+        fBypassWritePos    = 0;
+        fBypassHoldFrames  = 0;
+        fBypassPluginStale = false;
+
+# if DISTRHO_PLUGIN_NUM_BYPASS_CHANNELS > 0
+        uint32_t size = 1;
+
+        while (size < fData->bufferSize + getBypassLatency())
+            size *= 2;
+
+        if (size > fBypassBufferSize)
+        {
+            delete[] fBypassBuffers;
+            fBypassBuffers    = new double[DISTRHO_PLUGIN_NUM_BYPASS_CHANNELS * size];
+            fBypassBufferSize = size;
+        }
+
+        std::memset(fBypassBuffers, 0, sizeof(double)*DISTRHO_PLUGIN_NUM_BYPASS_CHANNELS*fBypassBufferSize);
+# endif
+#endif
+    }
+
+#if ! DISTRHO_PLUGIN_WANT_DOUBLE_PRECISION
+    // -------------------------------------------------------------------
+    // Double precision processing for single precision plugins
+
+    // one single precision buffer per audio port
+    uint32_t   fConversionFrames;
+    float*     fConversionBuffers;
+    MidiEvent* fConversionMidiEvents;
+
+    void allocateConversionBuffers(const uint32_t frames)
+    {
+        delete[] fConversionBuffers;
+        fConversionBuffers = nullptr;
+        fConversionFrames  = 0;
+
+        if (frames == 0)
+            return;
+
+        fConversionBuffers = new float[(DISTRHO_PLUGIN_NUM_INPUTS + DISTRHO_PLUGIN_NUM_OUTPUTS) * frames + 1];
+        fConversionFrames  = frames;
+
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        if (fConversionMidiEvents == nullptr)
+            fConversionMidiEvents = new MidiEvent[kMaxMidiEvents];
+# endif
+    }
+
+   /*
+    * Run the single precision plugin on converted copies of the buffers.
+    * Hosts may process more frames than the buffer size, these are split into several runs.
+    */
+    void runConverted(const double** const inputs, double** const outputs, const uint32_t frames,
+                      const MidiEvent* const midiEvents, const uint32_t midiEventCount)
+    {
+        if (fConversionBuffers == nullptr)
+        {
+            // the wrapper did not call prepareDoublePrecision()
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+                std::memset(outputs[i], 0, sizeof(double)*frames);
+# endif
+
+            DISTRHO_SAFE_ASSERT_RETURN(fConversionBuffers != nullptr,);
+        }
+
+        float* floatInputs[DISTRHO_PLUGIN_NUM_INPUTS + 1];
+        float* floatOutputs[DISTRHO_PLUGIN_NUM_OUTPUTS + 1];
+
+# if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+            floatInputs[i] = fConversionBuffers + i * fConversionFrames;
+# endif
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+            floatOutputs[i] = fConversionBuffers + (DISTRHO_PLUGIN_NUM_INPUTS + i) * fConversionFrames;
+# endif
+
+        uint32_t midiEventIndex = 0;
+
+        fData->isProcessing = true;
+
+# if DISTRHO_PLUGIN_WANT_TIMEPOS
+        // the frame is advanced per chunk, which needs the block start position
+        fData->updateTimePositionIfNeeded();
+        const uint64_t startFrame = fData->timePosition.frame;
+
+        // segment frames are relative to the whole block, only use them if there is a single chunk
+        const uint32_t segmentCount = fData->timePositionSegmentCount;
+
+        if (frames > fConversionFrames)
+            fData->timePositionSegmentCount = 0;
+# endif
+
+        for (uint32_t offset = 0; offset < frames;)
+        {
+            const uint32_t chunkFrames = std::min(frames - offset, fConversionFrames);
+
+# if DISTRHO_PLUGIN_NUM_INPUTS > 0
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+                d_convertDoubleToFloat(inputs[i] + offset, floatInputs[i], chunkFrames);
+# endif
+
+# if DISTRHO_PLUGIN_WANT_TIMEPOS
+            fData->timePosition.frame = startFrame + offset;
+# endif
+
+# if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+            const MidiEvent* chunkMidiEvents = midiEvents;
+            uint32_t chunkMidiEventCount = midiEventCount;
+
+            // events are sorted by frame, give each run its own ones with relative frames
+            if (chunkFrames != frames)
+            {
+                chunkMidiEvents = fConversionMidiEvents;
+                chunkMidiEventCount = 0;
+
+                for (; midiEventIndex < midiEventCount && chunkMidiEventCount < kMaxMidiEvents; ++midiEventIndex)
+                {
+                    if (midiEvents[midiEventIndex].frame >= offset + chunkFrames && offset + chunkFrames != frames)
+                        break;
+
+                    MidiEvent& midiEvent(fConversionMidiEvents[chunkMidiEventCount++]);
+                    midiEvent = midiEvents[midiEventIndex];
+                    midiEvent.frame = midiEvent.frame > offset ? midiEvent.frame - offset : 0;
+                }
+            }
+
+            fPlugin->run(const_cast<const float**>(floatInputs), floatOutputs, chunkFrames, chunkMidiEvents, chunkMidiEventCount);
+# else
+            fPlugin->run(const_cast<const float**>(floatInputs), floatOutputs, chunkFrames);
+# endif
+
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+                d_convertFloatToDouble(floatOutputs[i], outputs[i] + offset, chunkFrames);
+# endif
+
+            offset += chunkFrames;
+        }
+
+        fData->isProcessing = false;
+
+# if DISTRHO_PLUGIN_WANT_TIMEPOS
+        fData->timePosition.frame = startFrame;
+        fData->timePositionSegmentCount = segmentCount;
+# endif
+
+        // unused
+        return; (void)inputs; (void)outputs; (void)midiEvents; (void)midiEventCount; (void)midiEventIndex;
+    }
+#endif
+
+    // -------------------------------------------------------------------
+    // Shared metadata
+
+    PluginMetadata* acquireMetadata()
+    {
+        if (fPlugin == nullptr || fData == nullptr)
+            return nullptr;
+
+        uint32_t programCount = 0, stateCount = 0;
+#if DISTRHO_PLUGIN_WANT_PROGRAMS
+        programCount = fData->programCount;
+#endif
+#if DISTRHO_PLUGIN_WANT_STATE
+        stateCount = fData->stateCount;
+#endif
+
+        const MutexLocker cml(sMetadataMutex);
+
+        if (PluginMetadata* const metadata = sMetadata)
+        {
+            bool matches = metadata->parameterCount == fData->parameterCount;
+#if DISTRHO_PLUGIN_WANT_PROGRAMS
+            matches = matches && metadata->programCount == programCount;
+#endif
+#if DISTRHO_PLUGIN_WANT_STATE
+            matches = matches && metadata->stateCount == stateCount;
+#endif
+            if (matches)
+            {
+                ++metadata->refCount;
+                return metadata;
+            }
+
+            // different counts per instance, this one cannot share
+            d_stderr2("Plugin instance has different parameter, program or state counts, not sharing metadata");
+        }
+
+        PluginMetadata* const metadata = new PluginMetadata(fData->parameterCount, programCount, stateCount);
+
+#if DISTRHO_PLUGIN_NUM_INPUTS+DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        {
+            uint32_t j=0;
+# if DISTRHO_PLUGIN_NUM_INPUTS > 0
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i, ++j)
+                fPlugin->initAudioPort(true, i, metadata->audioPorts[j]);
+# endif
+# if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+            for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i, ++j)
+                fPlugin->initAudioPort(false, i, metadata->audioPorts[j]);
+# endif
+        }
+#endif
+
+        for (uint32_t i=0; i < metadata->parameterCount; ++i)
+            fPlugin->initParameter(i, metadata->parameters[i]);
+
+#if DISTRHO_PLUGIN_WANT_PROGRAMS
+        for (uint32_t i=0; i < metadata->programCount; ++i)
+            fPlugin->initProgramName(i, metadata->programNames[i]);
+#endif
+
+#if DISTRHO_PLUGIN_WANT_STATE
+        for (uint32_t i=0; i < metadata->stateCount; ++i)
+            fPlugin->initState(i, metadata->stateKeys[i], metadata->stateDefValues[i]);
+#endif
+
+        if (sMetadata == nullptr)
+            sMetadata = metadata;
+
+        return metadata;
+    }
+
+    void releaseMetadata()
+    {
+        if (fMetadata == nullptr)
+            return;
+
+        const MutexLocker cml(sMetadataMutex);
+
+        if (--fMetadata->refCount != 0)
+            return;
+
+        if (sMetadata == fMetadata)
+            sMetadata = nullptr;
+
+        delete fMetadata;
+    }
+
+    static PluginMetadata* sMetadata;
+    static Mutex sMetadataMutex;
+
+#if DISTRHO_PLUGIN_WANT_ASYNC_PROGRAMS
+    // -------------------------------------------------------------------
+    // Programs loaded in the background
+
+    ProgramRequest fProgramRequest;
+    static ProgramLoader sProgramLoader;
+
+    // called from activate(), so the request path does not need to allocate or lock
+    void registerProgramRequest()
+    {
+        if (fProgramRequest.registered.load())
+            return;
+
+        fProgramRequest.bufferSize = fData->bufferSize;
+        fProgramRequest.sampleRate = fData->sampleRate;
+        sProgramLoader.addRequest(&fProgramRequest);
+        fProgramRequest.registered.store(true);
+    }
+
+    // called when deactivating, with no audio thread running
+    void unregisterProgramRequest()
+    {
+        if (! fProgramRequest.registered.load())
+            return;
+
+        fProgramRequest.registered.store(false);
+        sProgramLoader.removeRequest(&fProgramRequest);
+        fProgramRequest.clear();
+    }
+#endif
+
     // -------------------------------------------------------------------
     // Static fallback data, see DistrhoPlugin.cpp
 
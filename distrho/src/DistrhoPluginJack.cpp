@@ -16,6 +16,10 @@
 
 #include "DistrhoPluginInternal.hpp"
 
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+# include "DistrhoPluginTransport.hpp"
+#endif
+
 #if DISTRHO_PLUGIN_HAS_UI && ! DISTRHO_PLUGIN_HAS_EMBED_UI
 # undef DISTRHO_PLUGIN_HAS_UI
 # define DISTRHO_PLUGIN_HAS_UI 0
@@ -176,6 +180,10 @@ public:
         jack_set_process_callback(fClient, jackProcessCallback, this);
         jack_on_shutdown(fClient, jackShutdownCallback, this);
 
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+        fTransport.setSampleRate(fPlugin.getSampleRate());
+#endif
+
         fPlugin.activate();
 
         jack_activate(fClient);
@@ -284,6 +292,9 @@ protected:
     void jackSampleRate(const jack_nframes_t nframes)
     {
         fPlugin.setSampleRate(nframes, true);
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+        fTransport.setSampleRate(nframes);
+#endif
     }
 
     void jackProcess(const jack_nframes_t nframes)
@@ -306,39 +317,49 @@ protected:
         static float** audioOuts = nullptr;
 #endif
 
+#if DISTRHO_PLUGIN_WANT_PROGRAMS
+        // Apply program loaded in the background
+# if DISTRHO_PLUGIN_HAS_UI
+        const int32_t program = fPlugin.applyRequestedProgram();
+
+        if (program >= 0)
+            fProgramChanged = program;
+# else
+        fPlugin.applyRequestedProgram();
+# endif
+#endif
+
 #if DISTRHO_PLUGIN_WANT_TIMEPOS
         jack_position_t pos;
-        fTimePosition.playing = (jack_transport_query(fClient, &pos) == JackTransportRolling);
+        const bool playing = (jack_transport_query(fClient, &pos) == JackTransportRolling);
 
+        fTransport.startBlock();
+
+        // keep going from the previous cycle if the position was being written while read
         if (pos.unique_1 == pos.unique_2)
         {
-            fTimePosition.frame = pos.frame;
+            fTransport.startPositionChange(0);
+            fTransport.setPlaying(playing);
+            fTransport.setFrame(pos.frame);
 
             if (pos.valid & JackTransportBBT)
             {
-                fTimePosition.bbt.valid = true;
-
-                fTimePosition.bbt.bar  = pos.bar;
-                fTimePosition.bbt.beat = pos.beat;
-                fTimePosition.bbt.tick = pos.tick;
-                fTimePosition.bbt.barStartTick = pos.bar_start_tick;
-
-                fTimePosition.bbt.beatsPerBar = pos.beats_per_bar;
-                fTimePosition.bbt.beatType    = pos.beat_type;
-
-                fTimePosition.bbt.ticksPerBeat   = pos.ticks_per_beat;
-                fTimePosition.bbt.beatsPerMinute = pos.beats_per_minute;
+                // ticks per beat first, as bar/beat/tick depends on it
+                fTransport.setTicksPerBeat(pos.ticks_per_beat);
+                fTransport.setTempo(pos.beats_per_minute);
+                fTransport.setTimeSignature(pos.beats_per_bar, pos.beat_type);
+                fTransport.setBar(pos.bar - 1);
+                fTransport.setBarBeat(pos.beat - 1 + (pos.ticks_per_beat > 0.0 ? pos.tick / pos.ticks_per_beat : 0.0));
             }
             else
-                fTimePosition.bbt.valid = false;
-        }
-        else
-        {
-            fTimePosition.bbt.valid = false;
-            fTimePosition.frame = 0;
+            {
+                fTransport.invalidateBBT();
+            }
+
+            fTransport.finishPositionChange();
         }
 
-        fPlugin.setTimePosition(fTimePosition);
+        fPlugin.setTimePosition(fTransport.getTimePosition());
 #endif
 
         void* const midiBuf = jack_port_get_buffer(fPortEventsIn, nframes);
@@ -393,9 +414,12 @@ protected:
 
                     if (program < fPlugin.getProgramCount())
                     {
-                        fPlugin.loadProgram(program);
+                        // otherwise applied at the start of the next cycle
 # if DISTRHO_PLUGIN_HAS_UI
-                        fProgramChanged = program;
+                        if (fPlugin.requestProgram(program))
+                            fProgramChanged = program;
+# else
+                        fPlugin.requestProgram(program);
 # endif
                     }
                 }
@@ -427,6 +451,10 @@ protected:
         fPlugin.run(audioIns, audioOuts, nframes);
 #endif
 
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+        fTransport.finishBlock(nframes);
+#endif
+
 #if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
         fPortMidiOutBuffer = nullptr;
 #endif
@@ -515,7 +543,7 @@ private:
     void*        fPortMidiOutBuffer;
 #endif
 #if DISTRHO_PLUGIN_WANT_TIMEPOS
-    TimePosition fTimePosition;
+    PluginTransport fTransport;
 #endif
 
     // Temporary data
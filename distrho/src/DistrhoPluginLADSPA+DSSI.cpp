@@ -177,6 +177,12 @@ public:
         if (sampleCount == 0)
             return updateParameterOutputsAndTriggers();
 
+#if defined(DISTRHO_PLUGIN_TARGET_DSSI) && DISTRHO_PLUGIN_WANT_PROGRAMS
+        // Apply program loaded in the background
+        if (fPlugin.applyRequestedProgram() >= 0)
+            updateControlInputs();
+#endif
+
         // Check for updated parameters
         float curValue;
 
@@ -317,19 +323,9 @@ public:
 
         DISTRHO_SAFE_ASSERT_RETURN(realProgram < fPlugin.getProgramCount(),);
 
-        fPlugin.loadProgram(realProgram);
-
-        // Update control inputs
-        for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
-        {
-            if (fPlugin.isParameterOutput(i))
-                continue;
-
-            fLastControlValues[i] = fPlugin.getParameterValue(i);
-
-            if (fPortControls[i] != nullptr)
-                *fPortControls[i] = fLastControlValues[i];
-        }
+        // otherwise applied in run()
+        if (fPlugin.requestProgram(realProgram))
+            updateControlInputs();
     }
 # endif
 
@@ -375,6 +371,22 @@ private:
 
     // -------------------------------------------------------------------
 
+#if defined(DISTRHO_PLUGIN_TARGET_DSSI) && DISTRHO_PLUGIN_WANT_PROGRAMS
+    void updateControlInputs()
+    {
+        for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
+        {
+            if (fPlugin.isParameterOutput(i))
+                continue;
+
+            fLastControlValues[i] = fPlugin.getParameterValue(i);
+
+            if (fPortControls[i] != nullptr)
+                *fPortControls[i] = fLastControlValues[i];
+        }
+    }
+#endif
+
     void updateParameterOutputsAndTriggers()
     {
         float value;
@@ -16,6 +16,10 @@
 
 #include "DistrhoPluginInternal.hpp"
 
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+# include "DistrhoPluginTransport.hpp"
+#endif
+
 #include "lv2/atom.h"
 #include "lv2/atom-util.h"
 #include "lv2/buf-size.h"
@@ -92,6 +96,10 @@ public:
         fPortAudioOuts = nullptr;
 #endif
 
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+        fTransport.setSampleRate(sampleRate);
+#endif
+
         if (const uint32_t count = fPlugin.getParameterCount())
         {
             fPortControls      = new float*[count];
@@ -169,17 +177,8 @@ public:
     void lv2_activate()
     {
 #if DISTRHO_PLUGIN_WANT_TIMEPOS
-        std::memset(&fTimePosition, 0, sizeof(TimePosition));
-
-        // hosts may not send all values, resulting on some invalid data
-        fTimePosition.bbt.bar   = 1;
-        fTimePosition.bbt.beat  = 1;
-        fTimePosition.bbt.tick  = 0;
-        fTimePosition.bbt.barStartTick = 0;
-        fTimePosition.bbt.beatsPerBar  = 4;
-        fTimePosition.bbt.beatType     = 4;
-        fTimePosition.bbt.ticksPerBeat = 960.0;
-        fTimePosition.bbt.beatsPerMinute = 120.0;
+        // hosts may not send all values, start from the defaults
+        fTransport.reset();
 #endif
         fPlugin.activate();
     }
@@ -260,6 +259,11 @@ public:
         uint32_t midiEventCount = 0;
 #endif
 
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+        // continues from the previous block, unless the host sends a new position
+        fTransport.startBlock();
+#endif
+
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT || DISTRHO_PLUGIN_WANT_TIMEPOS
         LV2_ATOM_SEQUENCE_FOREACH(fPortEventsIn, event)
         {
@@ -301,14 +305,14 @@ public:
                 if (obj->body.otype != fURIDs.timePosition)
                     continue;
 
-                LV2_Atom* bar     = nullptr;
-                LV2_Atom* barBeat = nullptr;
-                LV2_Atom* beatUnit = nullptr;
-                LV2_Atom* beatsPerBar = nullptr;
-                LV2_Atom* beatsPerMinute = nullptr;
-                LV2_Atom* frame = nullptr;
-                LV2_Atom* speed = nullptr;
-                LV2_Atom* ticksPerBeat = nullptr;
+                const LV2_Atom* bar     = nullptr;
+                const LV2_Atom* barBeat = nullptr;
+                const LV2_Atom* beatUnit = nullptr;
+                const LV2_Atom* beatsPerBar = nullptr;
+                const LV2_Atom* beatsPerMinute = nullptr;
+                const LV2_Atom* frame = nullptr;
+                const LV2_Atom* speed = nullptr;
+                const LV2_Atom* ticksPerBeat = nullptr;
 
                 lv2_atom_object_get(obj,
                                     fURIDs.timeBar, &bar,
@@ -321,161 +325,37 @@ public:
                                     fURIDs.timeTicksPerBeat, &ticksPerBeat,
                                     0);
 
-                // need to handle this first as other values depend on it
-                if (ticksPerBeat != nullptr)
-                {
-                    /**/ if (ticksPerBeat->type == fURIDs.atomDouble)
-                        fLastPositionData.ticksPerBeat = ((LV2_Atom_Double*)ticksPerBeat)->body;
-                    else if (ticksPerBeat->type == fURIDs.atomFloat)
-                        fLastPositionData.ticksPerBeat = ((LV2_Atom_Float*)ticksPerBeat)->body;
-                    else if (ticksPerBeat->type == fURIDs.atomInt)
-                        fLastPositionData.ticksPerBeat = ((LV2_Atom_Int*)ticksPerBeat)->body;
-                    else if (ticksPerBeat->type == fURIDs.atomLong)
-                        fLastPositionData.ticksPerBeat = ((LV2_Atom_Long*)ticksPerBeat)->body;
-                    else
-                        d_stderr("Unknown lv2 ticksPerBeat value type");
-
-                    if (fLastPositionData.ticksPerBeat > 0.0)
-                        fTimePosition.bbt.ticksPerBeat = fLastPositionData.ticksPerBeat;
-                }
+                fTransport.startPositionChange(event->time.frames);
 
-                // same
-                if (speed != nullptr)
-                {
-                    /**/ if (speed->type == fURIDs.atomDouble)
-                        fLastPositionData.speed = ((LV2_Atom_Double*)speed)->body;
-                    else if (speed->type == fURIDs.atomFloat)
-                        fLastPositionData.speed = ((LV2_Atom_Float*)speed)->body;
-                    else if (speed->type == fURIDs.atomInt)
-                        fLastPositionData.speed = ((LV2_Atom_Int*)speed)->body;
-                    else if (speed->type == fURIDs.atomLong)
-                        fLastPositionData.speed = ((LV2_Atom_Long*)speed)->body;
-                    else
-                        d_stderr("Unknown lv2 speed value type");
-
-                    fTimePosition.playing = d_isNotZero(fLastPositionData.speed);
-                }
+                double value, value2;
 
-                if (bar != nullptr)
-                {
-                    /**/ if (bar->type == fURIDs.atomDouble)
-                        fLastPositionData.bar = ((LV2_Atom_Double*)bar)->body;
-                    else if (bar->type == fURIDs.atomFloat)
-                        fLastPositionData.bar = ((LV2_Atom_Float*)bar)->body;
-                    else if (bar->type == fURIDs.atomInt)
-                        fLastPositionData.bar = ((LV2_Atom_Int*)bar)->body;
-                    else if (bar->type == fURIDs.atomLong)
-                        fLastPositionData.bar = ((LV2_Atom_Long*)bar)->body;
-                    else
-                        d_stderr("Unknown lv2 bar value type");
-
-                    if (fLastPositionData.bar >= 0)
-                        fTimePosition.bbt.bar = fLastPositionData.bar + 1;
-                }
+                // need to handle this first as other values depend on it
+                if (getAtomNumber(ticksPerBeat, value))
+                    fTransport.setTicksPerBeat(value);
 
-                if (barBeat != nullptr)
-                {
-                    /**/ if (barBeat->type == fURIDs.atomDouble)
-                        fLastPositionData.barBeat = ((LV2_Atom_Double*)barBeat)->body;
-                    else if (barBeat->type == fURIDs.atomFloat)
-                        fLastPositionData.barBeat = ((LV2_Atom_Float*)barBeat)->body;
-                    else if (barBeat->type == fURIDs.atomInt)
-                        fLastPositionData.barBeat = ((LV2_Atom_Int*)barBeat)->body;
-                    else if (barBeat->type == fURIDs.atomLong)
-                        fLastPositionData.barBeat = ((LV2_Atom_Long*)barBeat)->body;
-                    else
-                        d_stderr("Unknown lv2 barBeat value type");
-
-                    if (fLastPositionData.barBeat >= 0.0f)
-                    {
-                        const double rest = std::fmod(fLastPositionData.barBeat, 1.0f);
-                        fTimePosition.bbt.beat = std::round(fLastPositionData.barBeat-rest+1.0);
-                        fTimePosition.bbt.tick = rest*fTimePosition.bbt.ticksPerBeat+0.5;
-                    }
-                }
+                if (getAtomNumber(speed, value))
+                    fTransport.setSpeed(value);
 
-                if (beatUnit != nullptr)
-                {
-                    /**/ if (beatUnit->type == fURIDs.atomDouble)
-                        fLastPositionData.beatUnit = ((LV2_Atom_Double*)beatUnit)->body;
-                    else if (beatUnit->type == fURIDs.atomFloat)
-                        fLastPositionData.beatUnit = ((LV2_Atom_Float*)beatUnit)->body;
-                    else if (beatUnit->type == fURIDs.atomInt)
-                        fLastPositionData.beatUnit = ((LV2_Atom_Int*)beatUnit)->body;
-                    else if (beatUnit->type == fURIDs.atomLong)
-                        fLastPositionData.beatUnit = ((LV2_Atom_Long*)beatUnit)->body;
-                    else
-                        d_stderr("Unknown lv2 beatUnit value type");
-
-                    if (fLastPositionData.beatUnit > 0)
-                        fTimePosition.bbt.beatType = fLastPositionData.beatUnit;
-                }
+                if (getAtomNumber(beatsPerMinute, value))
+                    fTransport.setTempo(value);
 
-                if (beatsPerBar != nullptr)
-                {
-                    /**/ if (beatsPerBar->type == fURIDs.atomDouble)
-                        fLastPositionData.beatsPerBar = ((LV2_Atom_Double*)beatsPerBar)->body;
-                    else if (beatsPerBar->type == fURIDs.atomFloat)
-                        fLastPositionData.beatsPerBar = ((LV2_Atom_Float*)beatsPerBar)->body;
-                    else if (beatsPerBar->type == fURIDs.atomInt)
-                        fLastPositionData.beatsPerBar = ((LV2_Atom_Int*)beatsPerBar)->body;
-                    else if (beatsPerBar->type == fURIDs.atomLong)
-                        fLastPositionData.beatsPerBar = ((LV2_Atom_Long*)beatsPerBar)->body;
-                    else
-                        d_stderr("Unknown lv2 beatsPerBar value type");
-
-                    if (fLastPositionData.beatsPerBar > 0.0f)
-                        fTimePosition.bbt.beatsPerBar = fLastPositionData.beatsPerBar;
-                }
+                if (! getAtomNumber(beatsPerBar, value))
+                    value = 0.0;
+                if (! getAtomNumber(beatUnit, value2))
+                    value2 = 0.0;
 
-                if (beatsPerMinute != nullptr)
-                {
-                    /**/ if (beatsPerMinute->type == fURIDs.atomDouble)
-                        fLastPositionData.beatsPerMinute = ((LV2_Atom_Double*)beatsPerMinute)->body;
-                    else if (beatsPerMinute->type == fURIDs.atomFloat)
-                        fLastPositionData.beatsPerMinute = ((LV2_Atom_Float*)beatsPerMinute)->body;
-                    else if (beatsPerMinute->type == fURIDs.atomInt)
-                        fLastPositionData.beatsPerMinute = ((LV2_Atom_Int*)beatsPerMinute)->body;
-                    else if (beatsPerMinute->type == fURIDs.atomLong)
-                        fLastPositionData.beatsPerMinute = ((LV2_Atom_Long*)beatsPerMinute)->body;
-                    else
-                        d_stderr("Unknown lv2 beatsPerMinute value type");
-
-                    if (fLastPositionData.beatsPerMinute > 0.0f)
-                    {
-                        fTimePosition.bbt.beatsPerMinute = fLastPositionData.beatsPerMinute;
-
-                        if (d_isNotZero(fLastPositionData.speed))
-                            fTimePosition.bbt.beatsPerMinute *= std::abs(fLastPositionData.speed);
-                    }
-                }
+                fTransport.setTimeSignature(static_cast<float>(value), static_cast<float>(value2));
 
-                if (frame != nullptr)
-                {
-                    /**/ if (frame->type == fURIDs.atomDouble)
-                        fLastPositionData.frame = ((LV2_Atom_Double*)frame)->body;
-                    else if (frame->type == fURIDs.atomFloat)
-                        fLastPositionData.frame = ((LV2_Atom_Float*)frame)->body;
-                    else if (frame->type == fURIDs.atomInt)
-                        fLastPositionData.frame = ((LV2_Atom_Int*)frame)->body;
-                    else if (frame->type == fURIDs.atomLong)
-                        fLastPositionData.frame = ((LV2_Atom_Long*)frame)->body;
-                    else
-                        d_stderr("Unknown lv2 frame value type");
-
-                    if (fLastPositionData.frame >= 0)
-                        fTimePosition.frame = fLastPositionData.frame;
-                }
+                if (getAtomNumber(bar, value))
+                    fTransport.setBar(static_cast<int64_t>(value));
 
-                fTimePosition.bbt.barStartTick = fTimePosition.bbt.ticksPerBeat*
-                                                 fTimePosition.bbt.beatsPerBar*
-                                                 (fTimePosition.bbt.bar-1);
+                if (getAtomNumber(barBeat, value))
+                    fTransport.setBarBeat(value);
 
-                fTimePosition.bbt.valid = (fLastPositionData.beatsPerMinute > 0.0 &&
-                                           fLastPositionData.beatUnit > 0 &&
-                                           fLastPositionData.beatsPerBar > 0.0f);
+                if (getAtomNumber(frame, value))
+                    fTransport.setFrame(static_cast<int64_t>(value));
 
-                fPlugin.setTimePosition(fTimePosition);
+                fTransport.finishPositionChange();
 
                 continue;
             }
@@ -509,6 +389,12 @@ public:
         }
 #endif
 
+#if DISTRHO_PLUGIN_WANT_PROGRAMS
+        // Apply program loaded in the background, state is updated on save
+        if (fPlugin.applyRequestedProgram() >= 0)
+            updateControlInputs();
+#endif
+
         // Check for updated parameters
         float curValue;
 
@@ -537,6 +423,11 @@ public:
             fRunCount = mod_license_run_begin(fRunCount, sampleCount);
 #endif
 
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+            fPlugin.setTimePosition(fTransport.getTimePosition());
+            fPlugin.setTimePositionSegments(fTransport.getSegments(), fTransport.getSegmentCount());
+#endif
+
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
             fPlugin.run(fPortAudioIns, fPortAudioOuts, sampleCount, fMidiEvents, midiEventCount);
 #else
@@ -548,64 +439,12 @@ public:
                 mod_license_run_noise(fRunCount, fPortAudioOuts[i], sampleCount, i);
 #endif
 
-#if DISTRHO_PLUGIN_WANT_TIMEPOS
-            // update timePos for next callback
-            if (d_isNotZero(fLastPositionData.speed))
-            {
-                if (fLastPositionData.speed > 0.0)
-                {
-                    // playing forwards
-                    fLastPositionData.frame += sampleCount;
-                }
-                else
-                {
-                    // playing backwards
-                    fLastPositionData.frame -= sampleCount;
-
-                    if (fLastPositionData.frame < 0)
-                        fLastPositionData.frame = 0;
-                }
-
-                fTimePosition.frame = fLastPositionData.frame;
-
-                if (fTimePosition.bbt.valid)
-                {
-                    const double beatsPerMinute = fLastPositionData.beatsPerMinute * fLastPositionData.speed;
-                    const double framesPerBeat  = 60.0 * fSampleRate / beatsPerMinute;
-                    const double addedBarBeats  = double(sampleCount) / framesPerBeat;
-
-                    if (fLastPositionData.barBeat >= 0.0f)
-                    {
-                        fLastPositionData.barBeat = std::fmod(fLastPositionData.barBeat+addedBarBeats,
-                                                              (double)fLastPositionData.beatsPerBar);
-
-                        const double rest = std::fmod(fLastPositionData.barBeat, 1.0f);
-                        fTimePosition.bbt.beat = std::round(fLastPositionData.barBeat-rest+1.0);
-                        fTimePosition.bbt.tick = rest*fTimePosition.bbt.ticksPerBeat+0.5;
-
-                        if (fLastPositionData.bar >= 0)
-                        {
-                            fLastPositionData.bar += std::floor((fLastPositionData.barBeat+addedBarBeats)/
-                                                             fLastPositionData.beatsPerBar);
-
-                            if (fLastPositionData.bar < 0)
-                                fLastPositionData.bar = 0;
-
-                            fTimePosition.bbt.bar = fLastPositionData.bar + 1;
-
-                            fTimePosition.bbt.barStartTick = fTimePosition.bbt.ticksPerBeat*
-                                                             fTimePosition.bbt.beatsPerBar*
-                                                            (fTimePosition.bbt.bar-1);
-                        }
-                    }
-
-                    fTimePosition.bbt.beatsPerMinute = std::abs(beatsPerMinute);
-                }
+        }
 
-                fPlugin.setTimePosition(fTimePosition);
-            }
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+        // update timePos for next callback
+        fTransport.finishBlock(sampleCount);
 #endif
-        }
 
         updateParameterOutputsAndTriggers();
 
@@ -713,6 +552,9 @@ public:
                     const float sampleRate(*(const float*)options[i].value);
                     fSampleRate = sampleRate;
                     fPlugin.setSampleRate(sampleRate);
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+                    fTransport.setSampleRate(sampleRate);
+#endif
                 }
                 else
                 {
@@ -748,19 +590,11 @@ public:
         if (realProgram >= fPlugin.getProgramCount())
             return;
 
-        fPlugin.loadProgram(realProgram);
-
-        // Update control inputs
-        for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
-        {
-            if (fPlugin.isParameterOutput(i))
-                continue;
-
-            fLastControlValues[i] = fPlugin.getParameterValue(i);
+        // otherwise applied in run()
+        if (! fPlugin.requestProgram(realProgram))
+            return;
 
-            if (fPortControls[i] != nullptr)
-                *fPortControls[i] = fLastControlValues[i];
-        }
+        updateControlInputs();
 
 # if DISTRHO_PLUGIN_WANT_FULL_STATE
         // Update state
@@ -894,29 +728,7 @@ private:
     MidiEvent fMidiEvents[kMaxMidiEvents];
 #endif
 #if DISTRHO_PLUGIN_WANT_TIMEPOS
-    TimePosition fTimePosition;
-
-    struct Lv2PositionData {
-        int64_t  bar;
-        float    barBeat;
-        uint32_t beatUnit;
-        float    beatsPerBar;
-        float    beatsPerMinute;
-        int64_t  frame;
-        double   speed;
-        double   ticksPerBeat;
-
-        Lv2PositionData()
-            : bar(-1),
-              barBeat(-1.0f),
-              beatUnit(0),
-              beatsPerBar(0.0f),
-              beatsPerMinute(0.0f),
-              frame(-1),
-              speed(0.0),
-              ticksPerBeat(-1.0) {}
-
-    } fLastPositionData;
+    PluginTransport fTransport;
 #endif
 
 #if DISTRHO_LV2_USE_EVENTS_OUT
@@ -1033,6 +845,44 @@ private:
     }
 #endif
 
+#if DISTRHO_PLUGIN_WANT_PROGRAMS
+    void updateControlInputs()
+    {
+        for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
+        {
+            if (fPlugin.isParameterOutput(i))
+                continue;
+
+            fLastControlValues[i] = fPlugin.getParameterValue(i);
+
+            if (fPortControls[i] != nullptr)
+                *fPortControls[i] = fLastControlValues[i];
+        }
+    }
+#endif
+
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+    // hosts may send time position values as any numeric type
+    bool getAtomNumber(const LV2_Atom* const atom, double& value) const noexcept
+    {
+        if (atom == nullptr)
+            return false;
+
+        /**/ if (atom->type == fURIDs.atomDouble)
+            value = ((const LV2_Atom_Double*)atom)->body;
+        else if (atom->type == fURIDs.atomFloat)
+            value = ((const LV2_Atom_Float*)atom)->body;
+        else if (atom->type == fURIDs.atomInt)
+            value = ((const LV2_Atom_Int*)atom)->body;
+        else if (atom->type == fURIDs.atomLong)
+            value = ((const LV2_Atom_Long*)atom)->body;
+        else
+            return false;
+
+        return true;
+    }
+#endif
+
     void updateParameterOutputsAndTriggers()
     {
         float curValue;
@@ -0,0 +1,1529 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Offline render harness.
+ *
+ * Runs the plugin without a host or audio hardware, streaming a WAV/raw file or a generated
+ * signal through PluginExporter::run() at a fixed block size.
+ * An optional text script can be replayed to automate parameters, load programs, set states
+ * and send MIDI events. Output audio can be written to a file, and processing time is reported
+ * as a realtime factor plus per-block timings.
+ *
+ * Script format, one event per line ('#' starts a comment):
+ *   <time> param <index|symbol> <value>
+ *   <time> program <index>
+ *   <time> state <key> <value>
+ *   <time> note-on <channel> <note> <velocity>
+ *   <time> note-off <channel> <note>
+ *   <time> cc <channel> <control> <value>
+ *   <time> midi <byte> [<byte>...]
+ * Time is in frames, or in seconds when suffixed with 's'.
+ * Channels start at 1, MIDI bytes can be written in decimal or hexadecimal (0x90).
+ * Parameter, program and state changes are applied at the start of the block that contains them,
+ * MIDI events are passed to the plugin with their exact frame offset.
+ */
+
+#include "DistrhoPluginInternal.hpp"
+#include "../extra/Thread.hpp"
+
+// no UI in offline mode
+#undef DISTRHO_PLUGIN_HAS_UI
+#define DISTRHO_PLUGIN_HAS_UI 0
+
+#include <algorithm>
+#include <vector>
+
+#ifdef DISTRHO_OS_WINDOWS
+# include <windows.h>
+#else
+# include <time.h>
+# include <unistd.h>
+#endif
+
+// -----------------------------------------------------------------------
+
+START_NAMESPACE_DISTRHO
+
+#if ! DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
+static const writeMidiFunc writeMidiCallback = nullptr;
+#endif
+
+// -----------------------------------------------------------------------
+// time helper
+
+static inline
+double getTimeInSeconds() noexcept
+{
+#ifdef DISTRHO_OS_WINDOWS
+    static LARGE_INTEGER frequency = { 0 };
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+
+    QueryPerformanceCounter(&counter);
+    return static_cast<double>(counter.QuadPart) / static_cast<double>(frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+#endif
+}
+
+// -----------------------------------------------------------------------
+// WAV file helpers
+
+static inline
+uint16_t readLE16(const uint8_t* const data) noexcept
+{
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+static inline
+uint32_t readLE32(const uint8_t* const data) noexcept
+{
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8)
+         | (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+static inline
+void writeLE16(std::FILE* const file, const uint16_t value) noexcept
+{
+    const uint8_t data[2] = { static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8) };
+    std::fwrite(data, 1, 2, file);
+}
+
+static inline
+void writeLE32(std::FILE* const file, const uint32_t value) noexcept
+{
+    const uint8_t data[4] = { static_cast<uint8_t>(value),       static_cast<uint8_t>(value >> 8),
+                              static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 24) };
+    std::fwrite(data, 1, 4, file);
+}
+
+/*
+ * Audio data kept in memory, one buffer per channel.
+ */
+struct AudioData {
+    uint32_t channels;
+    uint32_t frames;
+    double   sampleRate;
+    std::vector<float> samples; // non-interleaved, channel after channel
+
+    AudioData() noexcept
+        : channels(0),
+          frames(0),
+          sampleRate(0.0),
+          samples() {}
+
+    void alloc(const uint32_t c, const uint32_t f)
+    {
+        channels = c;
+        frames   = f;
+        samples.assign(static_cast<std::size_t>(c) * f, 0.0f);
+    }
+
+    float* channel(const uint32_t index) noexcept
+    {
+        return &samples[static_cast<std::size_t>(index) * frames];
+    }
+
+    const float* channel(const uint32_t index) const noexcept
+    {
+        return &samples[static_cast<std::size_t>(index) * frames];
+    }
+};
+
+/*
+ * Read a RIFF/WAVE file, 16/24/32-bit integer or 32/64-bit float.
+ */
+static bool readWavFile(const char* const filename, AudioData& audio)
+{
+    std::FILE* const file = std::fopen(filename, "rb");
+
+    if (file == nullptr)
+    {
+        d_stderr("Failed to open '%s' for reading", filename);
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    uint8_t tmpBuf[4096];
+
+    for (std::size_t r; (r = std::fread(tmpBuf, 1, sizeof(tmpBuf), file)) != 0;)
+        data.insert(data.end(), tmpBuf, tmpBuf + r);
+
+    std::fclose(file);
+
+    if (data.size() < 12 || std::memcmp(&data[0], "RIFF", 4) != 0 || std::memcmp(&data[8], "WAVE", 4) != 0)
+    {
+        d_stderr("'%s' is not a WAV file", filename);
+        return false;
+    }
+
+    uint16_t format = 0, channels = 0, bitsPerSample = 0;
+    uint32_t sampleRate = 0;
+    const uint8_t* sampleData = nullptr;
+    uint32_t sampleDataSize = 0;
+
+    for (std::size_t pos = 12; pos + 8 <= data.size();)
+    {
+        const uint8_t* const chunk = &data[pos];
+        const uint32_t chunkSize = std::min<uint32_t>(readLE32(chunk + 4), data.size() - pos - 8);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16)
+        {
+            format        = readLE16(chunk + 8);
+            channels      = readLE16(chunk + 10);
+            sampleRate    = readLE32(chunk + 12);
+            bitsPerSample = readLE16(chunk + 22);
+
+            // WAVE_FORMAT_EXTENSIBLE, real format is in the sub-format GUID
+            if (format == 0xfffe && chunkSize >= 26)
+                format = readLE16(chunk + 32);
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0)
+        {
+            sampleData     = chunk + 8;
+            sampleDataSize = chunkSize;
+        }
+
+        pos += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if (channels == 0 || sampleRate == 0 || sampleData == nullptr)
+    {
+        d_stderr("'%s' has no usable audio data", filename);
+        return false;
+    }
+
+    const bool isFloat = (format == 3);
+    const uint32_t bytesPerSample = bitsPerSample / 8;
+
+    if (! ((format == 1 && (bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32)) ||
+           (isFloat && (bitsPerSample == 32 || bitsPerSample == 64))))
+    {
+        d_stderr("'%s' uses an unsupported sample format (format %u, %u bits)", filename, format, bitsPerSample);
+        return false;
+    }
+
+    audio.sampleRate = sampleRate;
+    audio.alloc(channels, sampleDataSize / (bytesPerSample * channels));
+
+    const uint8_t* src = sampleData;
+
+    for (uint32_t i=0; i < audio.frames; ++i)
+    {
+        for (uint32_t c=0; c < channels; ++c, src += bytesPerSample)
+        {
+            float value;
+
+            if (isFloat && bitsPerSample == 32)
+            {
+                const uint32_t bits = readLE32(src);
+                std::memcpy(&value, &bits, sizeof(float));
+            }
+            else if (isFloat)
+            {
+                const uint64_t bits = static_cast<uint64_t>(readLE32(src)) | (static_cast<uint64_t>(readLE32(src + 4)) << 32);
+                double dvalue;
+                std::memcpy(&dvalue, &bits, sizeof(double));
+                value = static_cast<float>(dvalue);
+            }
+            else if (bitsPerSample == 16)
+            {
+                value = static_cast<float>(static_cast<int16_t>(readLE16(src))) / 32768.0f;
+            }
+            else if (bitsPerSample == 24)
+            {
+                const int32_t ivalue = static_cast<int32_t>((src[0] << 8) | (src[1] << 16) | (src[2] << 24)) >> 8;
+                value = static_cast<float>(ivalue) / 8388608.0f;
+            }
+            else
+            {
+                value = static_cast<float>(static_cast<int32_t>(readLE32(src)) / 2147483648.0);
+            }
+
+            audio.channel(c)[i] = value;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Read interleaved native-endian 32-bit float data.
+ */
+static bool readRawFile(const char* const filename, const uint32_t channels, AudioData& audio)
+{
+    DISTRHO_SAFE_ASSERT_RETURN(channels > 0, false);
+
+    std::FILE* const file = std::fopen(filename, "rb");
+
+    if (file == nullptr)
+    {
+        d_stderr("Failed to open '%s' for reading", filename);
+        return false;
+    }
+
+    std::vector<float> interleaved;
+    float tmpBuf[4096];
+
+    for (std::size_t r; (r = std::fread(tmpBuf, sizeof(float), 4096, file)) != 0;)
+        interleaved.insert(interleaved.end(), tmpBuf, tmpBuf + r);
+
+    std::fclose(file);
+
+    audio.alloc(channels, interleaved.size() / channels);
+
+    for (uint32_t i=0; i < audio.frames; ++i)
+        for (uint32_t c=0; c < channels; ++c)
+            audio.channel(c)[i] = interleaved[i*channels + c];
+
+    return true;
+}
+
+/*
+ * Streaming output file, 32-bit float WAV or raw interleaved data.
+ */
+class OutputFile
+{
+public:
+    OutputFile() noexcept
+        : fFile(nullptr),
+          fIsWav(false),
+          fChannels(0),
+          fFrames(0),
+          fInterleaved() {}
+
+    ~OutputFile()
+    {
+        close();
+    }
+
+    bool open(const char* const filename, const uint32_t channels, const double sampleRate, const bool raw)
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(fFile == nullptr, false);
+
+        fFile = std::fopen(filename, "wb");
+
+        if (fFile == nullptr)
+        {
+            d_stderr("Failed to open '%s' for writing", filename);
+            return false;
+        }
+
+        fIsWav    = ! raw;
+        fChannels = channels;
+        fFrames   = 0;
+
+        if (fIsWav)
+            writeWavHeader(static_cast<uint32_t>(sampleRate + 0.5));
+
+        return true;
+    }
+
+    void write(float* const* const buffers, const uint32_t frames)
+    {
+        if (fFile == nullptr || fChannels == 0)
+            return;
+
+        fInterleaved.resize(static_cast<std::size_t>(frames) * fChannels);
+
+        for (uint32_t i=0; i < frames; ++i)
+            for (uint32_t c=0; c < fChannels; ++c)
+                fInterleaved[i*fChannels + c] = buffers[c][i];
+
+        std::fwrite(&fInterleaved[0], sizeof(float), fInterleaved.size(), fFile);
+        fFrames += frames;
+    }
+
+    void close()
+    {
+        if (fFile == nullptr)
+            return;
+
+        if (fIsWav)
+        {
+            // now that the size is known, fill in the header
+            std::fseek(fFile, 4, SEEK_SET);
+            writeLE32(fFile, 36 + fFrames * fChannels * 4);
+            std::fseek(fFile, 40, SEEK_SET);
+            writeLE32(fFile, fFrames * fChannels * 4);
+        }
+
+        std::fclose(fFile);
+        fFile = nullptr;
+    }
+
+private:
+    std::FILE* fFile;
+    bool       fIsWav;
+    uint32_t   fChannels;
+    uint32_t   fFrames;
+    std::vector<float> fInterleaved;
+
+    void writeWavHeader(const uint32_t sampleRate)
+    {
+        std::fwrite("RIFF", 1, 4, fFile);
+        writeLE32(fFile, 36);
+        std::fwrite("WAVEfmt ", 1, 8, fFile);
+        writeLE32(fFile, 16);
+        writeLE16(fFile, 3); // IEEE float
+        writeLE16(fFile, static_cast<uint16_t>(fChannels));
+        writeLE32(fFile, sampleRate);
+        writeLE32(fFile, sampleRate * fChannels * 4);
+        writeLE16(fFile, static_cast<uint16_t>(fChannels * 4));
+        writeLE16(fFile, 32);
+        std::fwrite("data", 1, 4, fFile);
+        writeLE32(fFile, 0);
+    }
+
+    DISTRHO_DECLARE_NON_COPY_CLASS(OutputFile)
+};
+
+// -----------------------------------------------------------------------
+// Signal generators
+
+enum SignalType {
+    kSignalNone,
+    kSignalSilence,
+    kSignalNoise,
+    kSignalSine,
+    kSignalImpulse
+};
+
+static void generateSignal(const SignalType type, const uint32_t channels, const uint32_t frames,
+                           const double sampleRate, AudioData& audio)
+{
+    audio.sampleRate = sampleRate;
+    audio.alloc(channels, frames);
+
+    switch (type)
+    {
+    case kSignalNone:
+    case kSignalSilence:
+        break;
+
+    case kSignalNoise:
+    {
+        // fixed seed, so runs are reproducible
+        uint32_t seed = 0x12345678;
+
+        for (uint32_t c=0; c < channels; ++c)
+        {
+            float* const buf = audio.channel(c);
+
+            for (uint32_t i=0; i < frames; ++i)
+            {
+                seed = seed * 1664525U + 1013904223U;
+                buf[i] = (static_cast<float>(seed >> 8) / 8388608.0f - 1.0f) * 0.5f;
+            }
+        }
+        break;
+    }
+
+    case kSignalSine:
+    {
+        const double step = 2.0 * M_PI * 440.0 / sampleRate;
+
+        for (uint32_t c=0; c < channels; ++c)
+        {
+            float* const buf = audio.channel(c);
+
+            for (uint32_t i=0; i < frames; ++i)
+                buf[i] = static_cast<float>(std::sin(step * i) * 0.5);
+        }
+        break;
+    }
+
+    case kSignalImpulse:
+        if (frames != 0)
+        {
+            for (uint32_t c=0; c < channels; ++c)
+                audio.channel(c)[0] = 1.0f;
+        }
+        break;
+    }
+}
+
+// -----------------------------------------------------------------------
+// Automation script
+
+struct ScriptEvent {
+    enum Type {
+        kTypeParameter,
+        kTypeProgram,
+        kTypeState,
+        kTypeMidi
+    };
+
+    uint64_t frame;
+    Type     type;
+    uint32_t index;
+    float    value;
+    String   key;
+    String   stateValue;
+    uint8_t  midiSize;
+    uint8_t  midiData[MidiEvent::kDataSize];
+
+    ScriptEvent() noexcept
+        : frame(0),
+          type(kTypeParameter),
+          index(0),
+          value(0.0f),
+          key(),
+          stateValue(),
+          midiSize(0) {}
+
+    bool operator<(const ScriptEvent& other) const noexcept
+    {
+        return frame < other.frame;
+    }
+};
+
+static bool parseScriptTime(const char* const str, const double sampleRate, uint64_t& frame)
+{
+    // seconds end with 's', anything else must be a plain number
+    std::size_t len = std::strlen(str);
+    const bool seconds = (len != 0 && str[len-1] == 's');
+
+    if (seconds)
+        --len;
+
+    if (len == 0 || len >= 64 || std::strspn(str, "0123456789.eE+-") != len)
+        return false;
+
+    char strBuf[64];
+    std::memcpy(strBuf, str, len);
+    strBuf[len] = '\0';
+
+    // d_str2double always uses '.', scripts must not depend on the locale
+    const double value = d_str2double(strBuf);
+
+    if (value < 0.0)
+        return false;
+
+    if (seconds)
+        frame = static_cast<uint64_t>(value * sampleRate + 0.5);
+    else
+        frame = static_cast<uint64_t>(value);
+
+    return true;
+}
+
+static bool parseScriptByte(const char* const str, uint8_t& byte)
+{
+    char* end = nullptr;
+    const long value = std::strtol(str, &end, 0);
+
+    if (end == str || *end != '\0' || value < 0 || value > 0xff)
+        return false;
+
+    byte = static_cast<uint8_t>(value);
+    return true;
+}
+
+static bool readScriptFile(const char* const filename, const PluginExporter& plugin, const double sampleRate,
+                           std::vector<ScriptEvent>& events)
+{
+    std::FILE* const file = std::fopen(filename, "r");
+
+    if (file == nullptr)
+    {
+        d_stderr("Failed to open script '%s'", filename);
+        return false;
+    }
+
+    char line[1024];
+    bool ok = true;
+
+    for (uint lineNumber = 1; std::fgets(line, sizeof(line), file) != nullptr; ++lineNumber)
+    {
+        if (char* const comment = std::strchr(line, '#'))
+            *comment = '\0';
+
+        // split line into words
+        char* words[8];
+        uint wordCount = 0;
+
+        for (char* word = std::strtok(line, " \t\r\n"); word != nullptr && wordCount < 8; word = std::strtok(nullptr, " \t\r\n"))
+            words[wordCount++] = word;
+
+        if (wordCount == 0)
+            continue;
+
+        ScriptEvent event;
+        bool valid = wordCount >= 3 && parseScriptTime(words[0], sampleRate, event.frame);
+        const char* const command = wordCount >= 2 ? words[1] : "";
+
+        if (! valid)
+        {
+            // handled below
+        }
+        else if (std::strcmp(command, "param") == 0 && wordCount == 4)
+        {
+            event.type  = ScriptEvent::kTypeParameter;
+            event.value = d_str2float(words[3]);
+            valid = false;
+
+            for (uint32_t i=0, count=plugin.getParameterCount(); i < count; ++i)
+            {
+                if (plugin.getParameterSymbol(i) == words[2] || String(i) == words[2])
+                {
+                    valid = plugin.isParameterInput(i);
+                    event.index = i;
+                    break;
+                }
+            }
+        }
+        else if (std::strcmp(command, "program") == 0 && wordCount == 3)
+        {
+#if DISTRHO_PLUGIN_WANT_PROGRAMS
+            event.type  = ScriptEvent::kTypeProgram;
+            event.index = static_cast<uint32_t>(std::atoi(words[2]));
+            valid = event.index < plugin.getProgramCount();
+#else
+            valid = false;
+#endif
+        }
+        else if (std::strcmp(command, "state") == 0 && wordCount == 4)
+        {
+#if DISTRHO_PLUGIN_WANT_STATE
+            event.type       = ScriptEvent::kTypeState;
+            event.key        = words[2];
+            event.stateValue = words[3];
+            valid = plugin.wantStateKey(words[2]);
+#else
+            valid = false;
+#endif
+        }
+        else if (std::strcmp(command, "note-on") == 0 && wordCount == 5)
+        {
+            uint8_t channel, note, velocity;
+            valid = parseScriptByte(words[2], channel) && channel >= 1 && channel <= 16
+                 && parseScriptByte(words[3], note) && note < 128
+                 && parseScriptByte(words[4], velocity) && velocity < 128;
+            event.type        = ScriptEvent::kTypeMidi;
+            event.midiSize    = 3;
+            event.midiData[0] = static_cast<uint8_t>(0x90 | (channel - 1));
+            event.midiData[1] = note;
+            event.midiData[2] = velocity;
+        }
+        else if (std::strcmp(command, "note-off") == 0 && wordCount == 4)
+        {
+            uint8_t channel, note;
+            valid = parseScriptByte(words[2], channel) && channel >= 1 && channel <= 16
+                 && parseScriptByte(words[3], note) && note < 128;
+            event.type        = ScriptEvent::kTypeMidi;
+            event.midiSize    = 3;
+            event.midiData[0] = static_cast<uint8_t>(0x80 | (channel - 1));
+            event.midiData[1] = note;
+            event.midiData[2] = 0;
+        }
+        else if (std::strcmp(command, "cc") == 0 && wordCount == 5)
+        {
+            uint8_t channel, control, value;
+            valid = parseScriptByte(words[2], channel) && channel >= 1 && channel <= 16
+                 && parseScriptByte(words[3], control) && control < 128
+                 && parseScriptByte(words[4], value) && value < 128;
+            event.type        = ScriptEvent::kTypeMidi;
+            event.midiSize    = 3;
+            event.midiData[0] = static_cast<uint8_t>(0xB0 | (channel - 1));
+            event.midiData[1] = control;
+            event.midiData[2] = value;
+        }
+        else if (std::strcmp(command, "midi") == 0 && wordCount >= 3 && wordCount - 2 <= MidiEvent::kDataSize)
+        {
+            event.type     = ScriptEvent::kTypeMidi;
+            event.midiSize = static_cast<uint8_t>(wordCount - 2);
+
+            for (uint i=2; i < wordCount && valid; ++i)
+                valid = parseScriptByte(words[i], event.midiData[i-2]);
+        }
+        else
+        {
+            valid = false;
+        }
+
+        if (! valid)
+        {
+            d_stderr("%s:%u: invalid script event", filename, lineNumber);
+            ok = false;
+            continue;
+        }
+
+#if ! DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        if (event.type == ScriptEvent::kTypeMidi)
+        {
+            d_stderr("%s:%u: plugin does not use MIDI input, event ignored", filename, lineNumber);
+            continue;
+        }
+#endif
+
+        events.push_back(event);
+    }
+
+    std::fclose(file);
+
+    // keep file order for events on the same frame
+    std::stable_sort(events.begin(), events.end());
+
+    return ok;
+}
+
+// -----------------------------------------------------------------------
+// Run options
+
+struct OfflineOptions {
+    const char* inputFile;
+    const char* outputFile;
+    const char* scriptFile;
+    const char* timingsFile;
+    SignalType  signal;
+    bool        rawInput;
+    bool        rawOutput;
+    bool        quiet;
+    bool        pinThreads;
+    int         threadPriority;
+    uint32_t    bufferSize;
+    uint32_t    instances;
+    uint32_t    threads;
+    double      sampleRate;
+    double      duration;
+    double      beatsPerMinute;
+
+    OfflineOptions() noexcept
+        : inputFile(nullptr),
+          outputFile(nullptr),
+          scriptFile(nullptr),
+          timingsFile(nullptr),
+          signal(kSignalNone),
+          rawInput(false),
+          rawOutput(false),
+          quiet(false),
+          pinThreads(false),
+          threadPriority(-1),
+          bufferSize(512),
+          instances(1),
+          threads(1),
+          sampleRate(0.0),
+          duration(10.0),
+          beatsPerMinute(120.0) {}
+};
+
+// -----------------------------------------------------------------------
+
+class PluginOffline
+{
+public:
+    PluginOffline(const OfflineOptions& options, const AudioData& input, const std::vector<ScriptEvent>& events)
+        : fPlugin(this, writeMidiCallback),
+          fOptions(options),
+          fInput(input),
+          fEvents(events),
+          fOffset(0),
+          fNextEvent(0),
+          fMidiOutputCount(0),
+#if DISTRHO_PLUGIN_NUM_INPUTS > 0
+          fSilence(options.bufferSize, 0.0f),
+#endif
+#if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+          fOutputBuffer(static_cast<std::size_t>(options.bufferSize) * DISTRHO_PLUGIN_NUM_OUTPUTS, 0.0f),
+#endif
+          fBlockTimes()
+    {
+#if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_OUTPUTS; ++i)
+            fAudioOuts[i] = &fOutputBuffer[static_cast<std::size_t>(i) * options.bufferSize];
+#endif
+        fBlockTimes.reserve((input.frames + options.bufferSize - 1) / options.bufferSize);
+    }
+
+    void start()
+    {
+        fOffset    = 0;
+        fNextEvent = 0;
+        fBlockTimes.clear();
+        fPlugin.activate();
+    }
+
+    void stop()
+    {
+        fPlugin.deactivate();
+    }
+
+    // process the next block, returns false when the end of the input has been reached
+    bool processNextBlock(OutputFile* const outputFile)
+    {
+        const uint32_t offset = fOffset;
+
+        if (offset >= fInput.frames)
+            return false;
+
+        const uint32_t frames = std::min(fOptions.bufferSize, fInput.frames - offset);
+
+#if DISTRHO_PLUGIN_NUM_INPUTS > 0
+        const float* audioIns[DISTRHO_PLUGIN_NUM_INPUTS];
+
+        for (uint32_t i=0; i < DISTRHO_PLUGIN_NUM_INPUTS; ++i)
+            audioIns[i] = fInput.channels != 0 ? fInput.channel(i % fInput.channels) + offset : &fSilence[0];
+#else
+        static const float** audioIns = nullptr;
+#endif
+#if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        float** const audioOuts = fAudioOuts;
+#else
+        static float** audioOuts = nullptr;
+#endif
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        uint32_t midiEventCount = 0;
+#endif
+
+        for (; fNextEvent < fEvents.size() && fEvents[fNextEvent].frame < offset + frames; ++fNextEvent)
+        {
+            const ScriptEvent& event(fEvents[fNextEvent]);
+
+            switch (event.type)
+            {
+            case ScriptEvent::kTypeParameter:
+                fPlugin.setParameterValue(event.index, event.value);
+                break;
+            case ScriptEvent::kTypeProgram:
+#if DISTRHO_PLUGIN_WANT_PROGRAMS
+                fPlugin.loadProgram(event.index);
+#endif
+                break;
+            case ScriptEvent::kTypeState:
+#if DISTRHO_PLUGIN_WANT_STATE
+                fPlugin.setState(event.key, event.stateValue);
+#endif
+                break;
+            case ScriptEvent::kTypeMidi:
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+                if (midiEventCount < kMaxMidiEvents)
+                {
+                    MidiEvent& midiEvent(fMidiEvents[midiEventCount++]);
+                    midiEvent.frame   = event.frame > offset ? static_cast<uint32_t>(event.frame - offset) : 0;
+                    midiEvent.size    = event.midiSize;
+                    midiEvent.dataExt = nullptr;
+                    std::memcpy(midiEvent.data, event.midiData, MidiEvent::kDataSize);
+                }
+#endif
+                break;
+            }
+        }
+
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+        updateTimePosition(offset);
+#endif
+
+        const double startTime = getTimeInSeconds();
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+        fPlugin.run(audioIns, audioOuts, frames, fMidiEvents, midiEventCount);
+#else
+        fPlugin.run(audioIns, audioOuts, frames);
+#endif
+        fBlockTimes.push_back(getTimeInSeconds() - startTime);
+
+        updateParameterTriggers();
+
+#if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+        if (outputFile != nullptr)
+            outputFile->write(audioOuts, frames);
+#else
+        // unused
+        (void)outputFile;
+#endif
+
+        fOffset += frames;
+        return true;
+    }
+
+    const std::vector<double>& getBlockTimes() const noexcept
+    {
+        return fBlockTimes;
+    }
+
+    void printOutputs() const
+    {
+#if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
+        d_stdout("MIDI output:     %lu events", static_cast<ulong>(fMidiOutputCount));
+#endif
+
+        for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
+        {
+            if (fPlugin.isParameterOutput(i))
+                d_stdout("Output '%s':    %f", fPlugin.getParameterSymbol(i).buffer(), fPlugin.getParameterValue(i));
+        }
+    }
+
+protected:
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+    // simulate a rolling transport at a fixed tempo and 4/4 signature
+    void updateTimePosition(const uint64_t frame)
+    {
+        fTimePosition.playing = true;
+        fTimePosition.frame   = frame;
+
+        TimePosition::BarBeatTick& bbt(fTimePosition.bbt);
+        bbt.valid          = true;
+        bbt.beatsPerBar    = 4.0f;
+        bbt.beatType       = 4.0f;
+        bbt.ticksPerBeat   = 1920.0;
+        bbt.beatsPerMinute = fOptions.beatsPerMinute;
+
+        const double beats = static_cast<double>(frame) * bbt.beatsPerMinute / (60.0 * fPlugin.getSampleRate());
+        const int64_t wholeBeats = static_cast<int64_t>(beats);
+
+        bbt.bar  = static_cast<int32_t>(wholeBeats / 4) + 1;
+        bbt.beat = static_cast<int32_t>(wholeBeats % 4) + 1;
+        bbt.tick = static_cast<int32_t>((beats - static_cast<double>(wholeBeats)) * bbt.ticksPerBeat);
+        bbt.barStartTick = bbt.ticksPerBeat * bbt.beatsPerBar * (bbt.bar - 1);
+
+        fPlugin.setTimePosition(fTimePosition);
+    }
+#endif
+
+    // NOTE: no trigger support in offline mode, simulate it here
+    void updateParameterTriggers()
+    {
+        for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
+        {
+            if ((fPlugin.getParameterHints(i) & kParameterIsTrigger) != kParameterIsTrigger)
+                continue;
+
+            const float defValue = fPlugin.getParameterRanges(i).def;
+
+            if (d_isNotEqual(defValue, fPlugin.getParameterValue(i)))
+                fPlugin.setParameterValue(i, defValue);
+        }
+    }
+
+#if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
+    bool writeMidi(const MidiEvent&)
+    {
+        ++fMidiOutputCount;
+        return true;
+    }
+#endif
+
+private:
+    PluginExporter fPlugin;
+    const OfflineOptions& fOptions;
+    const AudioData& fInput;
+    const std::vector<ScriptEvent>& fEvents;
+
+    uint32_t    fOffset;
+    std::size_t fNextEvent;
+    std::size_t fMidiOutputCount;
+
+#if DISTRHO_PLUGIN_NUM_INPUTS > 0
+    std::vector<float> fSilence;
+#endif
+#if DISTRHO_PLUGIN_NUM_OUTPUTS > 0
+    std::vector<float> fOutputBuffer;
+    float* fAudioOuts[DISTRHO_PLUGIN_NUM_OUTPUTS];
+#endif
+#if DISTRHO_PLUGIN_WANT_MIDI_INPUT
+    MidiEvent fMidiEvents[kMaxMidiEvents];
+#endif
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+    TimePosition fTimePosition;
+#endif
+    std::vector<double> fBlockTimes;
+
+    // -------------------------------------------------------------------
+    // Callbacks
+
+#if DISTRHO_PLUGIN_WANT_MIDI_OUTPUT
+    static bool writeMidiCallback(void* ptr, const MidiEvent& midiEvent)
+    {
+        return ((PluginOffline*)ptr)->writeMidi(midiEvent);
+    }
+#endif
+
+    DISTRHO_DECLARE_NON_COPY_CLASS(PluginOffline)
+};
+
+// -----------------------------------------------------------------------
+// Multi-instance worker
+
+/*
+ * Owns a subset of the plugin instances and processes them one after the other, block by block,
+ * the same way a host would schedule several plugins on one audio thread.
+ * Instances are created on the worker thread in a first pass, processing happens in a second pass.
+ */
+class OfflineWorker : public Thread
+{
+public:
+    OfflineWorker(const OfflineOptions& options, const AudioData& input, const std::vector<ScriptEvent>& events,
+                  const uint32_t instanceCount)
+        : Thread("offline-worker"),
+          fOptions(options),
+          fInput(input),
+          fEvents(events),
+          fInstanceCount(instanceCount),
+          fInstances(),
+          fCycleTimes(),
+          fCreationTime(0.0),
+          fProcessing(false)
+    {
+        setThreadPriority(options.threadPriority);
+    }
+
+    ~OfflineWorker() override
+    {
+        for (std::size_t i=0; i < fInstances.size(); ++i)
+            delete fInstances[i];
+    }
+
+    void startProcessing()
+    {
+        fProcessing = true;
+        startThread();
+    }
+
+    void waitForFinish()
+    {
+        stopThread(-1);
+    }
+
+    void collectBlockTimes(std::vector<double>& blockTimes) const
+    {
+        for (std::size_t i=0; i < fInstances.size(); ++i)
+        {
+            const std::vector<double>& instanceTimes(fInstances[i]->getBlockTimes());
+            blockTimes.insert(blockTimes.end(), instanceTimes.begin(), instanceTimes.end());
+        }
+    }
+
+    const std::vector<double>& getCycleTimes() const noexcept
+    {
+        return fCycleTimes;
+    }
+
+    double getCreationTime() const noexcept
+    {
+        return fCreationTime;
+    }
+
+protected:
+    void run() override
+    {
+        if (fProcessing)
+            process();
+        else
+            create();
+    }
+
+private:
+    const OfflineOptions& fOptions;
+    const AudioData& fInput;
+    const std::vector<ScriptEvent>& fEvents;
+    const uint32_t fInstanceCount;
+
+    std::vector<PluginOffline*> fInstances;
+    std::vector<double> fCycleTimes;
+    double fCreationTime;
+    bool   fProcessing;
+
+    void create()
+    {
+        const double startTime = getTimeInSeconds();
+
+        d_lastBufferSize = fOptions.bufferSize;
+        d_lastSampleRate = fOptions.sampleRate;
+
+        for (uint32_t i=0; i < fInstanceCount; ++i)
+            fInstances.push_back(new PluginOffline(fOptions, fInput, fEvents));
+
+        d_lastBufferSize = 0;
+        d_lastSampleRate = 0.0;
+
+        fCreationTime = getTimeInSeconds() - startTime;
+    }
+
+    void process()
+    {
+        fCycleTimes.reserve((fInput.frames + fOptions.bufferSize - 1) / fOptions.bufferSize);
+
+        for (std::size_t i=0; i < fInstances.size(); ++i)
+            fInstances[i]->start();
+
+        for (bool running = true; running;)
+        {
+            const double startTime = getTimeInSeconds();
+
+            running = false;
+
+            for (std::size_t i=0; i < fInstances.size(); ++i)
+                running |= fInstances[i]->processNextBlock(nullptr);
+
+            if (running)
+                fCycleTimes.push_back(getTimeInSeconds() - startTime);
+        }
+
+        for (std::size_t i=0; i < fInstances.size(); ++i)
+            fInstances[i]->stop();
+    }
+
+    DISTRHO_DECLARE_NON_COPY_CLASS(OfflineWorker)
+};
+
+// -----------------------------------------------------------------------
+// Report
+
+static void writeTimings(const char* const filename, const std::vector<double>& blockTimes)
+{
+    std::FILE* const file = std::fopen(filename, "w");
+
+    if (file == nullptr)
+    {
+        d_stderr("Failed to open '%s' for writing", filename);
+        return;
+    }
+
+    std::fprintf(file, "block,microseconds\n");
+
+    for (std::size_t i=0; i < blockTimes.size(); ++i)
+        std::fprintf(file, "%lu,%.3f\n", static_cast<ulong>(i), blockTimes[i] * 1e6);
+
+    std::fclose(file);
+}
+
+static void printTimeStats(const char* const label, std::vector<double> times, const double budget)
+{
+    if (times.empty())
+        return;
+
+    double total = 0.0;
+
+    for (std::size_t i=0; i < times.size(); ++i)
+        total += times[i];
+
+    std::sort(times.begin(), times.end());
+
+    const std::size_t last = times.size() - 1;
+
+    d_stdout("%s min %.2f, avg %.2f, median %.2f, p99 %.2f, p99.9 %.2f, max %.2f", label,
+             times[0] * 1e6,
+             total / static_cast<double>(times.size()) * 1e6,
+             times[last / 2] * 1e6,
+             times[last * 99 / 100] * 1e6,
+             times[last * 999 / 1000] * 1e6,
+             times[last] * 1e6);
+    d_stdout("Block budget:    %.2f us, max usage %.1f%%", budget * 1e6, times[last] / budget * 100.0);
+}
+
+// -----------------------------------------------------------------------
+
+static void printUsage(const char* const name)
+{
+    d_stdout("Usage: %s [options]", name);
+    d_stdout("Renders " DISTRHO_PLUGIN_NAME " offline, without a host or audio hardware.");
+    d_stdout("");
+    d_stdout("  -i, --input FILE         WAV file to process");
+    d_stdout("      --raw-input FILE     raw interleaved 32-bit float file to process");
+    d_stdout("  -g, --generate TYPE      generate input: silence, noise, sine or impulse");
+    d_stdout("  -o, --output FILE        write 32-bit float WAV output");
+    d_stdout("      --raw-output FILE    write raw interleaved 32-bit float output");
+    d_stdout("  -s, --script FILE        replay parameter/program/state/MIDI script");
+    d_stdout("  -b, --buffer-size N      frames per run() call (default 512)");
+    d_stdout("  -r, --sample-rate N      sample rate (default: input file rate or 48000)");
+    d_stdout("  -d, --duration SECONDS   length of generated input (default 10)");
+    d_stdout("      --bpm N              transport tempo (default 120)");
+    d_stdout("      --timings FILE       write per-block processing times as CSV");
+    d_stdout("  -n, --instances N        number of plugin instances to run (default 1)");
+    d_stdout("  -t, --threads N          number of worker threads for multiple instances (default 1)");
+    d_stdout("      --pin-threads        pin each worker thread to its own CPU (Linux only)");
+    d_stdout("      --rt-priority N      run worker threads with SCHED_FIFO priority N");
+    d_stdout("  -q, --quiet              do not print the report");
+    d_stdout("  -h, --help               show this help");
+}
+
+static uint getNumberOfCPUs()
+{
+#ifdef DISTRHO_OS_WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return std::max(static_cast<uint>(info.dwNumberOfProcessors), 1U);
+#else
+    const long numCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+    return numCPUs > 0 ? static_cast<uint>(numCPUs) : 1U;
+#endif
+}
+
+static bool parseOptions(const int argc, char* argv[], OfflineOptions& options)
+{
+    for (int i=1; i < argc; ++i)
+    {
+        const char* const arg = argv[i];
+        const char* const next = (i+1 < argc) ? argv[i+1] : nullptr;
+
+#define DISTRHO_OFFLINE_OPT(s, l) (std::strcmp(arg, s) == 0 || std::strcmp(arg, l) == 0)
+#define DISTRHO_OFFLINE_NEEDS_ARG if (next == nullptr) { d_stderr("Option '%s' needs an argument", arg); return false; } ++i;
+
+        if (DISTRHO_OFFLINE_OPT("-h", "--help"))
+        {
+            printUsage(argv[0]);
+            std::exit(0);
+        }
+        else if (DISTRHO_OFFLINE_OPT("-q", "--quiet"))
+        {
+            options.quiet = true;
+        }
+        else if (DISTRHO_OFFLINE_OPT("-i", "--input"))
+        {
+            DISTRHO_OFFLINE_NEEDS_ARG
+            options.inputFile = next;
+            options.rawInput  = false;
+        }
+        else if (std::strcmp(arg, "--raw-input") == 0)
+        {
+            DISTRHO_OFFLINE_NEEDS_ARG
+            options.inputFile = next;
+            options.rawInput  = true;
+        }
+        else if (DISTRHO_OFFLINE_OPT("-o", "--output"))
+        {
+            DISTRHO_OFFLINE_NEEDS_ARG
+            options.outputFile = next;
+            options.rawOutput  = false;
+        }
+        else if (std::strcmp(arg, "--raw-output") == 0)
+        {
+            DISTRHO_OFFLINE_NEEDS_ARG
+            options.outputFile = next;
+            options.rawOutput  = true;
+        }
+        else if (DISTRHO_OFFLINE_OPT("-g", "--generate"))
+        {
+            DISTRHO_OFFLINE_NEEDS_ARG
+            /**/ if (std::strcmp(next, "silence") == 0)
+                options.signal = kSignalSilence;
+            else if (std::strcmp(next, "noise") == 0)
+                options.signal = kSignalNoise;
+            else if (std::strcmp(next, "sine") == 0)
+                options.signal = kSignalSine;
+            else if (std::strcmp(next, "impulse") == 0)
+                options.signal = kSignalImpulse;
+            else
+            {
+                d_stderr("Unknown signal type '%s'", next);
+                return false;
+            }
+        }
+        else if (DISTRHO_OFFLINE_OPT("-s", "--script"))
+        {
+            DISTRHO_OFFLINE_NEEDS_ARG
+            options.scriptFile = next;
+        }
+        else if (DISTRHO_OFFLINE_OPT("-b", "--buffer-size"))
+        {
+            DISTRHO_OFFLINE_NEEDS_ARG
+            const int bufferSize = std::atoi(next);
+
+            if (bufferSize < 1)
+            {
+                d_stderr("Invalid buffer size '%s'", next);
+                return false;
+            }
+
+            options.bufferSize = static_cast<uint32_t>(bufferSize);
+        }
+        else if (DISTRHO_OFFLINE_OPT("-r", "--sample-rate"))
+        {
+            DISTRHO_OFFLINE_NEEDS_ARG
+            options.sampleRate = d_str2double(next);
+
+            if (options.sampleRate <= 0.0)
+            {
+                d_stderr("Invalid sample rate '%s'", next);
+                return false;
+            }
+        }
+        else if (DISTRHO_OFFLINE_OPT("-d", "--duration"))
+        {
+            DISTRHO_OFFLINE_NEEDS_ARG
+            options.duration = d_str2double(next);
+
+            if (options.duration <= 0.0)
+            {
+                d_stderr("Invalid duration '%s'", next);
+                return false;
+            }
+        }
+        else if (std::strcmp(arg, "--bpm") == 0)
+        {
+            DISTRHO_OFFLINE_NEEDS_ARG
+            options.beatsPerMinute = d_str2double(next);
+
+            if (options.beatsPerMinute <= 0.0)
+            {
+                d_stderr("Invalid tempo '%s'", next);
+                return false;
+            }
+        }
+        else if (DISTRHO_OFFLINE_OPT("-n", "--instances"))
+        {
+            DISTRHO_OFFLINE_NEEDS_ARG
+            const int instances = std::atoi(next);
+
+            if (instances < 1)
+            {
+                d_stderr("Invalid instance count '%s'", next);
+                return false;
+            }
+
+            options.instances = static_cast<uint32_t>(instances);
+        }
+        else if (DISTRHO_OFFLINE_OPT("-t", "--threads"))
+        {
+            DISTRHO_OFFLINE_NEEDS_ARG
+            const int threads = std::atoi(next);
+
+            if (threads < 1)
+            {
+                d_stderr("Invalid thread count '%s'", next);
+                return false;
+            }
+
+            options.threads = static_cast<uint32_t>(threads);
+        }
+        else if (std::strcmp(arg, "--pin-threads") == 0)
+        {
+            options.pinThreads = true;
+        }
+        else if (std::strcmp(arg, "--rt-priority") == 0)
+        {
+            DISTRHO_OFFLINE_NEEDS_ARG
+            options.threadPriority = std::atoi(next);
+
+            if (options.threadPriority < 1)
+            {
+                d_stderr("Invalid realtime priority '%s'", next);
+                return false;
+            }
+        }
+        else if (std::strcmp(arg, "--timings") == 0)
+        {
+            DISTRHO_OFFLINE_NEEDS_ARG
+            options.timingsFile = next;
+        }
+        else
+        {
+            d_stderr("Unknown option '%s', see --help", arg);
+            return false;
+        }
+
+#undef DISTRHO_OFFLINE_OPT
+#undef DISTRHO_OFFLINE_NEEDS_ARG
+    }
+
+    if (options.inputFile != nullptr && options.signal != kSignalNone)
+    {
+        d_stderr("Cannot use an input file and a generated signal at the same time");
+        return false;
+    }
+
+    if (options.threads > options.instances)
+        options.threads = options.instances;
+
+    if (options.outputFile != nullptr && options.instances > 1)
+    {
+        d_stderr("Cannot write output with multiple instances");
+        return false;
+    }
+
+    return true;
+}
+
+END_NAMESPACE_DISTRHO
+
+// -----------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    USE_NAMESPACE_DISTRHO;
+
+    OfflineOptions options;
+
+    if (! parseOptions(argc, argv, options))
+        return 1;
+
+    AudioData input;
+
+    if (options.inputFile != nullptr)
+    {
+        const bool ok = options.rawInput
+                      ? readRawFile(options.inputFile, std::max(DISTRHO_PLUGIN_NUM_INPUTS, 1), input)
+                      : readWavFile(options.inputFile, input);
+
+        if (! ok)
+            return 1;
+
+        if (d_isNotZero(options.sampleRate) && d_isNotZero(input.sampleRate) && d_isNotEqual(options.sampleRate, input.sampleRate))
+            d_stderr("Input sample rate is %g Hz, processing at %g Hz without resampling", input.sampleRate, options.sampleRate);
+
+        if (d_isZero(options.sampleRate))
+            options.sampleRate = d_isNotZero(input.sampleRate) ? input.sampleRate : 48000.0;
+    }
+    else
+    {
+        if (d_isZero(options.sampleRate))
+            options.sampleRate = 48000.0;
+
+        generateSignal(options.signal, DISTRHO_PLUGIN_NUM_INPUTS,
+                       static_cast<uint32_t>(options.duration * options.sampleRate + 0.5),
+                       options.sampleRate, input);
+    }
+
+    const double audioTime   = static_cast<double>(input.frames) / options.sampleRate;
+    const double blockBudget = static_cast<double>(options.bufferSize) / options.sampleRate;
+
+    std::vector<ScriptEvent> events;
+
+    if (options.scriptFile != nullptr)
+    {
+        // Dummy plugin to get data from
+        d_lastBufferSize = options.bufferSize;
+        d_lastSampleRate = options.sampleRate;
+        const PluginExporter plugin(nullptr, nullptr);
+        d_lastBufferSize = 0;
+        d_lastSampleRate = 0.0;
+
+        if (! readScriptFile(options.scriptFile, plugin, options.sampleRate, events))
+            return 1;
+    }
+
+    // single instance, processed on the main thread
+    if (options.instances == 1)
+    {
+        OutputFile outputFile;
+
+        if (options.outputFile != nullptr && ! outputFile.open(options.outputFile, DISTRHO_PLUGIN_NUM_OUTPUTS,
+                                                                options.sampleRate, options.rawOutput))
+            return 1;
+
+        d_lastBufferSize = options.bufferSize;
+        d_lastSampleRate = options.sampleRate;
+        PluginOffline offline(options, input, events);
+        d_lastBufferSize = 0;
+        d_lastSampleRate = 0.0;
+
+        offline.start();
+        while (offline.processNextBlock(&outputFile)) {}
+        offline.stop();
+
+        outputFile.close();
+
+        const std::vector<double>& blockTimes(offline.getBlockTimes());
+        double totalTime = 0.0;
+
+        for (std::size_t i=0; i < blockTimes.size(); ++i)
+            totalTime += blockTimes[i];
+
+        if (options.timingsFile != nullptr)
+            writeTimings(options.timingsFile, blockTimes);
+
+        if (options.quiet)
+            return 0;
+
+        d_stdout("Plugin:          %s", DISTRHO_PLUGIN_NAME);
+        d_stdout("Processed:       %u frames in %lu blocks of %u at %g Hz",
+                 input.frames, static_cast<ulong>(blockTimes.size()), options.bufferSize, options.sampleRate);
+        d_stdout("Audio time:      %.3f s", audioTime);
+        d_stdout("Processing time: %.6f s", totalTime);
+
+        if (totalTime > 0.0)
+            d_stdout("Realtime factor: %.2fx", audioTime / totalTime);
+
+        printTimeStats("Block time (us):", blockTimes, blockBudget);
+        offline.printOutputs();
+        d_printLeakDetectorStats();
+        return 0;
+    }
+
+    // multiple instances, spread over a pool of worker threads
+    std::vector<OfflineWorker*> workers;
+
+    for (uint32_t i=0; i < options.threads; ++i)
+    {
+        const uint32_t instanceCount = options.instances / options.threads + (i < options.instances % options.threads ? 1 : 0);
+        workers.push_back(new OfflineWorker(options, input, events, instanceCount));
+
+        if (options.pinThreads)
+            workers.back()->setThreadAffinity(static_cast<uint64_t>(1) << (i % std::min(getNumberOfCPUs(), 64U)));
+    }
+
+    const double creationStartTime = getTimeInSeconds();
+
+    for (std::size_t i=0; i < workers.size(); ++i)
+        workers[i]->startThread();
+    for (std::size_t i=0; i < workers.size(); ++i)
+        workers[i]->waitForFinish();
+
+    const double creationTime = getTimeInSeconds() - creationStartTime;
+    const double processStartTime = getTimeInSeconds();
+
+    for (std::size_t i=0; i < workers.size(); ++i)
+        workers[i]->startProcessing();
+    for (std::size_t i=0; i < workers.size(); ++i)
+        workers[i]->waitForFinish();
+
+    const double processTime = getTimeInSeconds() - processStartTime;
+
+    std::vector<double> blockTimes, cycleTimes;
+
+    for (std::size_t i=0; i < workers.size(); ++i)
+    {
+        workers[i]->collectBlockTimes(blockTimes);
+        cycleTimes.insert(cycleTimes.end(), workers[i]->getCycleTimes().begin(), workers[i]->getCycleTimes().end());
+    }
+
+    for (std::size_t i=0; i < workers.size(); ++i)
+        delete workers[i];
+
+    if (options.timingsFile != nullptr)
+        writeTimings(options.timingsFile, blockTimes);
+
+    if (options.quiet)
+        return 0;
+
+    d_stdout("Plugin:          %s", DISTRHO_PLUGIN_NAME);
+    d_stdout("Instances:       %u on %u threads, created in %.3f ms",
+             options.instances, options.threads, creationTime * 1e3);
+    d_stdout("Processed:       %u frames per instance in blocks of %u at %g Hz",
+             input.frames, options.bufferSize, options.sampleRate);
+    d_stdout("Audio time:      %.3f s per instance", audioTime);
+    d_stdout("Wall time:       %.6f s", processTime);
+
+    if (processTime > 0.0)
+    {
+        d_stdout("Throughput:      %.2f Mframes/s, %.2fx realtime aggregate",
+                 audioTime * options.sampleRate * options.instances / processTime * 1e-6,
+                 audioTime * options.instances / processTime);
+    }
+
+    printTimeStats("Block time (us):", blockTimes, blockBudget);
+    printTimeStats("Cycle time (us):", cycleTimes, blockBudget);
+    d_printLeakDetectorStats();
+    return 0;
+}
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,462 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef DISTRHO_PLUGIN_TRANSPORT_HPP_INCLUDED
+#define DISTRHO_PLUGIN_TRANSPORT_HPP_INCLUDED
+
+#include "../DistrhoPlugin.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+START_NAMESPACE_DISTRHO
+
+// -----------------------------------------------------------------------
+// Constants
+
+// host position changes kept per block, later ones replace the last segment
+static const uint32_t kMaxTimePositionSegments = 16;
+
+// ticks are kept with a 32 bit fixed-point fraction
+static const uint32_t kTickFractionBits = 32;
+static const double kTickFractionScale = 4294967296.0;
+
+// -----------------------------------------------------------------------
+// Plugin transport class
+
+/*
+ * Host transport shared by the plugin formats.
+ *
+ * Hosts report their position in different ways (LV2 time:Position objects, VST ppq positions, JACK BBT).
+ * Wrappers hand those values to this class when they change, which keeps them as integer bar, beat and tick
+ * plus a fixed-point tick fraction, and advances that from block to block with integer additions and carries.
+ *
+ * Positions reported in the middle of a block start a new segment, so plugins see tempo changes
+ * at the frame they happen. Usage per block:
+ *
+ *   startBlock();
+ *   // for each host position, at 'frame' within the block
+ *   startPositionChange(frame); setTempo(...); ...; finishPositionChange();
+ *   // run the plugin with getSegments()
+ *   finishBlock(frames);
+ */
+class PluginTransport
+{
+public:
+    PluginTransport() noexcept
+        : fSampleRate(44100.0),
+          fState(),
+          fSegmentStates(),
+          fSegments(),
+          fSegmentCount(1),
+          fTickIncrement(0),
+          fTickIncrementTicksPerFrame(0.0),
+          fLastPpq()
+    {
+        reset();
+    }
+
+    /*
+     * Go back to the default state: stopped at the first bar, 120 BPM in 4/4.
+     */
+    void reset() noexcept
+    {
+        fState = State();
+        fSegmentStates[0] = fState;
+        fSegmentCount = 1;
+        fLastPpq = PpqPosition();
+        updateTimePosition(fSegments[0], 0, fState);
+    }
+
+    void setSampleRate(const double sampleRate) noexcept
+    {
+        DISTRHO_SAFE_ASSERT_RETURN(sampleRate > 0.0,);
+
+        fSampleRate = sampleRate;
+    }
+
+    // -------------------------------------------------------------------
+    // Blocks
+
+    /*
+     * Start a new block, the position continues from the end of the previous one.
+     */
+    void startBlock() noexcept
+    {
+        fSegmentStates[0] = fState;
+        fSegmentCount = 1;
+        updateTimePosition(fSegments[0], 0, fState);
+    }
+
+    /*
+     * Move the position to the end of the block, where the next one starts.
+     */
+    void finishBlock(const uint32_t frames) noexcept
+    {
+        const uint32_t last = fSegmentCount - 1;
+
+        fState = fSegmentStates[last];
+
+        DISTRHO_SAFE_ASSERT_RETURN(frames >= fSegments[last].frame,);
+        advance(fState, frames - fSegments[last].frame);
+    }
+
+    /*
+     * Position at the start of the block.
+     */
+    const TimePosition& getTimePosition() const noexcept
+    {
+        return fSegments[0].position;
+    }
+
+    const TimePositionSegment* getSegments() const noexcept
+    {
+        return fSegments;
+    }
+
+    uint32_t getSegmentCount() const noexcept
+    {
+        return fSegmentCount;
+    }
+
+    // -------------------------------------------------------------------
+    // Host position changes
+
+    /*
+     * Start a host position change at @a frame within the block.
+     * Values not set afterwards keep following the previous position.
+     */
+    void startPositionChange(const uint32_t frame) noexcept
+    {
+        uint32_t last = fSegmentCount - 1;
+
+        DISTRHO_SAFE_ASSERT_RETURN(frame >= fSegments[last].frame,);
+
+        fState = fSegmentStates[last];
+        advance(fState, frame - fSegments[last].frame);
+
+        // replace the last segment if it starts at the same frame, or if there is no room for more
+        if (frame != fSegments[last].frame && fSegmentCount < kMaxTimePositionSegments)
+            last = fSegmentCount++;
+
+        fSegments[last].frame = frame;
+    }
+
+    /*
+     * Finish the position change, the new values are used from its frame onwards.
+     */
+    void finishPositionChange() noexcept
+    {
+        const uint32_t last = fSegmentCount - 1;
+
+        fSegmentStates[last] = fState;
+        updateTimePosition(fSegments[last], fSegments[last].frame, fState);
+    }
+
+    /*
+     * Transport speed, 1.0 is playing normally and 0.0 is stopped.
+     */
+    void setSpeed(const double speed) noexcept
+    {
+        fState.speed = speed;
+    }
+
+    void setPlaying(const bool playing) noexcept
+    {
+        fState.speed = playing ? 1.0 : 0.0;
+    }
+
+    void setFrame(const int64_t frame) noexcept
+    {
+        if (frame >= 0)
+            fState.frame = static_cast<uint64_t>(frame);
+    }
+
+    void setTempo(const double beatsPerMinute) noexcept
+    {
+        if (beatsPerMinute <= 0.0)
+            return;
+
+        fState.beatsPerMinute = beatsPerMinute;
+        fState.hasTempo = true;
+    }
+
+    void setTimeSignature(const float beatsPerBar, const float beatType) noexcept
+    {
+        if (beatsPerBar > 0.0f)
+        {
+            fState.beatsPerBar = beatsPerBar;
+            fState.hasBeatsPerBar = true;
+        }
+
+        if (beatType > 0.0f)
+        {
+            fState.beatType = beatType;
+            fState.hasBeatType = true;
+        }
+    }
+
+    /*
+     * Forget the tempo, time signature and bar/beat/tick, for hosts that stop reporting them.
+     * BBT is only valid once tempo and time signature are set again.
+     */
+    void invalidateBBT() noexcept
+    {
+        const State defaults;
+
+        fState.beatsPerMinute = defaults.beatsPerMinute;
+        fState.beatsPerBar    = defaults.beatsPerBar;
+        fState.beatType       = defaults.beatType;
+        fState.ticksPerBeat   = defaults.ticksPerBeat;
+        fState.bar            = defaults.bar;
+        fState.beat           = defaults.beat;
+        fState.tick           = defaults.tick;
+        fState.tickFraction   = defaults.tickFraction;
+        fState.hasTempo       = false;
+        fState.hasBeatsPerBar = false;
+        fState.hasBeatType    = false;
+    }
+
+    /*
+     * Set this before the position, as it defines the tick resolution.
+     */
+    void setTicksPerBeat(const double ticksPerBeat) noexcept
+    {
+        if (ticksPerBeat < 1.0)
+            return;
+
+        const double beatFraction = (fState.tick + fState.tickFraction / kTickFractionScale) / fState.ticksPerBeat;
+
+        fState.ticksPerBeat = ticksPerBeat;
+        setTickFromBeatFraction(beatFraction);
+    }
+
+    /*
+     * Set the bar, 0 being the first one.
+     */
+    void setBar(const int64_t bar) noexcept
+    {
+        if (bar >= 0)
+            fState.bar = bar;
+    }
+
+    /*
+     * Set the beat within the bar, 0.0 being the start of the bar, fractions for ticks.
+     */
+    void setBarBeat(const double barBeat) noexcept
+    {
+        if (barBeat < 0.0)
+            return;
+
+        const double beat = std::floor(barBeat);
+
+        fState.beat = static_cast<int32_t>(beat);
+        setTickFromBeatFraction(barBeat - beat);
+    }
+
+    /*
+     * Set the position in quarter notes since the start, set the time signature first.
+     * Nothing is recomputed if the position and time signature did not change since the last call.
+     */
+    void setPpqPosition(const double ppqPos) noexcept
+    {
+        if (ppqPos < 0.0)
+            return;
+
+        if (d_isEqual(ppqPos, fLastPpq.ppqPos) &&
+            d_isEqual(fState.beatsPerBar, fLastPpq.beatsPerBar) &&
+            d_isEqual(fState.beatType, fLastPpq.beatType) &&
+            d_isEqual(fState.ticksPerBeat, fLastPpq.ticksPerBeat))
+        {
+            fState.bar          = fLastPpq.bar;
+            fState.beat         = fLastPpq.beat;
+            fState.tick         = fLastPpq.tick;
+            fState.tickFraction = fLastPpq.tickFraction;
+            return;
+        }
+
+        const double beats = ppqPos * fState.beatType / 4.0;
+        const double bar   = std::floor(beats / fState.beatsPerBar);
+
+        fState.bar = static_cast<int64_t>(bar);
+        setBarBeat(beats - bar * fState.beatsPerBar);
+
+        fLastPpq.ppqPos       = ppqPos;
+        fLastPpq.beatsPerBar  = fState.beatsPerBar;
+        fLastPpq.beatType     = fState.beatType;
+        fLastPpq.ticksPerBeat = fState.ticksPerBeat;
+        fLastPpq.bar          = fState.bar;
+        fLastPpq.beat         = fState.beat;
+        fLastPpq.tick         = fState.tick;
+        fLastPpq.tickFraction = fState.tickFraction;
+    }
+
+private:
+    struct State {
+        double   speed;
+        uint64_t frame;
+        double   beatsPerMinute;
+        float    beatsPerBar;
+        float    beatType;
+        double   ticksPerBeat;
+        int64_t  bar;          // 0-based
+        int32_t  beat;         // 0-based, within the bar
+        int32_t  tick;         // within the beat
+        uint32_t tickFraction; // 1/2^32 of a tick
+        bool     hasTempo, hasBeatsPerBar, hasBeatType;
+
+        State() noexcept
+            : speed(0.0),
+              frame(0),
+              beatsPerMinute(120.0),
+              beatsPerBar(4.0f),
+              beatType(4.0f),
+              ticksPerBeat(960.0),
+              bar(0),
+              beat(0),
+              tick(0),
+              tickFraction(0),
+              hasTempo(false),
+              hasBeatsPerBar(false),
+              hasBeatType(false) {}
+    };
+
+    double fSampleRate;
+
+    // position at the end of the last segment, or the one being changed
+    State fState;
+
+    State               fSegmentStates[kMaxTimePositionSegments];
+    TimePositionSegment fSegments[kMaxTimePositionSegments];
+    uint32_t            fSegmentCount;
+
+    // ticks per frame as a fixed-point value, only recomputed when the tempo changes
+    uint64_t fTickIncrement;
+    double   fTickIncrementTicksPerFrame;
+
+    // last values given to setPpqPosition() and their result
+    struct PpqPosition {
+        double   ppqPos;
+        float    beatsPerBar;
+        float    beatType;
+        double   ticksPerBeat;
+        int64_t  bar;
+        int32_t  beat;
+        int32_t  tick;
+        uint32_t tickFraction;
+
+        PpqPosition() noexcept
+            : ppqPos(-1.0),
+              beatsPerBar(0.0f),
+              beatType(0.0f),
+              ticksPerBeat(0.0),
+              bar(0),
+              beat(0),
+              tick(0),
+              tickFraction(0) {}
+    } fLastPpq;
+
+    void setTickFromBeatFraction(const double beatFraction) noexcept
+    {
+        const double ticks = beatFraction * fState.ticksPerBeat;
+        const double tick  = std::floor(ticks);
+
+        fState.tick         = static_cast<int32_t>(tick);
+        fState.tickFraction = static_cast<uint32_t>((ticks - tick) * kTickFractionScale);
+    }
+
+    /*
+     * Advance a position by a number of frames.
+     * Frames go backwards when the speed is negative, bar/beat/tick only move forwards.
+     */
+    void advance(State& state, const uint32_t frames) noexcept
+    {
+        if (frames == 0 || d_isZero(state.speed))
+            return;
+
+        if (state.speed < 0.0)
+        {
+            state.frame = state.frame > frames ? state.frame - frames : 0;
+            return;
+        }
+
+        state.frame += frames;
+
+        const double ticksPerFrame = state.beatsPerMinute * state.speed * state.ticksPerBeat / (60.0 * fSampleRate);
+
+        if (d_isNotEqual(ticksPerFrame, fTickIncrementTicksPerFrame))
+        {
+            fTickIncrementTicksPerFrame = ticksPerFrame;
+            fTickIncrement = static_cast<uint64_t>(ticksPerFrame * kTickFractionScale + 0.5);
+        }
+
+        const uint64_t fraction = state.tickFraction + fTickIncrement * frames;
+
+        state.tickFraction = static_cast<uint32_t>(fraction);
+
+        const int64_t ticks        = state.tick + static_cast<int64_t>(fraction >> kTickFractionBits);
+        const int64_t ticksPerBeat = std::max<int64_t>(1, static_cast<int64_t>(state.ticksPerBeat + 0.5));
+
+        // most blocks stay within the same beat
+        if (ticks < ticksPerBeat)
+        {
+            state.tick = static_cast<int32_t>(ticks);
+            return;
+        }
+
+        const int64_t beats       = state.beat + ticks / ticksPerBeat;
+        const int64_t beatsPerBar = std::max<int64_t>(1, static_cast<int64_t>(state.beatsPerBar + 0.5f));
+
+        state.tick = static_cast<int32_t>(ticks % ticksPerBeat);
+
+        if (beats < beatsPerBar)
+        {
+            state.beat = static_cast<int32_t>(beats);
+            return;
+        }
+
+        state.beat = static_cast<int32_t>(beats % beatsPerBar);
+        state.bar += beats / beatsPerBar;
+    }
+
+    static void updateTimePosition(TimePositionSegment& segment, const uint32_t frame, const State& state) noexcept
+    {
+        TimePosition& timePosition(segment.position);
+
+        segment.frame = frame;
+
+        timePosition.playing = d_isNotZero(state.speed);
+        timePosition.frame   = state.frame;
+
+        timePosition.bbt.valid          = state.hasTempo && state.hasBeatsPerBar && state.hasBeatType;
+        timePosition.bbt.bar            = static_cast<int32_t>(state.bar + 1);
+        timePosition.bbt.beat           = state.beat + 1;
+        timePosition.bbt.tick           = state.tick;
+        timePosition.bbt.beatsPerBar    = state.beatsPerBar;
+        timePosition.bbt.beatType       = state.beatType;
+        timePosition.bbt.ticksPerBeat   = state.ticksPerBeat;
+        timePosition.bbt.barStartTick   = state.ticksPerBeat * state.beatsPerBar * static_cast<double>(state.bar);
+        timePosition.bbt.beatsPerMinute = state.beatsPerMinute * (d_isNotZero(state.speed) ? std::abs(state.speed) : 1.0);
+    }
+
+    DISTRHO_DECLARE_NON_COPY_CLASS(PluginTransport)
+};
+
+// -----------------------------------------------------------------------
+
+END_NAMESPACE_DISTRHO
+
+#endif // DISTRHO_PLUGIN_TRANSPORT_HPP_INCLUDED
@@ -16,6 +16,10 @@
 
 #include "DistrhoPluginInternal.hpp"
 
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+# include "DistrhoPluginTransport.hpp"
+#endif
+
 #if DISTRHO_PLUGIN_HAS_UI && ! DISTRHO_PLUGIN_HAS_EMBED_UI
 # undef DISTRHO_PLUGIN_HAS_UI
 # define DISTRHO_PLUGIN_HAS_UI 0
@@ -37,7 +41,6 @@
 #define VESTIGE_HEADER
 #define VST_FORCE_DEPRECATED 0
 
-#include <clocale>
 #include <map>
 #include <string>
 
@@ -50,10 +53,17 @@
 #define effGetChunk 23
 #define effSetChunk 24
 #define effCanBeAutomated 26
+#define effString2Parameter 27
 #define effGetProgramNameIndexed 29
 #define effGetPlugCategory 35
+#define effSetBypass 44
+#define effGetTailSize 52
 #define effEditKeyDown 59
 #define effEditKeyUp 60
+#define effSetProcessPrecision 77
+#define effFlagsCanDoubleReplacing (1 << 12)
+#define kVstProcessPrecision32 0
+#define kVstProcessPrecision64 1
 #define kVstVersion 2400
 struct ERect {
     int16_t top, left, bottom, right;
@@ -80,44 +90,6 @@ void strncpy(char* const dst, const char* const src, const size_t size)
     dst[size-1] = '\0';
 }
 
-void snprintf_param(char* const dst, const float value, const size_t size)
-{
-    std::snprintf(dst, size-1, "%f", value);
-    dst[size-1] = '\0';
-}
-
-void snprintf_iparam(char* const dst, const int32_t value, const size_t size)
-{
-    std::snprintf(dst, size-1, "%d", value);
-    dst[size-1] = '\0';
-}
-
-// -----------------------------------------------------------------------
-
-class ScopedSafeLocale {
-public:
-    ScopedSafeLocale() noexcept
-        : locale(::strdup(::setlocale(LC_NUMERIC, nullptr)))
-    {
-        ::setlocale(LC_NUMERIC, "C");
-    }
-
-    ~ScopedSafeLocale() noexcept
-    {
-        if (locale != nullptr)
-        {
-            ::setlocale(LC_NUMERIC, locale);
-            std::free(locale);
-        }
-    }
-
-private:
-    char* const locale;
-
-    DISTRHO_DECLARE_NON_COPY_CLASS(ScopedSafeLocale)
-    DISTRHO_PREVENT_HEAP_ALLOCATION
-};
-
 // -----------------------------------------------------------------------
 
 class ParameterCheckHelper
@@ -388,24 +360,43 @@ public:
         fMidiEventCount = 0;
 #endif
 
-#if DISTRHO_PLUGIN_HAS_UI
-        fVstUI          = nullptr;
-        fVstRect.top    = 0;
-        fVstRect.left   = 0;
-        fVstRect.bottom = 0;
-        fVstRect.right  = 0;
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+        fTransport.setSampleRate(fPlugin.getSampleRate());
+        fPlugin.setTimePositionCallback(updateTimePositionCallback);
+#endif
+
+        fParameterTexts = nullptr;
 
+        // double precision processing is always advertised, hosts may use it without asking first
+        fPlugin.prepareDoublePrecision();
+
+        // parameter values are needed for output parameters even without UI
         if (const uint32_t paramCount = fPlugin.getParameterCount())
         {
-            parameterChecks = new bool[paramCount];
             parameterValues = new float[paramCount];
 
             for (uint32_t i=0; i < paramCount; ++i)
-            {
-                parameterChecks[i] = false;
                 parameterValues[i] = NAN;
-            }
+
+            fParameterTexts = new ParameterText[paramCount];
+
+            for (uint32_t i=0; i < paramCount; ++i)
+                fParameterTexts[i].value = NAN;
+
+#if DISTRHO_PLUGIN_HAS_UI
+            parameterChecks = new bool[paramCount];
+
+            for (uint32_t i=0; i < paramCount; ++i)
+                parameterChecks[i] = false;
+#endif
         }
+
+#if DISTRHO_PLUGIN_HAS_UI
+        fVstUI          = nullptr;
+        fVstRect.top    = 0;
+        fVstRect.left   = 0;
+        fVstRect.bottom = 0;
+        fVstRect.right  = 0;
 # if DISTRHO_OS_MAC
 #  ifdef __LP64__
         fUsingNsView = true;
@@ -429,6 +420,12 @@ public:
 
     ~PluginVst()
     {
+        if (fParameterTexts != nullptr)
+        {
+            delete[] fParameterTexts;
+            fParameterTexts = nullptr;
+        }
+
 #if DISTRHO_PLUGIN_WANT_STATE
         if (fStateChunk != nullptr)
         {
@@ -478,43 +475,52 @@ public:
         case effGetParamDisplay:
             if (ptr != nullptr && index < static_cast<int32_t>(fPlugin.getParameterCount()))
             {
-                const uint32_t hints = fPlugin.getParameterHints(index);
-                float value = fPlugin.getParameterValue(index);
+                const float value = fPlugin.getParameterValue(index);
+                ParameterText& paramText(fParameterTexts[index]);
 
-                if (hints & kParameterIsBoolean)
+                // hosts ask for this repeatedly, only format the text when the value changes.
+                // compared exactly, as values closer than the epsilon can still show differently
+                if (paramText.value != value)
                 {
-                    const ParameterRanges& ranges(fPlugin.getParameterRanges(index));
-                    const float midRange = ranges.min + (ranges.max - ranges.min) / 2.0f;
-
-                    value = value > midRange ? ranges.max : ranges.min;
-                }
-                else if (hints & kParameterIsInteger)
-                {
-                    value = std::round(value);
+                    fPlugin.getParameterValueText(index, value, paramText.text, sizeof(paramText.text));
+                    paramText.value = value;
                 }
 
-                const ParameterEnumerationValues& enumValues(fPlugin.getParameterEnumValues(index));
+                std::memcpy(ptr, paramText.text, sizeof(paramText.text));
+                return 1;
+            }
+            break;
 
-                for (uint8_t i = 0; i < enumValues.count; ++i)
-                {
-                    if (d_isNotEqual(value, enumValues.values[i].value))
-                        continue;
+        case effString2Parameter:
+            if (index < static_cast<int32_t>(fPlugin.getParameterCount()))
+            {
+                if (fPlugin.isParameterOutput(index))
+                    return 0;
 
-                    DISTRHO_NAMESPACE::strncpy((char*)ptr, enumValues.values[i].label.buffer(), 24);
+                // no text means the host is checking for support
+                if (ptr == nullptr)
                     return 1;
-                }
 
-                if (hints & kParameterIsInteger)
-                    DISTRHO_NAMESPACE::snprintf_iparam((char*)ptr, (int32_t)value, 24);
-                else
-                    DISTRHO_NAMESPACE::snprintf_param((char*)ptr, value, 24);
+                float realValue;
+
+                if (! fPlugin.getParameterValueFromText(index, (const char*)ptr, realValue))
+                    return 0;
+
+                fPlugin.setParameterValue(index, realValue);
 
+#if DISTRHO_PLUGIN_HAS_UI
+                if (fVstUI != nullptr)
+                    setParameterValueFromPlugin(index, realValue);
+#endif
                 return 1;
             }
             break;
 
         case effSetSampleRate:
             fPlugin.setSampleRate(opt, true);
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+            fTransport.setSampleRate(opt);
+#endif
 
 #if DISTRHO_PLUGIN_HAS_UI
             if (fVstUI != nullptr)
@@ -524,6 +530,7 @@ public:
 
         case effSetBlockSize:
             fPlugin.setBufferSize(value, true);
+            fPlugin.prepareDoublePrecision();
             break;
 
         case effMainsChanged:
@@ -549,6 +556,7 @@ public:
                 if (sampleRate != 0.0)
                     fPlugin.setSampleRate(sampleRate, true);
 
+                fPlugin.prepareDoublePrecision();
                 fPlugin.activate();
             }
             else
@@ -564,14 +572,21 @@ public:
                 fVstRect.right  = fVstUI->getWidth();
                 fVstRect.bottom = fVstUI->getHeight();
             }
-            else
+            else if (fVstRect.right == 0 || fVstRect.bottom == 0)
             {
+                // keeps the last size after the editor is closed, so this only happens once
+# if DISTRHO_UI_DEFAULT_WIDTH > 0
+                fVstRect.right  = DISTRHO_UI_DEFAULT_WIDTH;
+                fVstRect.bottom = DISTRHO_UI_DEFAULT_HEIGHT;
+# else
+                // size unknown until the UI is created
                 d_lastUiSampleRate = fPlugin.getSampleRate();
 
                 UIExporter tmpUI(nullptr, 0, nullptr, nullptr, nullptr, nullptr, nullptr, fPlugin.getInstancePointer());
                 fVstRect.right  = tmpUI.getWidth();
                 fVstRect.bottom = tmpUI.getHeight();
                 tmpUI.quit();
+# endif
             }
             *(ERect**)ptr = &fVstRect;
             return 1;
@@ -620,6 +635,9 @@ public:
         case effEditClose:
             if (fVstUI != nullptr)
             {
+                fVstRect.right  = fVstUI->getWidth();
+                fVstRect.bottom = fVstUI->getHeight();
+
                 delete fVstUI;
                 fVstUI = nullptr;
                 return 1;
@@ -674,7 +692,7 @@ public:
                 }
 # endif
 
-                String chunkStr;
+                StringBuilder chunkBuilder;
 
                 for (StringMap::const_iterator cit=fStateMap.begin(), cite=fStateMap.end(); cit != cite; ++cit)
                 {
@@ -682,22 +700,13 @@ public:
                     const String& value = cit->second;
 
                     // join key and value
-                    String tmpStr;
-                    tmpStr  = key;
-                    tmpStr += "\xff";
-                    tmpStr += value;
-                    tmpStr += "\xff";
-
-                    chunkStr += tmpStr;
+                    chunkBuilder << key << '\xff' << value << '\xff';
                 }
 
                 if (paramCount != 0)
                 {
                     // add another separator
-                    chunkStr += "\xff";
-
-                    // temporarily set locale to "C" while converting floats
-                    const ScopedSafeLocale ssl;
+                    chunkBuilder << '\xff';
 
                     for (uint32_t i=0; i<paramCount; ++i)
                     {
@@ -705,16 +714,11 @@ public:
                             continue;
 
                         // join key and value
-                        String tmpStr;
-                        tmpStr  = fPlugin.getParameterSymbol(i);
-                        tmpStr += "\xff";
-                        tmpStr += String(fPlugin.getParameterValue(i));
-                        tmpStr += "\xff";
-
-                        chunkStr += tmpStr;
+                        chunkBuilder << fPlugin.getParameterSymbol(i) << '\xff' << fPlugin.getParameterValue(i) << '\xff';
                     }
                 }
 
+                const String& chunkStr(chunkBuilder.toString());
                 const std::size_t chunkSize(chunkStr.length()+1);
 
                 fStateChunk = new char[chunkSize];
@@ -774,9 +778,6 @@ public:
                 ++key;
                 float fvalue;
 
-                // temporarily set locale to "C" while converting floats
-                const ScopedSafeLocale ssl;
-
                 while (bytesRead < chunkSize)
                 {
                     if (key[0] == '\0')
@@ -794,7 +795,7 @@ public:
                         if (fPlugin.getParameterSymbol(i) != key)
                             continue;
 
-                        fvalue = std::atof(value);
+                        fvalue = d_str2float(value);
                         fPlugin.setParameterValue(i, fvalue);
 # if DISTRHO_PLUGIN_HAS_UI
                         if (fVstUI != nullptr)
@@ -858,6 +859,38 @@ public:
             }
             break;
 
+#if DISTRHO_PLUGIN_WANT_TAIL
+        case effGetTailSize:
+            // 0 means the host default, 1 means no tail
+            if (const uint32_t tailLength = fPlugin.getTailLength())
+                return tailLength;
+            return 1;
+#endif
+
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+        case effSetBypass:
+            // keep the bypass parameter in sync if there is one, which also sets the bypass
+            for (uint32_t i=0, count=fPlugin.getParameterCount(); i < count; ++i)
+            {
+                if (fPlugin.getParameterDesignation(i) == kParameterDesignationBypass)
+                {
+                    vst_setParameter(i, value != 0 ? 1.0f : 0.0f);
+                    return 1;
+                }
+            }
+            fPlugin.setBypass(value != 0);
+            return 1;
+#endif
+
+        case effSetProcessPrecision:
+            // plugins without their own double precision run() need conversion buffers
+            if (value == kVstProcessPrecision64)
+            {
+                fPlugin.prepareDoublePrecision();
+                return 1;
+            }
+            return (value == kVstProcessPrecision32) ? 1 : 0;
+
         case effCanDo:
             if (const char* const canDo = (const char*)ptr)
             {
@@ -887,6 +920,10 @@ public:
                     return 1;
 #else
                     return -1;
+#endif
+#if DISTRHO_PLUGIN_WANT_HOST_BYPASS
+                if (std::strcmp(canDo, "bypass") == 0)
+                    return 1;
 #endif
             }
             break;
@@ -918,7 +955,9 @@ public:
 #endif
     }
 
-    void vst_processReplacing(const float** const inputs, float** const outputs, const int32_t sampleFrames)
+    // float or double, depending on the host processing precision
+    template<typename T>
+    void vst_processReplacing(const T** const inputs, T** const outputs, const int32_t sampleFrames)
     {
         if (sampleFrames <= 0)
         {
@@ -933,47 +972,9 @@ public:
         }
 
 #if DISTRHO_PLUGIN_WANT_TIMEPOS
-        static const int kWantVstTimeFlags(kVstTransportPlaying|kVstPpqPosValid|kVstTempoValid|kVstTimeSigValid);
-
-        if (const VstTimeInfo* const vstTimeInfo = (const VstTimeInfo*)hostCallback(audioMasterGetTime, 0, kWantVstTimeFlags))
-        {
-            fTimePosition.frame     =   vstTimeInfo->samplePos;
-            fTimePosition.playing   =  (vstTimeInfo->flags & kVstTransportPlaying);
-            fTimePosition.bbt.valid = ((vstTimeInfo->flags & kVstTempoValid) != 0 || (vstTimeInfo->flags & kVstTimeSigValid) != 0);
-
-            // ticksPerBeat is not possible with VST
-            fTimePosition.bbt.ticksPerBeat = 960.0;
-
-            if (vstTimeInfo->flags & kVstTempoValid)
-                fTimePosition.bbt.beatsPerMinute = vstTimeInfo->tempo;
-            else
-                fTimePosition.bbt.beatsPerMinute = 120.0;
-
-            if (vstTimeInfo->flags & (kVstPpqPosValid|kVstTimeSigValid))
-            {
-                const int    ppqPerBar = vstTimeInfo->timeSigNumerator * 4 / vstTimeInfo->timeSigDenominator;
-                const double barBeats  = (std::fmod(vstTimeInfo->ppqPos, ppqPerBar) / ppqPerBar) * vstTimeInfo->timeSigDenominator;
-                const double rest      =  std::fmod(barBeats, 1.0);
-
-                fTimePosition.bbt.bar         = int(vstTimeInfo->ppqPos)/ppqPerBar + 1;
-                fTimePosition.bbt.beat        = barBeats-rest+1;
-                fTimePosition.bbt.tick        = rest*fTimePosition.bbt.ticksPerBeat+0.5;
-                fTimePosition.bbt.beatsPerBar = vstTimeInfo->timeSigNumerator;
-                fTimePosition.bbt.beatType    = vstTimeInfo->timeSigDenominator;
-            }
-            else
-            {
-                fTimePosition.bbt.bar         = 1;
-                fTimePosition.bbt.beat        = 1;
-                fTimePosition.bbt.tick        = 0;
-                fTimePosition.bbt.beatsPerBar = 4.0f;
-                fTimePosition.bbt.beatType    = 4.0f;
-            }
-
-            fTimePosition.bbt.barStartTick = fTimePosition.bbt.ticksPerBeat*fTimePosition.bbt.beatsPerBar*(fTimePosition.bbt.bar-1);
-
-            fPlugin.setTimePosition(fTimePosition);
-        }
+        // fetched by updateTimePosition() if the plugin asks for it
+        fTransport.startBlock();
+        fPlugin.invalidateTimePosition();
 #endif
 
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
@@ -983,6 +984,10 @@ public:
         fPlugin.run(inputs, outputs, sampleFrames);
 #endif
 
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+        fTransport.finishBlock(sampleFrames);
+#endif
+
         updateParameterOutputsAndTriggers();
     }
 
@@ -1001,13 +1006,20 @@ private:
     // Temporary data
     char fProgramName[32+1];
 
+    // Last text given to the host for each parameter
+    struct ParameterText {
+        float value;
+        char  text[24];
+    };
+    ParameterText* fParameterTexts;
+
 #if DISTRHO_PLUGIN_WANT_MIDI_INPUT
     uint32_t  fMidiEventCount;
     MidiEvent fMidiEvents[kMaxMidiEvents];
 #endif
 
 #if DISTRHO_PLUGIN_WANT_TIMEPOS
-    TimePosition fTimePosition;
+    PluginTransport fTransport;
 #endif
 
     // UI stuff
@@ -1128,6 +1140,60 @@ private:
     }
 #endif
 
+#if DISTRHO_PLUGIN_WANT_TIMEPOS
+    // called on the first Plugin::getTimePosition() of a block
+    void updateTimePosition()
+    {
+        static const int kWantVstTimeFlags(kVstTransportPlaying|kVstPpqPosValid|kVstTempoValid|kVstTimeSigValid);
+
+        // without host time info the position from the previous block keeps going
+        if (const VstTimeInfo* const vstTimeInfo = (const VstTimeInfo*)hostCallback(audioMasterGetTime, 0, kWantVstTimeFlags))
+        {
+            fTransport.startPositionChange(0);
+            fTransport.setPlaying(vstTimeInfo->flags & kVstTransportPlaying);
+            fTransport.setFrame(static_cast<int64_t>(vstTimeInfo->samplePos));
+
+            if (vstTimeInfo->flags & (kVstTempoValid|kVstTimeSigValid))
+            {
+                const bool  timeSigValid = vstTimeInfo->flags & kVstTimeSigValid;
+                const float beatsPerBar  = timeSigValid ? vstTimeInfo->timeSigNumerator : 4.0f;
+                const float beatType     = timeSigValid ? vstTimeInfo->timeSigDenominator : 4.0f;
+
+                // VST tempo is in quarter notes per minute, the transport counts beats of beatType
+                const double tempo = (vstTimeInfo->flags & kVstTempoValid) ? vstTimeInfo->tempo : 120.0;
+
+                // ticksPerBeat is not possible with VST, the default is used
+                fTransport.setTimeSignature(beatsPerBar, beatType);
+                fTransport.setTempo(tempo * beatType / 4.0);
+            }
+            else
+            {
+                fTransport.invalidateBBT();
+            }
+
+            // the bar/beat/tick math is skipped while the position does not change
+            if (vstTimeInfo->flags & (kVstPpqPosValid|kVstTimeSigValid))
+            {
+                fTransport.setPpqPosition(vstTimeInfo->ppqPos);
+            }
+            else
+            {
+                fTransport.setBar(0);
+                fTransport.setBarBeat(0.0);
+            }
+
+            fTransport.finishPositionChange();
+        }
+
+        fPlugin.setTimePosition(fTransport.getTimePosition());
+    }
+
+    static void updateTimePositionCallback(void* ptr)
+    {
+        ((PluginVst*)ptr)->updateTimePosition();
+    }
+#endif
+
 #if DISTRHO_PLUGIN_WANT_STATE
     // -------------------------------------------------------------------
     // functions called from the UI side, may block
@@ -1370,6 +1436,12 @@ static void vst_processReplacingCallback(AEffect* effect, float** inputs, float*
         pluginPtr->vst_processReplacing(const_cast<const float**>(inputs), outputs, sampleFrames);
 }
 
+static void vst_processDoubleReplacingCallback(AEffect* effect, double** inputs, double** outputs, int32_t sampleFrames)
+{
+    if (validPlugin)
+        pluginPtr->vst_processReplacing(const_cast<const double**>(inputs), outputs, sampleFrames);
+}
+
 #undef pluginPtr
 #undef validObject
 #undef validPlugin
@@ -1436,6 +1508,7 @@ const AEffect* VSTPluginMain(audioMasterCallback audioMaster)
 
     // plugin flags
     effect->flags |= effFlagsCanReplacing;
+    effect->flags |= effFlagsCanDoubleReplacing;
 #if DISTRHO_PLUGIN_IS_SYNTH
     effect->flags |= effFlagsIsSynth;
 #endif
@@ -1452,6 +1525,7 @@ const AEffect* VSTPluginMain(audioMasterCallback audioMaster)
     effect->getParameter = vst_getParameterCallback;
     effect->setParameter = vst_setParameterCallback;
     effect->processReplacing = vst_processReplacingCallback;
+    effect->processDoubleReplacing = vst_processDoubleReplacingCallback;
 
     // pointers
     VstObject* const obj(new VstObject());
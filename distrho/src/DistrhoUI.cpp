@@ -25,17 +25,27 @@ START_NAMESPACE_DISTRHO
 /* ------------------------------------------------------------------------------------------------------------
  * Static data, see DistrhoUIInternal.hpp */
 
-double      d_lastUiSampleRate = 0.0;
-void*       d_lastUiDspPtr     = nullptr;
+DISTRHO_THREAD_LOCAL double      d_lastUiSampleRate = 0.0;
+DISTRHO_THREAD_LOCAL void*       d_lastUiDspPtr     = nullptr;
 #ifdef HAVE_DGL
-Window*     d_lastUiWindow     = nullptr;
+DISTRHO_THREAD_LOCAL Window*     d_lastUiWindow     = nullptr;
 #endif
-uintptr_t   g_nextWindowId     = 0;
-const char* g_nextBundlePath   = nullptr;
+DISTRHO_THREAD_LOCAL uintptr_t   g_nextWindowId     = 0;
+DISTRHO_THREAD_LOCAL const char* g_nextBundlePath   = nullptr;
 
 /* ------------------------------------------------------------------------------------------------------------
  * UI */
 
+#if DISTRHO_UI_DEFAULT_WIDTH > 0
+// hosts may have been given the declared size before the UI existed, so it must be the real initial one
+static void checkDefaultSize(const uint width, const uint height) noexcept
+{
+    if (width != DISTRHO_UI_DEFAULT_WIDTH || height != DISTRHO_UI_DEFAULT_HEIGHT)
+        d_stderr2("UI created with size %ux%u, but DISTRHO_UI_DEFAULT_WIDTH/HEIGHT declare %ux%u",
+                  width, height, DISTRHO_UI_DEFAULT_WIDTH, DISTRHO_UI_DEFAULT_HEIGHT);
+}
+#endif
+
 #ifdef HAVE_DGL
 UI::UI(uint width, uint height)
     : UIWidget(*d_lastUiWindow),
@@ -43,13 +53,22 @@ UI::UI(uint width, uint height)
 {
     ((UIWidget*)this)->pData->needsFullViewport = false;
 
+#if DISTRHO_UI_DEFAULT_WIDTH > 0
+    checkDefaultSize(width, height);
+#endif
+
     if (width > 0 && height > 0)
         setSize(width, height);
 }
 #else
 UI::UI(uint width, uint height)
     : UIWidget(width, height),
-      pData(new PrivateData()) {}
+      pData(new PrivateData())
+{
+#if DISTRHO_UI_DEFAULT_WIDTH > 0
+    checkDefaultSize(width, height);
+#endif
+}
 #endif
 
 UI::~UI()
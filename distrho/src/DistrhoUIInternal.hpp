@@ -38,13 +38,13 @@ START_NAMESPACE_DISTRHO
 // -----------------------------------------------------------------------
 // Static data, see DistrhoUI.cpp
 
-extern double      d_lastUiSampleRate;
-extern void*       d_lastUiDspPtr;
+extern DISTRHO_THREAD_LOCAL double      d_lastUiSampleRate;
+extern DISTRHO_THREAD_LOCAL void*       d_lastUiDspPtr;
 #ifdef HAVE_DGL
-extern Window*     d_lastUiWindow;
+extern DISTRHO_THREAD_LOCAL Window*     d_lastUiWindow;
 #endif
-extern uintptr_t   g_nextWindowId;
-extern const char* g_nextBundlePath;
+extern DISTRHO_THREAD_LOCAL uintptr_t   g_nextWindowId;
+extern DISTRHO_THREAD_LOCAL const char* g_nextBundlePath;
 
 // -----------------------------------------------------------------------
 // UI callbacks
@@ -1,6 +1,5 @@
 #include "DistrhoUIInternal.hpp"
 #include "IdleThread.hpp"
-#include "unistd.h"
 
 START_NAMESPACE_DISTRHO
 
@@ -17,9 +16,7 @@ void IdleThread::run()
 
         if (ui->glWindow.isReady())
             ui->fUI->uiIdle();
-
-        usleep(16 * 1000);
-    } while (!shouldThreadExit());
+    } while (!waitForThreadShouldExit(16));
 }
 
 END_NAMESPACE_DISTRHO
\ No newline at end of file
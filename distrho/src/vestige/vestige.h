@@ -306,6 +306,10 @@ struct _AEffect
 	int32_t version;
 	// processReplacing 50-53
 	void (* processReplacing) (struct _AEffect *, float **, float **, int);
+	// processDoubleReplacing 54-57
+	void (* processDoubleReplacing) (struct _AEffect *, double **, double **, int);
+	// Zeroes 58-8f
+	char future[56];
 };
 
 typedef struct _AEffect AEffect;
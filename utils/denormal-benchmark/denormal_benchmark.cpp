@@ -0,0 +1,253 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Cost of denormals in a decaying filter and reverb tail, with and without ScopedDenormalDisable.
+ * An impulse is fed into a bank of biquads and a comb/allpass reverb, followed by silence;
+ * the tails end up in the denormal range and stay there unless denormals are flushed.
+ * Processing is done per block like PluginExporter::run(), so the cost of switching modes is included.
+ */
+
+#include "extra/ScopedDenormalDisable.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+USE_NAMESPACE_DISTRHO;
+
+// -----------------------------------------------------------------------
+
+static double getTimeInSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+static const double kSampleRate = 48000.0;
+static const uint32_t kBlockSize = 256;
+static const uint32_t kNumBiquads = 16;
+static const uint32_t kNumCombs = 8;
+static const uint32_t kNumAllpasses = 4;
+
+// Freeverb tunings
+static const uint32_t kCombSizes[kNumCombs] = { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617 };
+static const uint32_t kAllpassSizes[kNumAllpasses] = { 556, 441, 341, 225 };
+
+// -----------------------------------------------------------------------
+
+struct Biquad {
+    float b0, b1, b2, a1, a2;
+    float z1, z2;
+
+    void init(const double frequency)
+    {
+        // resonant lowpass, RBJ cookbook
+        const double w0    = 2.0 * 3.14159265358979 * frequency / kSampleRate;
+        const double alpha = std::sin(w0) / (2.0 * 4.0);
+        const double a0    = 1.0 + alpha;
+
+        b0 = static_cast<float>((1.0 - std::cos(w0)) / 2.0 / a0);
+        b1 = static_cast<float>((1.0 - std::cos(w0)) / a0);
+        b2 = b0;
+        a1 = static_cast<float>(-2.0 * std::cos(w0) / a0);
+        a2 = static_cast<float>((1.0 - alpha) / a0);
+        z1 = z2 = 0.0f;
+    }
+
+    float process(const float in)
+    {
+        const float out = b0 * in + z1;
+        z1 = b1 * in - a1 * out + z2;
+        z2 = b2 * in - a2 * out;
+        return out;
+    }
+};
+
+struct Delay {
+    float* buffer;
+    uint32_t size, pos;
+    float filterState;
+
+    void init(const uint32_t s)
+    {
+        buffer = new float[s];
+        std::memset(buffer, 0, sizeof(float)*s);
+        size = s;
+        pos = 0;
+        filterState = 0.0f;
+    }
+
+    void clear()
+    {
+        delete[] buffer;
+    }
+
+    float processComb(const float in)
+    {
+        const float out = buffer[pos];
+        filterState = out * 0.8f + filterState * 0.2f;
+        buffer[pos] = in + filterState * 0.84f;
+        if (++pos == size) pos = 0;
+        return out;
+    }
+
+    float processAllpass(const float in)
+    {
+        const float delayed = buffer[pos];
+        buffer[pos] = in + delayed * 0.5f;
+        if (++pos == size) pos = 0;
+        return delayed - in;
+    }
+};
+
+class Workload
+{
+public:
+    Workload()
+    {
+        for (uint32_t i=0; i < kNumBiquads; ++i)
+            fBiquads[i].init(100.0 + 500.0 * i);
+        for (uint32_t i=0; i < kNumCombs; ++i)
+            fCombs[i].init(kCombSizes[i]);
+        for (uint32_t i=0; i < kNumAllpasses; ++i)
+            fAllpasses[i].init(kAllpassSizes[i]);
+    }
+
+    ~Workload()
+    {
+        for (uint32_t i=0; i < kNumCombs; ++i)
+            fCombs[i].clear();
+        for (uint32_t i=0; i < kNumAllpasses; ++i)
+            fAllpasses[i].clear();
+    }
+
+    void run(const float* const input, float* const output, const uint32_t frames)
+    {
+        for (uint32_t f=0; f < frames; ++f)
+        {
+            float filtered = 0.0f;
+
+            for (uint32_t i=0; i < kNumBiquads; ++i)
+                filtered += fBiquads[i].process(input[f]);
+
+            float reverb = 0.0f;
+
+            for (uint32_t i=0; i < kNumCombs; ++i)
+                reverb += fCombs[i].processComb(filtered);
+            for (uint32_t i=0; i < kNumAllpasses; ++i)
+                reverb = fAllpasses[i].processAllpass(reverb);
+
+            output[f] = reverb;
+        }
+    }
+
+private:
+    Biquad fBiquads[kNumBiquads];
+    Delay fCombs[kNumCombs];
+    Delay fAllpasses[kNumAllpasses];
+};
+
+// -----------------------------------------------------------------------
+
+/*
+ * Process an impulse followed by silence, return the worst and average block time in seconds.
+ * The first second is skipped, the tail only reaches the denormal range after a while.
+ */
+static void runWorkload(const bool flushDenormals, const uint32_t seconds, double& average, double& worst)
+{
+    Workload workload;
+    float input[kBlockSize], output[kBlockSize];
+
+    const uint32_t numBlocks = static_cast<uint32_t>(seconds * kSampleRate / kBlockSize);
+    const uint32_t skipBlocks = static_cast<uint32_t>(kSampleRate / kBlockSize);
+    double total = 0.0;
+
+    average = worst = 0.0;
+
+    for (uint32_t b=0; b < numBlocks; ++b)
+    {
+        std::memset(input, 0, sizeof(input));
+
+        if (b == 0)
+            input[0] = 1.0f;
+
+        const double startTime = getTimeInSeconds();
+
+        if (flushDenormals)
+        {
+            const ScopedDenormalDisable sdd;
+            workload.run(input, output, kBlockSize);
+        }
+        else
+        {
+            workload.run(input, output, kBlockSize);
+        }
+
+        const double elapsed = getTimeInSeconds() - startTime;
+
+        if (b < skipBlocks)
+            continue;
+
+        total += elapsed;
+
+        if (elapsed > worst)
+            worst = elapsed;
+    }
+
+    average = total / (numBlocks - skipBlocks);
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t seconds = 20;
+
+    for (int i=1; i < argc; ++i)
+    {
+        if ((std::strcmp(argv[i], "-s") == 0 || std::strcmp(argv[i], "--seconds") == 0) && i+1 < argc)
+            seconds = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else
+        {
+            d_stderr("Usage: %s [-s|--seconds N]", argv[0]);
+            return 1;
+        }
+    }
+
+    if (seconds < 2)
+    {
+        d_stderr("Need at least 2 seconds of audio");
+        return 1;
+    }
+
+    const double blockBudget = kBlockSize / kSampleRate;
+    double averageOff, worstOff, averageOn, worstOn;
+
+    runWorkload(false, seconds, averageOff, worstOff);
+    runWorkload(true, seconds, averageOn, worstOn);
+
+    d_stdout("%u s of tail, %u frame blocks (%.0f us budget)", seconds, kBlockSize, blockBudget * 1e6);
+    d_stdout("Denormals kept:    %8.2f us average, %8.2f us worst, %5.1f%% DSP load",
+             averageOff * 1e6, worstOff * 1e6, averageOff / blockBudget * 100.0);
+    d_stdout("Denormals flushed: %8.2f us average, %8.2f us worst, %5.1f%% DSP load",
+             averageOn * 1e6, worstOn * 1e6, averageOn / blockBudget * 100.0);
+    d_stdout("Speedup: %.1fx", averageOff / averageOn);
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------
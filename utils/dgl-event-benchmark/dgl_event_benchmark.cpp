@@ -0,0 +1,301 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Times pointer event dispatch on a window with a dense grid of widgets.
+ * Synthetic motion, click and scroll events are sent through the X server,
+ * and the number of dispatched events and widget handler calls per event is reported.
+ */
+
+// X11 also defines 'Window'
+#define DONT_SET_USING_DGL_NAMESPACE
+
+#include "Application.hpp"
+#include "Widget.hpp"
+#include "Window.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <X11/Xlib.h>
+
+// -----------------------------------------------------------------------
+
+static uint64_t gHandlerCalls = 0;
+static uint64_t gReceivedEvents = 0;
+static uint64_t gDispatchedEvents = 0;
+
+static double getTimeInSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+// -----------------------------------------------------------------------
+
+START_NAMESPACE_DGL
+
+// Behaves like a typical button, tracking hover and taking clicks within its bounds
+
+class BenchmarkWidget : public Widget
+{
+public:
+    BenchmarkWidget(Window& parent)
+        : Widget(parent),
+          fHover(false),
+          fPressed(false) {}
+
+protected:
+    void onDisplay() override {}
+
+    bool onMouse(const MouseEvent& ev) override
+    {
+        ++gHandlerCalls;
+
+        if (ev.press && contains(ev.pos))
+        {
+            fPressed = true;
+            return true;
+        }
+
+        if (! ev.press && fPressed)
+        {
+            fPressed = false;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool onMotion(const MotionEvent& ev) override
+    {
+        ++gHandlerCalls;
+
+        if (fPressed)
+            return true;
+
+        if (fHover != contains(ev.pos))
+        {
+            fHover = ! fHover;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool onScroll(const ScrollEvent& ev) override
+    {
+        ++gHandlerCalls;
+
+        return contains(ev.pos);
+    }
+
+private:
+    bool fHover, fPressed;
+};
+
+// -----------------------------------------------------------------------
+// Zero-sized widget that sees every event, used to know when the sent events were processed
+
+class EventCounterWidget : public Widget
+{
+public:
+    EventCounterWidget(Window& parent)
+        : Widget(parent) {}
+
+protected:
+    void onDisplay() override {}
+
+    bool onMouse(const MouseEvent&) override
+    {
+        ++gReceivedEvents;
+        ++gDispatchedEvents;
+        return false;
+    }
+
+    bool onMotion(const MotionEvent& ev) override
+    {
+        // merged motion events count as received
+        gReceivedEvents += 1 + ev.historySize;
+        ++gDispatchedEvents;
+        return false;
+    }
+
+    bool onScroll(const ScrollEvent&) override
+    {
+        ++gReceivedEvents;
+        ++gDispatchedEvents;
+        return false;
+    }
+};
+
+END_NAMESPACE_DGL
+
+// -----------------------------------------------------------------------
+
+static void sendPointerEvent(Display* const display, const ::Window window, const int type,
+                             const int x, const int y, const uint button)
+{
+    XEvent xevent;
+    std::memset(&xevent, 0, sizeof(xevent));
+
+    xevent.type = type;
+    xevent.xany.display = display;
+    xevent.xany.window = window;
+
+    if (type == MotionNotify)
+    {
+        xevent.xmotion.x = x;
+        xevent.xmotion.y = y;
+        xevent.xmotion.same_screen = True;
+    }
+    else
+    {
+        xevent.xbutton.x = x;
+        xevent.xbutton.y = y;
+        xevent.xbutton.button = button;
+        xevent.xbutton.same_screen = True;
+    }
+
+    XSendEvent(display, window, False, 0, &xevent);
+}
+
+int main(int argc, char* argv[])
+{
+    uint numWidgets = 1000;
+    uint numEvents = 100000;
+
+    for (int i=1; i < argc; ++i)
+    {
+        if ((std::strcmp(argv[i], "-w") == 0 || std::strcmp(argv[i], "--widgets") == 0) && i+1 < argc)
+            numWidgets = static_cast<uint>(std::atoi(argv[++i]));
+        else if ((std::strcmp(argv[i], "-e") == 0 || std::strcmp(argv[i], "--events") == 0) && i+1 < argc)
+            numEvents = static_cast<uint>(std::atoi(argv[++i]));
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [-w|--widgets N] [-e|--events N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (numWidgets == 0 || numEvents == 0)
+    {
+        std::fprintf(stderr, "Number of widgets and events must be positive\n");
+        return 1;
+    }
+
+    Display* const display = XOpenDisplay(nullptr);
+
+    if (display == nullptr)
+    {
+        std::fprintf(stderr, "Failed to open X display\n");
+        return 1;
+    }
+
+    const uint width = 1024, height = 768;
+
+    DGL_NAMESPACE::Application app;
+    DGL_NAMESPACE::Window window(app);
+    window.setSize(width, height);
+    window.setTitle("DGL event benchmark");
+
+    // lay out widgets in a dense grid covering the window
+    const uint columns = static_cast<uint>(std::ceil(std::sqrt(numWidgets * static_cast<double>(width) / height)));
+    const uint rows    = (numWidgets + columns - 1) / columns;
+    const uint widgetWidth  = width / columns;
+    const uint widgetHeight = height / rows;
+
+    DGL_NAMESPACE::BenchmarkWidget** const widgets = new DGL_NAMESPACE::BenchmarkWidget*[numWidgets];
+
+    for (uint i=0; i < numWidgets; ++i)
+    {
+        widgets[i] = new DGL_NAMESPACE::BenchmarkWidget(window);
+        widgets[i]->setAbsolutePos(static_cast<int>((i % columns) * widgetWidth),
+                                   static_cast<int>((i / columns) * widgetHeight));
+        widgets[i]->setSize(widgetWidth > 2 ? widgetWidth - 2 : 1, widgetHeight > 2 ? widgetHeight - 2 : 1);
+    }
+
+    // created last, so it receives events first
+    DGL_NAMESPACE::EventCounterWidget* const counter = new DGL_NAMESPACE::EventCounterWidget(window);
+
+    window.show();
+    app.idle();
+
+    const ::Window xWindow = static_cast<::Window>(window.getWindowId());
+
+    // the pointer sweeps the window, with a click every 64 events and a scroll every 16
+    uint numSent = 0;
+    const double startTime = getTimeInSeconds();
+
+    while (numSent < numEvents)
+    {
+        for (uint i=0; i < 256 && numSent < numEvents; ++i, ++numSent)
+        {
+            const int x = static_cast<int>((numSent * 7) % width);
+            const int y = static_cast<int>((numSent * 7 / width * 13) % height);
+
+            if (numSent % 64 == 0)
+                sendPointerEvent(display, xWindow, ButtonPress, x, y, 1);
+            else if (numSent % 64 == 8)
+                sendPointerEvent(display, xWindow, ButtonRelease, x, y, 1);
+            else if (numSent % 16 == 4)
+                sendPointerEvent(display, xWindow, ButtonPress, x, y, 5);
+            else
+                sendPointerEvent(display, xWindow, MotionNotify, x, y, 0);
+        }
+
+        XSync(display, False);
+
+        for (double timeout = getTimeInSeconds() + 5.0; gReceivedEvents < numSent;)
+        {
+            app.idle();
+
+            if (getTimeInSeconds() > timeout)
+            {
+                std::fprintf(stderr, "Timed out waiting for events, received %lu of %u\n",
+                             static_cast<unsigned long>(gReceivedEvents), numSent);
+                numEvents = numSent = static_cast<uint>(gReceivedEvents);
+                break;
+            }
+        }
+    }
+
+    const double elapsed = getTimeInSeconds() - startTime;
+
+    std::printf("Widgets:                  %u\n", numWidgets);
+    std::printf("Events:                   %u\n", numEvents);
+    std::printf("Dispatched events:        %lu\n", static_cast<unsigned long>(gDispatchedEvents));
+    std::printf("Time per event:           %.3f us\n", elapsed * 1e6 / numEvents);
+    std::printf("Handler calls per event:  %.2f\n", static_cast<double>(gHandlerCalls) / numEvents);
+
+    delete counter;
+
+    for (uint i=0; i < numWidgets; ++i)
+        delete widgets[i];
+
+    delete[] widgets;
+
+    window.close();
+    XCloseDisplay(display);
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------
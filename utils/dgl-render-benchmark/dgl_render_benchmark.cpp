@@ -0,0 +1,799 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Frame cost of synthetic UIs made of image widgets, NanoVG widgets and geometry primitives.
+ * Every frame changes the widget values and repaints the whole window, which is rendered offscreen
+ * by the headless backend, so Mesa's software renderer is enough to run it.
+ * Reports wall and CPU time, GL calls and texture uploads per frame.
+ * GL calls are counted by wrapping the GL functions at link time, see GNUmakefile.
+ */
+
+#include "Application.hpp"
+#include "Geometry.hpp"
+#include "ImageWidgets.hpp"
+#include "NanoVG.hpp"
+#include "Window.hpp"
+
+#include <GL/glext.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+// -----------------------------------------------------------------------
+// GL call counting
+
+static uint64_t gGLCalls = 0;
+static uint64_t gTextureUploads = 0;
+static uint64_t gTextureUploadBytes = 0;
+
+static uint getBytesPerPixel(const GLenum format)
+{
+    switch (format)
+    {
+    case GL_RED:
+    case GL_ALPHA:
+    case GL_LUMINANCE:
+        return 1;
+    case GL_RGB:
+    case GL_BGR:
+        return 3;
+    default:
+        return 4;
+    }
+}
+
+#define GL_WRAP(ret, name, params, args)           \
+    extern "C" ret __real_##name params;           \
+    extern "C" ret __wrap_##name params            \
+    {                                              \
+        ++gGLCalls;                                \
+        return __real_##name args;                 \
+    }
+
+#define GL_WRAP_UPLOAD(ret, name, params, args)    \
+    extern "C" ret __real_##name params;           \
+    extern "C" ret __wrap_##name params            \
+    {                                              \
+        ++gGLCalls;                                \
+        ++gTextureUploads;                         \
+        gTextureUploadBytes += static_cast<uint64_t>(width) * height * getBytesPerPixel(format); \
+        return __real_##name args;                 \
+    }
+
+// all GL functions used by libdgl.a, check with 'nm -u libdgl.a | grep " gl"'
+GL_WRAP(void, glActiveTexture, (GLenum texture), (texture))
+GL_WRAP(void, glAttachShader, (GLuint program, GLuint shader), (program, shader))
+GL_WRAP(void, glBegin, (GLenum mode), (mode))
+GL_WRAP(void, glBindAttribLocation, (GLuint program, GLuint index, const GLchar* name), (program, index, name))
+GL_WRAP(void, glBindBuffer, (GLenum target, GLuint buffer), (target, buffer))
+GL_WRAP(void, glBindTexture, (GLenum target, GLuint texture), (target, texture))
+GL_WRAP(void, glBlendFunc, (GLenum sfactor, GLenum dfactor), (sfactor, dfactor))
+GL_WRAP(void, glBlendFuncSeparate, (GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha), (srcRGB, dstRGB, srcAlpha, dstAlpha))
+GL_WRAP(void, glBufferData, (GLenum target, GLsizeiptr size, const void* data, GLenum usage), (target, size, data, usage))
+GL_WRAP(void, glClear, (GLbitfield mask), (mask))
+GL_WRAP(void, glColor4f, (GLfloat r, GLfloat g, GLfloat b, GLfloat a), (r, g, b, a))
+GL_WRAP(void, glColorMask, (GLboolean r, GLboolean g, GLboolean b, GLboolean a), (r, g, b, a))
+GL_WRAP(void, glCompileShader, (GLuint shader), (shader))
+GL_WRAP(GLuint, glCreateProgram, (void), ())
+GL_WRAP(GLuint, glCreateShader, (GLenum type), (type))
+GL_WRAP(void, glCullFace, (GLenum mode), (mode))
+GL_WRAP(void, glDeleteBuffers, (GLsizei n, const GLuint* buffers), (n, buffers))
+GL_WRAP(void, glDeleteProgram, (GLuint program), (program))
+GL_WRAP(void, glDeleteShader, (GLuint shader), (shader))
+GL_WRAP(void, glDeleteTextures, (GLsizei n, const GLuint* textures), (n, textures))
+GL_WRAP(void, glDisable, (GLenum cap), (cap))
+GL_WRAP(void, glDisableVertexAttribArray, (GLuint index), (index))
+GL_WRAP(void, glDrawArrays, (GLenum mode, GLint first, GLsizei count), (mode, first, count))
+GL_WRAP(void, glEnable, (GLenum cap), (cap))
+GL_WRAP(void, glEnableVertexAttribArray, (GLuint index), (index))
+GL_WRAP(void, glEnd, (void), ())
+GL_WRAP(void, glFinish, (void), ())
+GL_WRAP(void, glFlush, (void), ())
+GL_WRAP(void, glFrontFace, (GLenum mode), (mode))
+GL_WRAP(void, glGenBuffers, (GLsizei n, GLuint* buffers), (n, buffers))
+GL_WRAP(void, glGenTextures, (GLsizei n, GLuint* textures), (n, textures))
+GL_WRAP(void, glGetBooleanv, (GLenum pname, GLboolean* data), (pname, data))
+GL_WRAP(void, glGetDoublev, (GLenum pname, GLdouble* data), (pname, data))
+GL_WRAP(GLenum, glGetError, (void), ())
+GL_WRAP(void, glGetIntegerv, (GLenum pname, GLint* data), (pname, data))
+GL_WRAP(void, glGetProgramInfoLog, (GLuint program, GLsizei size, GLsizei* length, GLchar* log), (program, size, length, log))
+GL_WRAP(void, glGetProgramiv, (GLuint program, GLenum pname, GLint* params), (program, pname, params))
+GL_WRAP(void, glGetShaderInfoLog, (GLuint shader, GLsizei size, GLsizei* length, GLchar* log), (shader, size, length, log))
+GL_WRAP(void, glGetShaderiv, (GLuint shader, GLenum pname, GLint* params), (shader, pname, params))
+GL_WRAP(GLint, glGetUniformLocation, (GLuint program, const GLchar* name), (program, name))
+GL_WRAP(void, glLinkProgram, (GLuint program), (program))
+GL_WRAP(void, glLoadIdentity, (void), ())
+GL_WRAP(void, glMatrixMode, (GLenum mode), (mode))
+GL_WRAP(void, glOrtho, (GLdouble l, GLdouble r, GLdouble b, GLdouble t, GLdouble n, GLdouble f), (l, r, b, t, n, f))
+GL_WRAP(void, glPixelStorei, (GLenum pname, GLint param), (pname, param))
+GL_WRAP(void, glPopMatrix, (void), ())
+GL_WRAP(void, glPushMatrix, (void), ())
+GL_WRAP(void, glReadPixels, (GLint x, GLint y, GLsizei w, GLsizei h, GLenum format, GLenum type, void* pixels), (x, y, w, h, format, type, pixels))
+GL_WRAP(void, glRotatef, (GLfloat angle, GLfloat x, GLfloat y, GLfloat z), (angle, x, y, z))
+GL_WRAP(void, glScissor, (GLint x, GLint y, GLsizei w, GLsizei h), (x, y, w, h))
+GL_WRAP(void, glShaderSource, (GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length), (shader, count, string, length))
+GL_WRAP(void, glStencilFunc, (GLenum func, GLint ref, GLuint mask), (func, ref, mask))
+GL_WRAP(void, glStencilMask, (GLuint mask), (mask))
+GL_WRAP(void, glStencilOp, (GLenum fail, GLenum zfail, GLenum zpass), (fail, zfail, zpass))
+GL_WRAP(void, glStencilOpSeparate, (GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass), (face, sfail, dpfail, dppass))
+GL_WRAP(void, glTexCoord2f, (GLfloat s, GLfloat t), (s, t))
+GL_WRAP_UPLOAD(void, glTexImage2D, (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels), (target, level, internalformat, width, height, border, format, type, pixels))
+GL_WRAP(void, glTexParameterfv, (GLenum target, GLenum pname, const GLfloat* params), (target, pname, params))
+GL_WRAP(void, glTexParameteri, (GLenum target, GLenum pname, GLint param), (target, pname, param))
+GL_WRAP_UPLOAD(void, glTexSubImage2D, (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels), (target, level, xoffset, yoffset, width, height, format, type, pixels))
+GL_WRAP(void, glTranslatef, (GLfloat x, GLfloat y, GLfloat z), (x, y, z))
+GL_WRAP(void, glUniform1i, (GLint location, GLint v0), (location, v0))
+GL_WRAP(void, glUniform2fv, (GLint location, GLsizei count, const GLfloat* value), (location, count, value))
+GL_WRAP(void, glUniform4fv, (GLint location, GLsizei count, const GLfloat* value), (location, count, value))
+GL_WRAP(void, glUseProgram, (GLuint program), (program))
+GL_WRAP(void, glVertex2d, (GLdouble x, GLdouble y), (x, y))
+GL_WRAP(void, glVertexAttribPointer, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer), (index, size, type, normalized, stride, pointer))
+GL_WRAP(void, glViewport, (GLint x, GLint y, GLsizei w, GLsizei h), (x, y, w, h))
+
+// -----------------------------------------------------------------------
+
+static double getTimeInSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+// includes the time spent in llvmpipe's rendering threads
+static double getCpuTimeInSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+static const uint kWindowWidth  = 1024;
+static const uint kWindowHeight = 768;
+static const uint kCellSize     = 48;
+static const uint kColumns      = kWindowWidth / kCellSize;
+static const uint kMaxWidgets   = kColumns * (kWindowHeight / kCellSize);
+
+static const uint kKnobSize   = 32;
+static const uint kKnobLayers = 64;
+
+// -----------------------------------------------------------------------
+// procedural images, stored as RGBA
+
+static std::vector<char> gKnobStripData;
+static std::vector<char> gKnobData;
+static std::vector<char> gHandleData;
+static std::vector<char> gSwitchOffData;
+static std::vector<char> gSwitchOnData;
+static std::vector<char> gButtonData;
+
+static void setPixel(std::vector<char>& data, const uint index, const uchar r, const uchar g, const uchar b, const uchar a)
+{
+    data[index*4+0] = static_cast<char>(r);
+    data[index*4+1] = static_cast<char>(g);
+    data[index*4+2] = static_cast<char>(b);
+    data[index*4+3] = static_cast<char>(a);
+}
+
+// a round knob with an indicator line at 'angle' radians
+static void drawKnob(std::vector<char>& data, const uint offset, const float angle)
+{
+    const float center = kKnobSize / 2.0f;
+    const float indicatorX = std::sin(angle);
+    const float indicatorY = -std::cos(angle);
+
+    for (uint y=0; y < kKnobSize; ++y)
+    {
+        for (uint x=0; x < kKnobSize; ++x)
+        {
+            const float dx = x + 0.5f - center;
+            const float dy = y + 0.5f - center;
+            const float radius = std::sqrt(dx*dx + dy*dy);
+            const uint index = offset + y * kKnobSize + x;
+
+            if (radius > center - 1.0f)
+                setPixel(data, index, 0, 0, 0, 0);
+            else if (std::fabs(dx * indicatorY - dy * indicatorX) < 1.5f && dx * indicatorX + dy * indicatorY > 0.0f)
+                setPixel(data, index, 240, 240, 240, 255);
+            else
+                setPixel(data, index, 60, 64, 72, 255);
+        }
+    }
+}
+
+static void fillImage(std::vector<char>& data, const uint numPixels, const uchar r, const uchar g, const uchar b)
+{
+    data.resize(numPixels * 4);
+
+    for (uint i=0; i < numPixels; ++i)
+        setPixel(data, i, r, g, b, 255);
+}
+
+static void createImages()
+{
+    // vertical strip with one knob position per layer
+    gKnobStripData.resize(kKnobSize * kKnobSize * kKnobLayers * 4);
+
+    for (uint i=0; i < kKnobLayers; ++i)
+        drawKnob(gKnobStripData, i * kKnobSize * kKnobSize, (static_cast<float>(i) / (kKnobLayers - 1) - 0.5f) * 4.71f);
+
+    gKnobData.resize(kKnobSize * kKnobSize * 4);
+    drawKnob(gKnobData, 0, 0.0f);
+
+    fillImage(gHandleData, 16 * 16, 200, 200, 210);
+    fillImage(gSwitchOffData, 32 * 16, 70, 70, 80);
+    fillImage(gSwitchOnData, 32 * 16, 90, 200, 120);
+    fillImage(gButtonData, 32 * 32, 120, 120, 140);
+}
+
+// -----------------------------------------------------------------------
+
+START_NAMESPACE_DGL
+
+class BenchmarkWindow : public Window
+{
+public:
+    BenchmarkWindow(Application& app)
+        : Window(app),
+          fFramesDrawn(0)
+    {
+        setSize(kWindowWidth, kWindowHeight);
+    }
+
+    uint64_t getFramesDrawn() const noexcept
+    {
+        return fFramesDrawn;
+    }
+
+protected:
+    void onDisplayBefore() override
+    {
+        glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+
+    // wait for the software renderer, so its time is part of the frame
+    void onDisplayAfter() override
+    {
+        glFinish();
+        ++fFramesDrawn;
+    }
+
+private:
+    uint64_t fFramesDrawn;
+};
+
+// Value text and a meter arc, the usual NanoVG widget contents
+
+class NanoLabel : public NanoWidget
+{
+public:
+    // the first label owns the NanoVG context
+    NanoLabel(Window& parent)
+        : NanoWidget(parent),
+          fValue(0.0f)
+    {
+        loadSharedResources();
+    }
+
+    // the other ones share it
+    NanoLabel(NanoLabel* group)
+        : NanoWidget(group),
+          fValue(0.0f) {}
+
+    void setValue(const float value)
+    {
+        fValue = value;
+        repaint();
+    }
+
+protected:
+    void onNanoDisplay() override
+    {
+        const float width  = getWidth();
+        const float height = getHeight();
+
+        beginPath();
+        roundedRect(1.0f, 1.0f, width - 2.0f, height - 2.0f, 4.0f);
+        fillColor(40, 44, 52);
+        fill();
+
+        beginPath();
+        arc(width / 2.0f, height / 2.0f, width / 2.0f - 5.0f, 0.75f * M_PI, (0.75f + 1.5f * fValue) * M_PI, CW);
+        strokeColor(90, 180, 240);
+        strokeWidth(3.0f);
+        stroke();
+
+        char valueText[16];
+        std::snprintf(valueText, sizeof(valueText), "%.2f", fValue);
+
+        fontFace(NANOVG_DEJAVU_SANS_TTF);
+        fontSize(12.0f);
+        fillColor(230, 230, 230);
+        textAlign(ALIGN_CENTER | ALIGN_MIDDLE);
+        text(width / 2.0f, height / 2.0f, valueText, nullptr);
+    }
+
+private:
+    float fValue;
+};
+
+// Plain OpenGL drawing through the Geometry classes
+
+class GeometryWidget : public Widget
+{
+public:
+    GeometryWidget(Window& parent)
+        : Widget(parent),
+          fValue(0.0f) {}
+
+    void setValue(const float value)
+    {
+        fValue = value;
+        repaint();
+    }
+
+protected:
+    void onDisplay() override
+    {
+        const int width  = static_cast<int>(getWidth());
+        const int height = static_cast<int>(getHeight());
+
+        glColor4f(0.2f, 0.2f, 0.25f, 1.0f);
+        Rectangle<int>(0, 0, width, height).draw();
+
+        glColor4f(0.3f + 0.7f * fValue, 0.5f, 0.8f, 1.0f);
+        Circle<float>(width / 2.0f, height / 2.0f, width / 2.0f - 4.0f, 32).draw();
+
+        glColor4f(0.9f, 0.9f, 0.9f, 1.0f);
+        Triangle<int>(width / 2, 4, 4, height - 4, width - 4, height - 4).drawOutline();
+        Line<int>(0, static_cast<int>(height * (1.0f - fValue)), width, static_cast<int>(height * (1.0f - fValue))).draw();
+
+        glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+    }
+
+private:
+    float fValue;
+};
+
+END_NAMESPACE_DGL
+
+// -----------------------------------------------------------------------
+// Scenes, each one creates its widgets and changes their values on every frame
+
+class Scene
+{
+public:
+    Scene(Window& window)
+        : fWindow(window),
+          fWidgets(),
+          fNanoGroup(nullptr) {}
+
+    virtual ~Scene()
+    {
+        // NanoVG context owner goes last
+        for (std::vector<Widget*>::reverse_iterator it = fWidgets.rbegin(); it != fWidgets.rend(); ++it)
+            delete *it;
+    }
+
+    virtual void update(uint frame) = 0;
+
+protected:
+    Window& fWindow;
+    std::vector<Widget*> fWidgets;
+    NanoLabel* fNanoGroup;
+
+    static Point<int> getCellPos(const uint index)
+    {
+        return Point<int>(static_cast<int>((index % kColumns) * kCellSize + 8),
+                          static_cast<int>((index / kColumns) * kCellSize + 8));
+    }
+
+    static float getValue(const uint index, const uint frame)
+    {
+        return static_cast<float>((index * 7 + frame) % kKnobLayers) / (kKnobLayers - 1);
+    }
+
+    ImageKnob* addKnob(const uint index, const bool rotary)
+    {
+        ImageKnob* const knob = rotary
+                              ? new ImageKnob(fWindow, Image(gKnobData.data(), kKnobSize, kKnobSize, GL_RGBA))
+                              : new ImageKnob(fWindow, Image(gKnobStripData.data(), kKnobSize, kKnobSize * kKnobLayers, GL_RGBA));
+
+        if (rotary)
+            knob->setRotationAngle(270);
+
+        knob->setAbsolutePos(getCellPos(index));
+        fWidgets.push_back(knob);
+        return knob;
+    }
+
+    ImageSlider* addSlider(const uint index)
+    {
+        ImageSlider* const slider = new ImageSlider(fWindow, Image(gHandleData.data(), 16, 16, GL_RGBA));
+        const Point<int> pos(getCellPos(index));
+
+        slider->setStartPos(pos.getX() + 8, pos.getY());
+        slider->setEndPos(pos.getX() + 8, pos.getY() + 16);
+        fWidgets.push_back(slider);
+        return slider;
+    }
+
+    ImageSwitch* addSwitch(const uint index)
+    {
+        ImageSwitch* const imageSwitch = new ImageSwitch(fWindow,
+                                                         Image(gSwitchOffData.data(), 32, 16, GL_RGBA),
+                                                         Image(gSwitchOnData.data(), 32, 16, GL_RGBA));
+        imageSwitch->setAbsolutePos(getCellPos(index));
+        fWidgets.push_back(imageSwitch);
+        return imageSwitch;
+    }
+
+    ImageButton* addButton(const uint index)
+    {
+        ImageButton* const button = new ImageButton(fWindow, Image(gButtonData.data(), 32, 32, GL_RGBA));
+        button->setAbsolutePos(getCellPos(index));
+        fWidgets.push_back(button);
+        return button;
+    }
+
+    NanoLabel* addLabel(const uint index)
+    {
+        NanoLabel* const label = fNanoGroup == nullptr ? new NanoLabel(fWindow) : new NanoLabel(fNanoGroup);
+
+        if (fNanoGroup == nullptr)
+            fNanoGroup = label;
+
+        label->setAbsolutePos(getCellPos(index));
+        label->setSize(kCellSize - 8, kCellSize - 8);
+
+        // the owner must be deleted last, keep it at the front
+        fWidgets.insert(label == fNanoGroup ? fWidgets.begin() : fWidgets.end(), label);
+        return label;
+    }
+
+    GeometryWidget* addGeometry(const uint index)
+    {
+        GeometryWidget* const widget = new GeometryWidget(fWindow);
+        widget->setAbsolutePos(getCellPos(index));
+        widget->setSize(kCellSize - 8, kCellSize - 8);
+        fWidgets.push_back(widget);
+        return widget;
+    }
+};
+
+class KnobScene : public Scene
+{
+public:
+    KnobScene(Window& window, const uint numWidgets, const bool rotary)
+        : Scene(window),
+          fKnobs()
+    {
+        for (uint i=0; i < numWidgets; ++i)
+            fKnobs.push_back(addKnob(i, rotary));
+    }
+
+    void update(const uint frame) override
+    {
+        for (uint i=0; i < fKnobs.size(); ++i)
+            fKnobs[i]->setValue(getValue(i, frame));
+    }
+
+private:
+    std::vector<ImageKnob*> fKnobs;
+};
+
+class SliderScene : public Scene
+{
+public:
+    SliderScene(Window& window, const uint numWidgets)
+        : Scene(window),
+          fSliders()
+    {
+        for (uint i=0; i < numWidgets; ++i)
+            fSliders.push_back(addSlider(i));
+    }
+
+    void update(const uint frame) override
+    {
+        for (uint i=0; i < fSliders.size(); ++i)
+            fSliders[i]->setValue(getValue(i, frame));
+    }
+
+private:
+    std::vector<ImageSlider*> fSliders;
+};
+
+class SwitchScene : public Scene
+{
+public:
+    SwitchScene(Window& window, const uint numWidgets)
+        : Scene(window),
+          fSwitches()
+    {
+        for (uint i=0; i < numWidgets; ++i)
+            fSwitches.push_back(addSwitch(i));
+    }
+
+    void update(const uint frame) override
+    {
+        for (uint i=0; i < fSwitches.size(); ++i)
+            fSwitches[i]->setDown(((i + frame) & 1) != 0);
+    }
+
+private:
+    std::vector<ImageSwitch*> fSwitches;
+};
+
+// nothing changes, measures the cost of a full repaint
+class ButtonScene : public Scene
+{
+public:
+    ButtonScene(Window& window, const uint numWidgets)
+        : Scene(window)
+    {
+        for (uint i=0; i < numWidgets; ++i)
+            addButton(i);
+    }
+
+    void update(uint) override {}
+};
+
+class NanoScene : public Scene
+{
+public:
+    NanoScene(Window& window, const uint numWidgets)
+        : Scene(window),
+          fLabels()
+    {
+        for (uint i=0; i < numWidgets; ++i)
+            fLabels.push_back(addLabel(i));
+    }
+
+    void update(const uint frame) override
+    {
+        for (uint i=0; i < fLabels.size(); ++i)
+            fLabels[i]->setValue(getValue(i, frame));
+    }
+
+private:
+    std::vector<NanoLabel*> fLabels;
+};
+
+class GeometryScene : public Scene
+{
+public:
+    GeometryScene(Window& window, const uint numWidgets)
+        : Scene(window),
+          fGeometry()
+    {
+        for (uint i=0; i < numWidgets; ++i)
+            fGeometry.push_back(addGeometry(i));
+    }
+
+    void update(const uint frame) override
+    {
+        for (uint i=0; i < fGeometry.size(); ++i)
+            fGeometry[i]->setValue(getValue(i, frame));
+    }
+
+private:
+    std::vector<GeometryWidget*> fGeometry;
+};
+
+// a bit of everything, like a typical plugin UI
+class MixedScene : public Scene
+{
+public:
+    MixedScene(Window& window, const uint numWidgets)
+        : Scene(window),
+          fKnobs(),
+          fSliders(),
+          fSwitches(),
+          fLabels()
+    {
+        for (uint i=0; i < numWidgets; ++i)
+        {
+            switch (i % 6)
+            {
+            case 0:
+            case 1:
+                fKnobs.push_back(addKnob(i, false));
+                break;
+            case 2:
+                fSliders.push_back(addSlider(i));
+                break;
+            case 3:
+                fSwitches.push_back(addSwitch(i));
+                break;
+            case 4:
+                addButton(i);
+                break;
+            case 5:
+                fLabels.push_back(addLabel(i));
+                break;
+            }
+        }
+    }
+
+    void update(const uint frame) override
+    {
+        for (uint i=0; i < fKnobs.size(); ++i)
+            fKnobs[i]->setValue(getValue(i, frame));
+        for (uint i=0; i < fSliders.size(); ++i)
+            fSliders[i]->setValue(getValue(i, frame));
+        for (uint i=0; i < fSwitches.size(); ++i)
+            fSwitches[i]->setDown(((i + frame) & 1) != 0);
+        for (uint i=0; i < fLabels.size(); ++i)
+            fLabels[i]->setValue(getValue(i, frame));
+    }
+
+private:
+    std::vector<ImageKnob*> fKnobs;
+    std::vector<ImageSlider*> fSliders;
+    std::vector<ImageSwitch*> fSwitches;
+    std::vector<NanoLabel*> fLabels;
+};
+
+static const char* const kSceneNames[] = {
+    "knobs", "rotary", "sliders", "switches", "buttons", "nanovg", "geometry", "mixed"
+};
+
+static const uint kNumScenes = sizeof(kSceneNames) / sizeof(kSceneNames[0]);
+
+static Scene* createScene(const uint sceneIndex, Window& window, const uint numWidgets)
+{
+    switch (sceneIndex)
+    {
+    case 0: return new KnobScene(window, numWidgets, false);
+    case 1: return new KnobScene(window, numWidgets, true);
+    case 2: return new SliderScene(window, numWidgets);
+    case 3: return new SwitchScene(window, numWidgets);
+    case 4: return new ButtonScene(window, numWidgets);
+    case 5: return new NanoScene(window, numWidgets);
+    case 6: return new GeometryScene(window, numWidgets);
+    default: return new MixedScene(window, numWidgets);
+    }
+}
+
+// -----------------------------------------------------------------------
+
+static void runScene(const uint sceneIndex, const uint numWidgets, const uint numFrames)
+{
+    Application app;
+    BenchmarkWindow window(app);
+    Scene* const scene = createScene(sceneIndex, window, numWidgets);
+
+    window.show();
+
+    // the first frame creates the GL resources and uploads the textures
+    gGLCalls = gTextureUploads = gTextureUploadBytes = 0;
+    scene->update(0);
+    window.repaint();
+    app.idle();
+
+    const uint64_t firstFrameUploads = gTextureUploads;
+    const uint64_t firstFrameUploadBytes = gTextureUploadBytes;
+
+    gGLCalls = gTextureUploads = gTextureUploadBytes = 0;
+
+    const uint64_t startFrames = window.getFramesDrawn();
+    const double startTime = getTimeInSeconds();
+    const double startCpuTime = getCpuTimeInSeconds();
+
+    for (uint frame = 1; frame <= numFrames; ++frame)
+    {
+        scene->update(frame);
+        window.repaint();
+        app.idle();
+    }
+
+    const double elapsed = getTimeInSeconds() - startTime;
+    const double cpuElapsed = getCpuTimeInSeconds() - startCpuTime;
+    const uint64_t framesDrawn = window.getFramesDrawn() - startFrames;
+
+    delete scene;
+    window.close();
+
+    if (framesDrawn == 0)
+    {
+        d_stderr("%-9s %4u widgets: no frames were drawn", kSceneNames[sceneIndex], numWidgets);
+        return;
+    }
+
+    std::printf("%-9s %4u %9.3f %9.3f %9.1f %8.2f %10.1f %8llu %10.1f\n",
+                kSceneNames[sceneIndex], numWidgets,
+                elapsed * 1000.0 / framesDrawn,
+                cpuElapsed * 1000.0 / framesDrawn,
+                static_cast<double>(gGLCalls) / framesDrawn,
+                static_cast<double>(gTextureUploads) / framesDrawn,
+                static_cast<double>(gTextureUploadBytes) / 1024.0 / framesDrawn,
+                static_cast<unsigned long long>(firstFrameUploads),
+                static_cast<double>(firstFrameUploadBytes) / 1024.0);
+}
+
+int main(int argc, char* argv[])
+{
+    int sceneIndex = -1;
+    uint numWidgets = 0;
+    uint numFrames = 200;
+
+    for (int i=1; i < argc; ++i)
+    {
+        if ((std::strcmp(argv[i], "-s") == 0 || std::strcmp(argv[i], "--scene") == 0) && i+1 < argc)
+        {
+            ++i;
+
+            for (uint j=0; j < kNumScenes; ++j)
+            {
+                if (std::strcmp(argv[i], kSceneNames[j]) == 0)
+                    sceneIndex = static_cast<int>(j);
+            }
+
+            if (sceneIndex < 0)
+            {
+                d_stderr("Unknown scene '%s'", argv[i]);
+                return 1;
+            }
+        }
+        else if ((std::strcmp(argv[i], "-w") == 0 || std::strcmp(argv[i], "--widgets") == 0) && i+1 < argc)
+            numWidgets = static_cast<uint>(std::atoi(argv[++i]));
+        else if ((std::strcmp(argv[i], "-f") == 0 || std::strcmp(argv[i], "--frames") == 0) && i+1 < argc)
+            numFrames = static_cast<uint>(std::atoi(argv[++i]));
+        else
+        {
+            d_stderr("Usage: %s [-s|--scene NAME] [-w|--widgets N] [-f|--frames N]", argv[0]);
+            d_stderr("Scenes: knobs, rotary, sliders, switches, buttons, nanovg, geometry, mixed");
+            return 1;
+        }
+    }
+
+    if (numWidgets > kMaxWidgets || numFrames == 0)
+    {
+        d_stderr("Widgets must be at most %u and frames positive", kMaxWidgets);
+        return 1;
+    }
+
+    createImages();
+
+    static const uint kDefaultWidgetCounts[] = { 16, 64, 256 };
+
+    std::printf("%-9s %4s %9s %9s %9s %8s %10s %8s %10s\n",
+                "scene", "n", "ms/frame", "cpu ms", "GL calls", "uploads", "upload KiB", "init up.", "init KiB");
+
+    for (uint s=0; s < kNumScenes; ++s)
+    {
+        if (sceneIndex >= 0 && s != static_cast<uint>(sceneIndex))
+            continue;
+
+        if (numWidgets != 0)
+        {
+            runScene(s, numWidgets, numFrames);
+            continue;
+        }
+
+        for (uint i=0; i < sizeof(kDefaultWidgetCounts) / sizeof(kDefaultWidgetCounts[0]); ++i)
+            runScene(s, kDefaultWidgetCounts[i], numFrames);
+    }
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,320 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Times the string-heavy export paths of a plugin binary:
+ * - 'lv2_generate_ttl' of LV2 builds (ttl files are written to the current directory)
+ * - 'effGetChunk' and 'effSetChunk' of VST builds
+ * - instantiation of VST builds, with many instances alive at the same time like in a big session
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+ #include <windows.h>
+ #include <io.h>
+ #define BENCHMARK_WINDOWS
+ #define BENCHMARK_NULL_DEVICE "NUL"
+#else
+ #include <dlfcn.h>
+ #include <time.h>
+ #include <unistd.h>
+ #define BENCHMARK_NULL_DEVICE "/dev/null"
+#endif
+
+#include "../../distrho/src/vestige/vestige.h"
+
+#ifndef nullptr
+ #define nullptr (0)
+#endif
+
+#define effGetChunk 23
+#define effSetChunk 24
+#define effFlagsProgramChunks (1 << 5)
+
+#define kMaxInstances 200
+
+typedef void (*TTL_Generator_Function)(const char* basename);
+typedef const AEffect* (*VST_Function)(audioMasterCallback audioMaster);
+
+/* ---------------------------------------------------------------------------------------------------------------- */
+
+static double getTimeInSeconds(void)
+{
+#ifdef BENCHMARK_WINDOWS
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+typedef struct {
+    double total, min, max;
+} Timings;
+
+static void timingsInit(Timings* const t)
+{
+    t->total = 0.0;
+    t->min   = 1e9;
+    t->max   = 0.0;
+}
+
+static void timingsAdd(Timings* const t, const double value)
+{
+    t->total += value;
+    if (value < t->min) t->min = value;
+    if (value > t->max) t->max = value;
+}
+
+static void timingsPrint(const char* const name, const Timings* const t, const int iterations)
+{
+    printf("%-18s avg %10.2f us, min %10.2f us, max %10.2f us\n",
+           name, t->total / iterations * 1e6, t->min * 1e6, t->max * 1e6);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------- */
+
+static void benchmarkTTL(const TTL_Generator_Function ttlFn, const char* const basename, const int iterations)
+{
+    Timings timings;
+    timingsInit(&timings);
+
+    /* lv2_generate_ttl prints progress, silence it while timing */
+    fflush(stdout);
+    const int stdoutCopy = dup(1);
+    const int devNull    = open(BENCHMARK_NULL_DEVICE, O_WRONLY);
+    dup2(devNull, 1);
+
+    for (int i=0; i<iterations; ++i)
+    {
+        const double start = getTimeInSeconds();
+        ttlFn(basename);
+        fflush(stdout);
+        timingsAdd(&timings, getTimeInSeconds() - start);
+    }
+
+    dup2(stdoutCopy, 1);
+    close(stdoutCopy);
+    close(devNull);
+
+    timingsPrint("lv2_generate_ttl", &timings, iterations);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------- */
+
+static intptr_t audioMasterCallbackFn(AEffect* effect, int32_t opcode, int32_t index, intptr_t value, void* ptr, float opt)
+{
+    switch (opcode)
+    {
+    case audioMasterVersion:
+        return 2400;
+    case audioMasterGetSampleRate:
+        return 48000;
+    case audioMasterGetBlockSize:
+        return 512;
+    }
+
+    return 0;
+
+    /* unused */
+    (void)effect; (void)index; (void)value; (void)ptr; (void)opt;
+}
+
+static void benchmarkVST(const VST_Function vstFn, const int iterations)
+{
+    AEffect* const effect = (AEffect*)vstFn(audioMasterCallbackFn);
+
+    if (effect == nullptr)
+    {
+        printf("Failed to create VST plugin\n");
+        return;
+    }
+
+    effect->dispatcher(effect, effOpen, 0, 0, nullptr, 0.0f);
+
+    if (effect->flags & effFlagsProgramChunks)
+    {
+        Timings getTimings, setTimings;
+        timingsInit(&getTimings);
+        timingsInit(&setTimings);
+
+        intptr_t chunkSize = 0;
+
+        for (int i=0; i<iterations; ++i)
+        {
+            void* chunk = nullptr;
+
+            double start = getTimeInSeconds();
+            chunkSize = effect->dispatcher(effect, effGetChunk, 0, 0, &chunk, 0.0f);
+            timingsAdd(&getTimings, getTimeInSeconds() - start);
+
+            if (chunk == nullptr || chunkSize <= 0)
+                continue;
+
+            /* the plugin owns the chunk memory, which is reused on the next call */
+            void* const chunkCopy = malloc((size_t)chunkSize);
+            memcpy(chunkCopy, chunk, (size_t)chunkSize);
+
+            start = getTimeInSeconds();
+            effect->dispatcher(effect, effSetChunk, 0, chunkSize, chunkCopy, 0.0f);
+            timingsAdd(&setTimings, getTimeInSeconds() - start);
+
+            free(chunkCopy);
+        }
+
+        printf("VST chunk size:    %li bytes, %i parameters\n", (long)chunkSize, effect->numParams);
+        timingsPrint("effGetChunk", &getTimings, iterations);
+        timingsPrint("effSetChunk", &setTimings, iterations);
+    }
+    else
+    {
+        printf("VST plugin does not use chunks\n");
+    }
+
+    effect->dispatcher(effect, effClose, 0, 0, nullptr, 0.0f);
+}
+
+/* the first instance is timed separately, later ones share its metadata */
+static void benchmarkVSTInstances(const VST_Function vstFn, const int iterations)
+{
+    AEffect* effects[kMaxInstances];
+    const int count = iterations < kMaxInstances ? iterations : kMaxInstances;
+
+    Timings openTimings, closeTimings;
+    timingsInit(&openTimings);
+    timingsInit(&closeTimings);
+
+    double firstOpen = 0.0;
+    int opened = 0;
+
+    for (int i=0; i<count; ++i)
+    {
+        const double start = getTimeInSeconds();
+
+        AEffect* const effect = (AEffect*)vstFn(audioMasterCallbackFn);
+
+        if (effect == nullptr)
+            break;
+
+        effect->dispatcher(effect, effOpen, 0, 0, nullptr, 0.0f);
+
+        const double elapsed = getTimeInSeconds() - start;
+
+        if (i == 0)
+            firstOpen = elapsed;
+        else
+            timingsAdd(&openTimings, elapsed);
+
+        effects[opened++] = effect;
+    }
+
+    for (int i=0; i<opened; ++i)
+    {
+        const double start = getTimeInSeconds();
+        effects[i]->dispatcher(effects[i], effClose, 0, 0, nullptr, 0.0f);
+        timingsAdd(&closeTimings, getTimeInSeconds() - start);
+    }
+
+    if (opened < 2)
+    {
+        printf("Failed to create VST plugin instances\n");
+        return;
+    }
+
+    printf("VST instances:     %i alive at once, first one took %.2f us\n", opened, firstOpen * 1e6);
+    timingsPrint("effOpen", &openTimings, opened - 1);
+    timingsPrint("effClose", &closeTimings, opened);
+}
+
+/* ---------------------------------------------------------------------------------------------------------------- */
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2 && argc != 3)
+    {
+        printf("usage: %s /path/to/plugin-DLL [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    const int iterations = (argc == 3) ? atoi(argv[2]) : 1000;
+
+    if (iterations <= 0)
+    {
+        printf("Invalid iteration count\n");
+        return 1;
+    }
+
+#ifdef BENCHMARK_WINDOWS
+    const HMODULE handle = LoadLibraryA(argv[1]);
+#else
+    void* const handle = dlopen(argv[1], RTLD_LAZY);
+#endif
+
+    if (! handle)
+    {
+#ifdef BENCHMARK_WINDOWS
+        printf("Failed to open plugin DLL\n");
+#else
+        printf("Failed to open plugin DLL, error was:\n%s\n", dlerror());
+#endif
+        return 2;
+    }
+
+#ifdef BENCHMARK_WINDOWS
+    const TTL_Generator_Function ttlFn = (TTL_Generator_Function)GetProcAddress(handle, "lv2_generate_ttl");
+    VST_Function vstFn = (VST_Function)GetProcAddress(handle, "VSTPluginMain");
+#else
+    const TTL_Generator_Function ttlFn = (TTL_Generator_Function)dlsym(handle, "lv2_generate_ttl");
+    VST_Function vstFn = (VST_Function)dlsym(handle, "VSTPluginMain");
+
+    /* Linux builds export the VST entry point as 'main' */
+    if (vstFn == NULL)
+        vstFn = (VST_Function)dlsym(handle, "main");
+#endif
+
+    printf("Benchmarking '%s', %i iterations\n", argv[1], iterations);
+
+    if (ttlFn != NULL)
+    {
+        /* basename is only used for file names in the manifest */
+        benchmarkTTL(ttlFn, "plugin", iterations);
+    }
+
+    if (vstFn != NULL)
+    {
+        benchmarkVST(vstFn, iterations);
+        benchmarkVSTInstances(vstFn, iterations);
+    }
+
+    if (ttlFn == NULL && vstFn == NULL)
+        printf("Failed to find 'lv2_generate_ttl' or VST entry point\n");
+
+#ifdef BENCHMARK_WINDOWS
+    FreeLibrary(handle);
+#else
+    dlclose(handle);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,341 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Throughput of SpscRingBuffer, MpscRingBuffer and TripleBuffer against a mutex-protected queue,
+ * and a stress mode that checks ordering and consistency (build with 'make tsan' to run it under ThreadSanitizer).
+ */
+
+#include "extra/RingBuffer.hpp"
+#include "extra/Thread.hpp"
+#include "extra/TripleBuffer.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+
+USE_NAMESPACE_DISTRHO;
+
+// -----------------------------------------------------------------------
+
+static double getTimeInSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+static const uint32_t kQueueSize = 1024;
+static const uint32_t kMaxProducers = 8;
+
+struct Message {
+    uint32_t producer;
+    uint32_t sequence;
+};
+
+struct Snapshot {
+    uint32_t values[64];
+};
+
+// -----------------------------------------------------------------------
+// mutex-protected queue, what the lock-free ones are compared against
+
+class LockedQueue
+{
+public:
+    LockedQueue()
+        : fMutex(),
+          fQueue() {}
+
+    bool tryPush(const Message& message)
+    {
+        const MutexLocker ml(fMutex);
+
+        if (fQueue.size() == kQueueSize)
+            return false;
+
+        fQueue.push_back(message);
+        return true;
+    }
+
+    bool tryPop(Message& message)
+    {
+        const MutexLocker ml(fMutex);
+
+        if (fQueue.empty())
+            return false;
+
+        message = fQueue.front();
+        fQueue.pop_front();
+        return true;
+    }
+
+private:
+    Mutex fMutex;
+    std::deque<Message> fQueue;
+};
+
+// -----------------------------------------------------------------------
+
+template<typename Queue>
+class ProducerThread : public Thread
+{
+public:
+    ProducerThread(Queue& queue, const uint32_t producer, const uint32_t count)
+        : Thread("producer"),
+          fQueue(queue),
+          fProducer(producer),
+          fCount(count) {}
+
+protected:
+    void run() override
+    {
+        Message message;
+        message.producer = fProducer;
+
+        for (uint32_t i=0; i < fCount; ++i)
+        {
+            message.sequence = i;
+
+            while (! fQueue.tryPush(message))
+                sched_yield();
+        }
+    }
+
+private:
+    Queue& fQueue;
+    const uint32_t fProducer;
+    const uint32_t fCount;
+};
+
+/*
+ * Push 'count' messages from each producer and consume them on the calling thread.
+ * Returns the number of ordering errors.
+ */
+template<typename Queue>
+static uint32_t runQueue(Queue& queue, const uint32_t numProducers, const uint32_t count, double& elapsed)
+{
+    ProducerThread<Queue>* producers[kMaxProducers];
+    uint32_t nextSequence[kMaxProducers];
+    uint32_t errors = 0;
+
+    for (uint32_t i=0; i < numProducers; ++i)
+    {
+        producers[i] = new ProducerThread<Queue>(queue, i, count);
+        nextSequence[i] = 0;
+    }
+
+    const double startTime = getTimeInSeconds();
+
+    for (uint32_t i=0; i < numProducers; ++i)
+        producers[i]->startThread();
+
+    Message message;
+
+    for (uint32_t received = 0, total = numProducers * count; received < total;)
+    {
+        if (! queue.tryPop(message))
+        {
+            sched_yield();
+            continue;
+        }
+
+        ++received;
+
+        // messages from each producer must arrive complete and in order
+        if (message.producer >= numProducers || message.sequence != nextSequence[message.producer]++)
+            ++errors;
+    }
+
+    elapsed = getTimeInSeconds() - startTime;
+
+    for (uint32_t i=0; i < numProducers; ++i)
+    {
+        producers[i]->stopThread(-1);
+        delete producers[i];
+    }
+
+    return errors;
+}
+
+// -----------------------------------------------------------------------
+
+class SnapshotWriterThread : public Thread
+{
+public:
+    SnapshotWriterThread(TripleBuffer<Snapshot>& buffer, const uint32_t count)
+        : Thread("snapshot-writer"),
+          fBuffer(buffer),
+          fCount(count) {}
+
+protected:
+    void run() override
+    {
+        for (uint32_t i=1; i <= fCount; ++i)
+        {
+            Snapshot& snapshot(fBuffer.getWriteBuffer());
+
+            for (uint32_t j=0; j < 64; ++j)
+                snapshot.values[j] = i;
+
+            fBuffer.publish();
+        }
+    }
+
+private:
+    TripleBuffer<Snapshot>& fBuffer;
+    const uint32_t fCount;
+};
+
+/*
+ * Read snapshots until the last one arrives.
+ * Returns the number of torn or out-of-order snapshots.
+ */
+static uint32_t runTripleBuffer(const uint32_t count, uint32_t& numUpdates, double& elapsed)
+{
+    TripleBuffer<Snapshot> buffer;
+    SnapshotWriterThread writer(buffer, count);
+
+    uint32_t errors = 0, lastValue = 0;
+    numUpdates = 0;
+
+    const double startTime = getTimeInSeconds();
+    writer.startThread();
+
+    while (lastValue != count)
+    {
+        if (! buffer.update())
+        {
+            sched_yield();
+            continue;
+        }
+
+        ++numUpdates;
+
+        const Snapshot& snapshot(buffer.getReadBuffer());
+        const uint32_t value = snapshot.values[0];
+
+        for (uint32_t j=1; j < 64; ++j)
+        {
+            if (snapshot.values[j] != value)
+            {
+                ++errors;
+                break;
+            }
+        }
+
+        if (value <= lastValue)
+            ++errors;
+
+        lastValue = value;
+    }
+
+    elapsed = getTimeInSeconds() - startTime;
+    writer.stopThread(-1);
+
+    return errors;
+}
+
+// -----------------------------------------------------------------------
+
+static SpscRingBuffer<Message, kQueueSize> gSpscQueue;
+static MpscRingBuffer<Message, kQueueSize> gMpscQueue;
+
+int main(int argc, char* argv[])
+{
+    bool stress = false;
+    uint32_t count = 2000000;
+    uint32_t numProducers = 4;
+
+    for (int i=1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--stress") == 0)
+            stress = true;
+        else if ((std::strcmp(argv[i], "-c") == 0 || std::strcmp(argv[i], "--count") == 0) && i+1 < argc)
+            count = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else if ((std::strcmp(argv[i], "-p") == 0 || std::strcmp(argv[i], "--producers") == 0) && i+1 < argc)
+            numProducers = static_cast<uint32_t>(std::atoi(argv[++i]));
+        else
+        {
+            d_stderr("Usage: %s [--stress] [-c|--count N] [-p|--producers N]", argv[0]);
+            return 1;
+        }
+    }
+
+    if (count == 0 || numProducers == 0 || numProducers > kMaxProducers)
+    {
+        d_stderr("Count must be positive and producers between 1 and %u", kMaxProducers);
+        return 1;
+    }
+
+    const uint32_t numRounds = stress ? 20 : 1;
+    uint32_t errors = 0;
+    double elapsed;
+
+    for (uint32_t round = 0; round < numRounds; ++round)
+    {
+        const bool report = ! stress || round == numRounds - 1;
+
+        errors += runQueue(gSpscQueue, 1, count, elapsed);
+
+        if (report)
+            d_stdout("SPSC ring buffer,  1 producer:  %7.2f Mmsg/s", count / elapsed / 1e6);
+
+        {
+            LockedQueue lockedQueue;
+            errors += runQueue(lockedQueue, 1, count, elapsed);
+
+            if (report)
+                d_stdout("Locked queue,      1 producer:  %7.2f Mmsg/s", count / elapsed / 1e6);
+        }
+
+        errors += runQueue(gMpscQueue, numProducers, count / numProducers, elapsed);
+
+        if (report)
+            d_stdout("MPSC ring buffer,  %u producers: %7.2f Mmsg/s",
+                     numProducers, (count / numProducers) * numProducers / elapsed / 1e6);
+
+        {
+            LockedQueue lockedQueue;
+            errors += runQueue(lockedQueue, numProducers, count / numProducers, elapsed);
+
+            if (report)
+                d_stdout("Locked queue,      %u producers: %7.2f Mmsg/s",
+                         numProducers, (count / numProducers) * numProducers / elapsed / 1e6);
+        }
+
+        uint32_t numUpdates;
+        errors += runTripleBuffer(count / 4, numUpdates, elapsed);
+
+        if (report)
+            d_stdout("Triple buffer:                  %7.2f Msnapshots/s written, %u read",
+                     (count / 4) / elapsed / 1e6, numUpdates);
+    }
+
+    if (errors != 0)
+    {
+        d_stderr("FAILED: %u ordering or consistency errors", errors);
+        return 1;
+    }
+
+    if (stress)
+        d_stdout("Stress test passed, %u rounds", numRounds);
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,136 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# DISTRHO Plugin Framework (DPF)
+# Copyright (C) 2012-2018 Filipe Coelho <falktx@falktx.com>
+#
+# Permission to use, copy, modify, and/or distribute this software for any purpose with
+# or without fee is hereby granted, provided that the above copyright notice and this
+# permission notice appear in all copies.
+#
+# THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+# TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+# NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+# DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+# IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+# CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+# Embeds resource files as C arrays, keeping them compressed.
+#
+# PNG files are stored as they are, load them with Image::loadFromPNG() and
+# they get decoded on first use (or in the background, see Image::preload()).
+# Other files (fonts, etc) are stored as-is, or zlib-compressed with '--compress';
+# those need to be inflated before use, see NanoVG::loadSharedResources() for an example.
+#
+# For each file 'name.ext' the generated header has:
+#   extern const char* name_ext;
+#   const unsigned int name_ext_size;             // size of the original file
+#   const unsigned int name_ext_compressed_size;  // only with '--compress', size of the embedded data
+
+import os, sys, zlib
+
+# -----------------------------------------------------
+
+# formats that are compressed already
+precompressed = (".png", ".jpg", ".jpeg")
+
+def res2c(namespace, filenames, compress, outname):
+
+    fdH = open("%s.hpp" % outname, "w")
+    fdH.write("/* (Auto-generated binary data file). */\n")
+    fdH.write("\n")
+    fdH.write("#ifndef BINARY_%s_HPP_INCLUDED\n" % namespace.upper())
+    fdH.write("#define BINARY_%s_HPP_INCLUDED\n" % namespace.upper())
+    fdH.write("\n")
+    fdH.write("namespace %s\n" % namespace)
+    fdH.write("{\n")
+
+    fdC = open("%s.cpp" % outname, "w")
+    fdC.write("/* (Auto-generated binary data file). */\n")
+    fdC.write("\n")
+    fdC.write("#include \"%s.hpp\"\n" % outname)
+    fdC.write("\n")
+
+    tempIndex = 1
+
+    for filename in filenames:
+        shortFilename = filename.rsplit(os.sep, 1)[-1].lower()
+        shortFilename = shortFilename.replace("-", "_").replace(".", "_")
+
+        with open(filename, "rb") as fd:
+            data = bytearray(fd.read())
+
+        fileSize = len(data)
+        deflate  = compress and not filename.lower().endswith(precompressed)
+
+        if deflate:
+            data = bytearray(zlib.compress(bytes(data), 9))
+            print("Generating data for \"%s\", %i bytes compressed to %i" % (filename, fileSize, len(data)))
+        else:
+            print("Generating data for \"%s\", %i bytes" % (filename, fileSize))
+
+        fdH.write("    extern const char* %s;\n" % shortFilename)
+        fdH.write("    const unsigned int %s_size = %i;\n" % (shortFilename, fileSize))
+
+        if deflate:
+            fdH.write("    const unsigned int %s_compressed_size = %i;\n" % (shortFilename, len(data)))
+
+        if tempIndex != len(filenames):
+            fdH.write("\n")
+
+        fdC.write("static const unsigned char temp%i[] = {" % tempIndex)
+
+        for i in range(0, len(data), 40):
+            if i != 0:
+                fdC.write("\n  ")
+            fdC.write(",".join(str(byte) for byte in data[i:i+40]))
+            if i + 40 < len(data):
+                fdC.write(",")
+
+        fdC.write("};\n")
+        fdC.write("const char* %s::%s = (const char*) temp%i;\n" % (namespace, shortFilename, tempIndex))
+
+        if tempIndex != len(filenames):
+            fdC.write("\n")
+
+        tempIndex += 1
+
+    fdH.write("};\n")
+    fdH.write("\n")
+    fdH.write("#endif\n")
+    fdH.close()
+
+    fdC.close()
+
+# -----------------------------------------------------
+
+if __name__ == '__main__':
+    args = sys.argv[1:]
+    compress = "--compress" in args
+
+    if compress:
+        args.remove("--compress")
+
+    if len(args) not in (2, 3):
+        print("Usage: %s [--compress] <namespace> <resources-folder> [output-name]" % sys.argv[0])
+        quit()
+
+    namespace = args[0]
+    resFolder = args[1]
+    outName   = args[2] if len(args) == 3 else namespace
+
+    if not os.path.exists(resFolder):
+        print("Folder '%s' does not exist" % resFolder)
+        quit()
+
+    # find resource files
+    resFiles = []
+
+    for root, dirs, files in os.walk(resFolder):
+        for name in [name for name in files if not name.lower().endswith(".txt")]:
+            resFiles.append(os.path.join(root, name))
+
+    resFiles.sort()
+
+    # create code now
+    res2c(namespace, resFiles, compress, outName)
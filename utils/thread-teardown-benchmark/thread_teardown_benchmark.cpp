@@ -0,0 +1,168 @@
+/*
+ * DISTRHO Plugin Framework (DPF)
+ * Copyright (C) 2012-2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with
+ * or without fee is hereby granted, provided that the above copyright notice and this
+ * permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD
+ * TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN
+ * NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+ * DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER
+ * IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Times the teardown of many plugin-like instances, each owning an idle thread
+ * (periodic timer), a worker thread (waiting for jobs) and a thread that already finished.
+ */
+
+#include "extra/Thread.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+USE_NAMESPACE_DISTRHO;
+
+// -----------------------------------------------------------------------
+
+static double getTimeInSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+class IdleTimerThread : public Thread
+{
+public:
+    IdleTimerThread()
+        : Thread("idle-timer"),
+          fTicks(0) {}
+
+protected:
+    void run() override
+    {
+        while (! waitForThreadShouldExit(16))
+            ++fTicks;
+    }
+
+private:
+    volatile uint fTicks;
+};
+
+class WorkerThread : public Thread
+{
+public:
+    WorkerThread()
+        : Thread("worker") {}
+
+protected:
+    void run() override
+    {
+        while (! waitForThreadShouldExit(100))
+        {
+            // no jobs in this benchmark
+        }
+    }
+};
+
+class FinishedThread : public Thread
+{
+public:
+    FinishedThread()
+        : Thread("finished") {}
+
+protected:
+    void run() override {}
+};
+
+struct Instance {
+    IdleTimerThread idleThread;
+    WorkerThread workerThread;
+    FinishedThread finishedThread;
+
+    Instance()
+    {
+        idleThread.startThread();
+        workerThread.startThread();
+        finishedThread.startThread();
+    }
+
+    ~Instance()
+    {
+        idleThread.stopThread(-1);
+        workerThread.stopThread(-1);
+        finishedThread.stopThread(-1);
+    }
+};
+
+// -----------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    uint numInstances = 500;
+
+    for (int i=1; i < argc; ++i)
+    {
+        if ((std::strcmp(argv[i], "-n") == 0 || std::strcmp(argv[i], "--instances") == 0) && i+1 < argc)
+            numInstances = static_cast<uint>(std::atoi(argv[++i]));
+        else
+        {
+            d_stderr("Usage: %s [-n|--instances N]", argv[0]);
+            return 1;
+        }
+    }
+
+    if (numInstances == 0)
+    {
+        d_stderr("Number of instances must be positive");
+        return 1;
+    }
+
+    std::vector<Instance*> instances;
+    instances.reserve(numInstances);
+
+    double startTime = getTimeInSeconds();
+
+    for (uint i=0; i < numInstances; ++i)
+        instances.push_back(new Instance());
+
+    const double creationTime = getTimeInSeconds() - startTime;
+
+    // let the threads settle into their waits
+    d_msleep(50);
+
+    std::vector<double> teardownTimes;
+    teardownTimes.reserve(numInstances);
+
+    startTime = getTimeInSeconds();
+
+    for (uint i=0; i < numInstances; ++i)
+    {
+        const double instanceStartTime = getTimeInSeconds();
+        delete instances[i];
+        teardownTimes.push_back(getTimeInSeconds() - instanceStartTime);
+    }
+
+    const double teardownTime = getTimeInSeconds() - startTime;
+
+    std::sort(teardownTimes.begin(), teardownTimes.end());
+
+    d_stdout("Instances:             %u (3 threads each)", numInstances);
+    d_stdout("Creation time:         %.3f ms", creationTime * 1000.0);
+    d_stdout("Teardown time:         %.3f ms", teardownTime * 1000.0);
+    d_stdout("Per instance (us):     median %.1f, p99 %.1f, max %.1f",
+             teardownTimes[numInstances / 2] * 1e6,
+             teardownTimes[std::min(numInstances - 1, numInstances * 99 / 100)] * 1e6,
+             teardownTimes.back() * 1e6);
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------